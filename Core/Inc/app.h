@@ -8,7 +8,18 @@
 #ifndef INC_APP_H_
 #define INC_APP_H_
 
+#include <stdint.h>
+
+#ifndef APP_USE_KERNEL
+#define APP_USE_KERNEL 0	// 1: preemptive threads (kernel.c) instead of the cooperative main loop
+#endif
+
 void app_main(void);
+void app_Wake (void);
+uint16_t app_DutyCycleGetter (void);
+#if APP_USE_KERNEL
+void app_StackUsageGetter (uint16_t* sensor, uint16_t* ui, uint16_t* background);
+#endif
 
 
 #endif /* INC_APP_H_ */
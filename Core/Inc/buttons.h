@@ -22,6 +22,13 @@
 typedef enum butNames {UP = 0, DOWN, LEFT, RIGHT, JOYSTICK_CLICK, NUM_BUTTONS} buttonName_t;
 typedef enum butStates {RELEASED = 0, PUSHED, NO_CHANGE} buttonState_t;
 
+// A debounced change of one button, queued by buttons_update
+typedef struct {
+    buttonName_t button;
+    buttonState_t state;    // PUSHED or RELEASED
+    uint64_t time_us;       // timebase_MicrosGetter when the change was confirmed
+} buttonEvent_t;
+
 typedef enum {
     JOYSTICK_NONE,
     JOYSTICK_SHORT_PRESS,
@@ -40,19 +47,17 @@ void buttons_init (void);
 
 // *******************************************************
 // buttons_update: Function designed to be called regularly. It polls all
-// buttons once and updates variables associated with the buttons if
-// necessary. It is efficient enough to be part of an ISR for e.g.,
-// a SysTick interrupt.
+// buttons once and queues an event for every confirmed change of state.
+// It is efficient enough to be part of an ISR for e.g., a SysTick
+// interrupt, as long as it is the only caller.
 void buttons_update (void);
 
 // *******************************************************
-// buttons_checkButton: Function returns the new button state if the button state
-// (PUSHED or RELEASED) has changed since the last call, otherwise returns
-// NO_CHANGE. The argument butName should be one of constants in the
-// enumeration butStates, excluding 'NUM_BUTS'. Safe under interrupt.
-buttonState_t buttons_checkButton (buttonName_t butName);
+// buttons_EventGetter: Takes the oldest queued button event. Returns false
+// if there is none. Only one task may call it.
+bool buttons_EventGetter (buttonEvent_t* event);
 
 joystick_event_t buttons_CheckHold(void);
-bool buttons_CheckDoublePush (void);
+bool buttons_CheckDoublePush (uint64_t push_us);
 
 #endif /*BUTTONS_H_*/
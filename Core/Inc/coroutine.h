@@ -0,0 +1,79 @@
+/*
+ * coroutine.h
+ *
+ * Stackless (protothread style) coroutines for scheduler tasks.
+ *
+ * A task written as a coroutine returns to the scheduler whenever it has
+ * to wait, and carries on from the same point on its next call. The
+ * scheduler calls it again on the next pass after a wake-up (or once a
+ * sleep is over) instead of waiting for the next period; the period only
+ * advances when the coroutine reaches COROUTINE_END.
+ *
+ * Locals are not kept across a wait, so anything needed afterwards must be
+ * static. The macros expand to case labels: no switch statements of the
+ * task's own may contain a wait, and a task body must return void.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_COROUTINE_H_
+#define INC_COROUTINE_H_
+
+#include "scheduler.h"
+#include "timebase.h"
+
+#include <stdint.h>
+
+typedef struct {
+	uint16_t line;			// where to carry on, 0 = from the top
+	uint32_t wait_start;	// time (us) the current COROUTINE_SLEEP began
+} coroutine_t;
+
+#define COROUTINE_INIT(CO)		((CO)->line = 0)
+
+#define COROUTINE_BEGIN(CO)		switch ((CO)->line) { case 0:
+
+#define COROUTINE_END(CO)		} (CO)->line = 0
+
+/* Give the CPU back and carry on at the next pass */
+#define COROUTINE_YIELD(CO) \
+	do { \
+		(CO)->line = __LINE__; \
+		scheduler_Resume (0); \
+		return; \
+		case __LINE__:; \
+	} while (0)
+
+/* Yield only once the task has used up SCHEDULER_BUDGET_CYCLES */
+#define COROUTINE_YIELD_IF_OVER_BUDGET(CO) \
+	do { \
+		if (scheduler_BudgetExpired ()) { \
+			COROUTINE_YIELD (CO); \
+		} \
+	} while (0)
+
+/* Wait until CONDITION holds, e.g. a DMA completion; checked after every wake-up */
+#define COROUTINE_AWAIT(CO, CONDITION) \
+	do { \
+		(CO)->line = __LINE__; \
+		case __LINE__: \
+		if (!(CONDITION)) { \
+			scheduler_Resume (SCHEDULER_WAIT_FOREVER); \
+			return; \
+		} \
+	} while (0)
+
+/* Wait for MS milliseconds without blocking other tasks */
+#define COROUTINE_SLEEP(CO, MS) \
+	do { \
+		(CO)->wait_start = scheduler_TimeGetter (); \
+		(CO)->line = __LINE__; \
+		case __LINE__: \
+		if (scheduler_TimeGetter () - (CO)->wait_start < TIMEBASE_MS(MS)) { \
+			scheduler_Resume (TIMEBASE_MS(MS) - (scheduler_TimeGetter () - (CO)->wait_start)); \
+			return; \
+		} \
+	} while (0)
+
+#endif /* INC_COROUTINE_H_ */
@@ -11,7 +11,15 @@
 #include "task_read_imu.h"
 #include <stdint.h>
 
+#ifndef N_SIZE
 #define N_SIZE 64 // Size of magnitude/variance buffer
+#endif
+#ifndef ALPHA_SHIFT
+#define ALPHA_SHIFT 3 // IIR alpha = 1/2^ALPHA_SHIFT
+#endif
+#ifndef VAR_SCALING
+#define VAR_SCALING 23 // scaled variance = variance >> VAR_SCALING
+#endif
 
 void filter_Init (void);
 
@@ -0,0 +1,24 @@
+/*
+ * format.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_FORMAT_H_
+#define INC_FORMAT_H_
+
+#include <stdint.h>
+
+#define FORMAT_UNSIGNED_DIGITS	10		// most digits in a uint32_t
+
+/*
+ * Each call writes at out, NUL terminated, and returns the address of the
+ * NUL so calls can be chained to build a line. Nothing is bounds checked:
+ * the caller's buffer must hold the longest line it builds.
+ */
+char* format_String (char* out, const char* text);
+char* format_Unsigned (char* out, uint32_t value, uint8_t min_digits);
+char* format_Fixed (char* out, uint32_t value, uint8_t decimals);
+
+#endif /* INC_FORMAT_H_ */
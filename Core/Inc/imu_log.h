@@ -0,0 +1,85 @@
+/*
+ * imu_log.h
+ *
+ * Compact columnar log of raw IMU samples
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_IMU_LOG_H_
+#define INC_IMU_LOG_H_
+
+#include <stdint.h>
+
+/*
+ * Layout, little endian:
+ *
+ * header   "SCTC" | u16 version | u16 rate_hz | i16 X_OFFSET, Y_OFFSET, Z_OFFSET
+ *          | u16 block_samples
+ * block    u16 count | u16 x_bytes, y_bytes, z_bytes | u32 first_sample
+ *          | i16 x0, y0, z0 | u8 flags | u8 reserved
+ *          x column, y column, z column: count-1 zigzag varint deltas
+ *          mark bitmap, (count+7)/8 bytes, if flags & IMU_LOG_FLAG_MARKS
+ * index    optional, appended when the log is closed on a host:
+ *          block_count x { u32 first_sample | u32 file_offset }
+ *          | u32 block_count | u32 sample_count | "SCTI"
+ */
+#define IMU_LOG_MAGIC				"SCTC"
+#define IMU_LOG_INDEX_MAGIC			"SCTI"
+#define IMU_LOG_VERSION				1
+#define IMU_LOG_HEADER_SIZE			16
+#define IMU_LOG_BLOCK_HEADER_SIZE	20
+#define IMU_LOG_INDEX_ENTRY_SIZE	8
+#define IMU_LOG_INDEX_FOOTER_SIZE	12
+#define IMU_LOG_FLAG_MARKS			0x01
+#define IMU_LOG_DECODE_ERROR		0xFFFFU
+
+#ifndef IMU_LOG_BLOCK_SAMPLES
+#define IMU_LOG_BLOCK_SAMPLES 64
+#endif
+
+#if (IMU_LOG_BLOCK_SAMPLES < 1) || (IMU_LOG_BLOCK_SAMPLES > 1024)
+#error "IMU_LOG_BLOCK_SAMPLES must be between 1 and 1024"
+#endif
+
+#define IMU_LOG_MARK_BYTES			((IMU_LOG_BLOCK_SAMPLES + 7) / 8)
+
+/* a delta takes at most 3 varint bytes */
+#define IMU_LOG_BLOCK_MAX_SIZE		(IMU_LOG_BLOCK_HEADER_SIZE + 3 * 3 * (IMU_LOG_BLOCK_SAMPLES - 1) \
+									+ IMU_LOG_MARK_BYTES)
+
+/* Called once with the header, then once per encoded block */
+typedef void (*imu_log_write_t) (const uint8_t* data, uint16_t length, void* context);
+
+typedef struct {
+	imu_log_write_t write;
+	void* context;
+	uint32_t samples;		// samples in completed blocks
+	uint16_t count;			// samples in the current block
+	uint8_t has_marks;
+	int16_t x[IMU_LOG_BLOCK_SAMPLES];
+	int16_t y[IMU_LOG_BLOCK_SAMPLES];
+	int16_t z[IMU_LOG_BLOCK_SAMPLES];
+	uint8_t marks[IMU_LOG_MARK_BYTES];
+	uint8_t block[IMU_LOG_BLOCK_MAX_SIZE];
+} imu_log_t;
+
+/* Block header as decoded by imuLog_ParseBlockHeader */
+typedef struct {
+	uint16_t count;
+	uint16_t column_bytes[3];
+	uint32_t first_sample;
+	int16_t first[3];
+	uint8_t flags;
+} imu_log_block_t;
+
+void imuLog_Init (imu_log_t* log, uint16_t rate_hz, imu_log_write_t write, void* context);
+void imuLog_Append (imu_log_t* log, int16_t x, int16_t y, int16_t z, uint8_t mark);
+void imuLog_Flush (imu_log_t* log);
+
+uint32_t imuLog_BlockSize (const imu_log_block_t* block);
+void imuLog_ParseBlockHeader (const uint8_t* data, imu_log_block_t* block);
+uint16_t imuLog_DecodeColumn (const uint8_t* data, uint16_t bytes, int16_t first, int16_t* out, uint16_t count);
+
+#endif /* INC_IMU_LOG_H_ */
@@ -0,0 +1,69 @@
+/*
+ * kernel.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_KERNEL_H_
+#define INC_KERNEL_H_
+
+#include <stdint.h>
+
+#define KERNEL_MAX_THREADS	4
+#define KERNEL_STACK_FILL	0xDEADBEEF	// unused stack words, for kernel_StackUsedGetter
+
+typedef enum {
+	KERNEL_READY,
+	KERNEL_SLEEPING,
+	KERNEL_BLOCKED,
+} kernel_state_t;
+
+struct kernel_mutex;
+
+/* Statically allocated by the caller, along with its stack */
+typedef struct {
+	uint32_t* sp;				// saved stack pointer while switched out, as the port keeps it
+	const char* name;
+	uint32_t* stack;
+	uint16_t stack_words;
+	uint8_t base_priority;		// 0 is the most urgent, one thread per priority
+	uint8_t priority;			// raised while holding a mutex a more urgent thread waits for
+	volatile uint8_t state;
+	volatile uint8_t wake_pending;
+	uint32_t wake_tick;
+	struct kernel_mutex* blocked_on;
+	uint32_t run_cycles;		// CPU cycles spent running, interrupts included
+} kernel_thread_t;
+
+/* Priority inheritance mutex; a thread may hold only one at a time */
+typedef struct kernel_mutex {
+	kernel_thread_t* volatile owner;
+} kernel_mutex_t;
+
+/* PendSV pended to new thread selected, in CPU cycles */
+typedef struct {
+	uint32_t count;
+	uint32_t last_cycles;
+	uint32_t max_cycles;
+} kernel_switch_stats_t;
+
+typedef void (*kernel_entry_t) (void);
+
+void kernel_CreateThread (kernel_thread_t* thread, const char* name, kernel_entry_t entry,
+		uint32_t* stack, uint16_t stack_words, uint8_t priority);
+void kernel_Start (void);
+void kernel_Tick (void);
+
+void kernel_SleepUntil (uint32_t tick);
+void kernel_Wake (kernel_thread_t* thread);
+
+void kernel_MutexInit (kernel_mutex_t* mutex);
+void kernel_MutexLock (kernel_mutex_t* mutex);
+void kernel_MutexUnlock (kernel_mutex_t* mutex);
+
+uint16_t kernel_StackUsedGetter (const kernel_thread_t* thread);
+uint32_t kernel_RunCyclesGetter (const kernel_thread_t* thread);
+void kernel_SwitchStatsGetter (kernel_switch_stats_t* stats);
+
+#endif /* INC_KERNEL_H_ */
@@ -0,0 +1,31 @@
+/*
+ * kernel_port.h
+ *
+ * What kernel.c needs from the core it runs on: a first frame on each
+ * thread's stack, the switch to thread stacks at start, and a PendSV_Handler
+ * that saves the outgoing thread, calls kernel_SwitchContext and restores
+ * the incoming one. Switches are requested with SCB->ICSR PENDSVSET.
+ * kernel_port.c is the Cortex-M0+ port; stepsim's simulated board has its
+ * own in Tools/host/sim/sim_kernel.c.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_KERNEL_PORT_H_
+#define INC_KERNEL_PORT_H_
+
+#include "kernel.h"
+
+#include <stdint.h>
+
+/* Saved stack pointer for a thread that starts at entry and calls exit if it returns */
+uint32_t* kernel_PortInitStack (uint32_t* stack, uint16_t stack_words, kernel_entry_t entry, kernel_entry_t exit);
+
+/* Move thread mode onto the thread stacks, with interrupts masked; the first PendSV picks the thread */
+void kernel_PortStart (void);
+
+/* Called by PendSV_Handler only: the outgoing thread's stack pointer in, the incoming one's out */
+uint32_t* kernel_SwitchContext (uint32_t* sp);
+
+#endif /* INC_KERNEL_PORT_H_ */
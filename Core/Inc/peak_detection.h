@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 
-void peakDetection_Execute (void);
+void peakDetection_Init (void);
+uint8_t peakDetection_Execute (void);
 
 #endif /* INC_PEAK_DETECTION_H_ */
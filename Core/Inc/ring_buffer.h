@@ -0,0 +1,41 @@
+/*
+ * ring_buffer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_RING_BUFFER_H_
+#define INC_RING_BUFFER_H_
+
+#include <stdint.h>
+
+/* Capacities must be a power of two no larger than this */
+#define RING_BUFFER_MAX_CAPACITY 32768
+#define RING_BUFFER_IS_POWER_OF_TWO(N) ((N) > 0 && ((N) & ((N) - 1)) == 0)
+
+/*
+ * Lock-free queue for exactly one producer and one consumer, e.g. an
+ * interrupt handler and a task. head is only written by the producer and
+ * tail only by the consumer; both count up freely and wrap at 2^16.
+ */
+typedef struct {
+	uint8_t* storage;			// capacity * element_size bytes
+	uint16_t element_size;
+	uint16_t mask;				// capacity - 1
+	volatile uint16_t head;		// next slot to write
+	volatile uint16_t tail;		// next slot to read
+	volatile uint16_t dropped;	// pushes lost because the ring was full
+} ring_buffer_t;
+
+/* Static initialiser, same as ringBuffer_Init on an array of CAPACITY elements */
+#define RING_BUFFER_INIT(STORAGE, CAPACITY) \
+	{ (uint8_t*) (STORAGE), sizeof((STORAGE)[0]), (CAPACITY) - 1, 0, 0, 0 }
+
+void ringBuffer_Init (ring_buffer_t* ring, void* storage, uint16_t element_size, uint16_t capacity);
+uint8_t ringBuffer_Push (ring_buffer_t* ring, const void* element);
+uint8_t ringBuffer_Pop (ring_buffer_t* ring, void* element);
+uint16_t ringBuffer_CountGetter (const ring_buffer_t* ring);
+uint16_t ringBuffer_DroppedGetter (const ring_buffer_t* ring);
+
+#endif /* INC_RING_BUFFER_H_ */
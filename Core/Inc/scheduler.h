@@ -0,0 +1,74 @@
+/*
+ * scheduler.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_SCHEDULER_H_
+#define INC_SCHEDULER_H_
+
+#include <stdint.h>
+
+#define SCHEDULER_MAX_TASKS 12	// task table rows; a longer table stops in scheduler_Init, see app.c
+
+#ifndef SCHEDULER_CATCH_UP_MAX
+#define SCHEDULER_CATCH_UP_MAX 4	// most missed periods a CATCH_UP task runs back to back
+#endif
+
+#ifndef SCHEDULER_BUDGET_CYCLES
+#define SCHEDULER_BUDGET_CYCLES 12000	// longest a task should run before yielding (1 ms at 12 MHz)
+#endif
+
+#define SCHEDULER_WAIT_FOREVER 0x7FFFFFFF	// scheduler_Resume timeout (us) for waits that only an event ends
+
+typedef void (*scheduler_function_t) (void);
+
+/* What to do with the periods a task missed by overrunning */
+typedef enum {
+	SCHEDULER_OVERRUN_SKIP,			// drop them, keep the phase
+	SCHEDULER_OVERRUN_CATCH_UP,		// run up to SCHEDULER_CATCH_UP_MAX of them back to back, drop the rest
+	SCHEDULER_OVERRUN_REPHASE,		// drop them, next run one period after the overrun finished
+} scheduler_overrun_t;
+
+/* One row of the const task table, times in ms */
+typedef struct {
+	const char* name;
+	scheduler_function_t execute;
+	uint32_t period_ms;
+	uint32_t phase_ms;		// first run this long after scheduler_Init
+	uint8_t priority;			// 0 runs first when several tasks are due
+	scheduler_overrun_t overrun;
+	uint8_t supervised;		// the watchdog is only fed while it keeps its deadlines, see supervisor.c
+} scheduler_task_t;
+
+/* Execution times in CPU cycles, see scheduler_CycleStamp */
+typedef struct {
+	uint32_t run_count;			// every call, including resumed ones
+	uint32_t last_cycles;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+	uint32_t mean_cycles;
+	uint32_t deadline_misses;	// still running (or not started) when the next period began, once per overrun
+	uint32_t skipped_periods;	// periods dropped by the overrun policy
+	uint32_t catch_up_runs;		// late runs for missed periods, see SCHEDULER_OVERRUN_CATCH_UP
+} scheduler_stats_t;
+
+void scheduler_Init (const scheduler_task_t* tasks, uint8_t num_tasks);
+void scheduler_Dispatch (void);
+uint32_t scheduler_NearestDeadline (void);
+uint32_t scheduler_CycleStamp (void);
+uint32_t scheduler_TimeGetter (void);
+
+/* For use by the running task, see coroutine.h */
+void scheduler_Resume (uint32_t timeout_us);
+void scheduler_Rephase (void);
+uint8_t scheduler_BudgetExpired (void);
+
+uint8_t scheduler_TaskCountGetter (void);
+const scheduler_task_t* scheduler_TaskGetter (uint8_t task);
+void scheduler_StatsGetter (uint8_t task, scheduler_stats_t* stats);
+void scheduler_ResetStats (void);
+uint32_t scheduler_DeadlineMissesGetter (void);
+
+#endif /* INC_SCHEDULER_H_ */
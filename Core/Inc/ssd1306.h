@@ -8,6 +8,13 @@
  * - Fix typo: make the "c" in "stm32c0xx_hal.h" lower case.
  * - Improve performance of I2C comms by using the DMA
  * 		and interrupt-driven page updates.
+ * - Only send the rectangle that changed since the last flush, as one DMA transfer (I2C).
+ * - Draw into a back buffer while the front buffer is sent (I2C).
+ * - Queue commands and data for the I2C bus; nothing waits for it.
+ * - Draw text a glyph column at a time instead of a pixel at a time.
+ * - Page-major fonts holding only the characters used (SSD1306_PageFont_t).
+ * - Integer arcs (quarter-wave sine table, midpoint circle); no libm.
+ * - Page-at-a-time vertical lines and scrolling of a band of pages.
  */
 
 #ifndef __SSD1306_H__
@@ -123,6 +130,46 @@ extern SPI_HandleTypeDef SSD1306_SPI_PORT;
 #define SSD1306_WIDTH           128
 #endif
 
+// Time from reset until the controller accepts commands
+#ifndef SSD1306_BOOT_TIME_MS
+#define SSD1306_BOOT_TIME_MS    100
+#endif
+
+// Flush only what differs between the back and front buffer; 0 always sends the whole frame (I2C)
+#ifndef SSD1306_FLUSH_DIFF
+#define SSD1306_FLUSH_DIFF      1
+#endif
+
+// Transactions queued for the I2C bus, a power of two up to 128
+#ifndef SSD1306_QUEUE_SIZE
+#define SSD1306_QUEUE_SIZE      8
+#endif
+
+// Command bytes queued for the I2C bus, a power of two; the power-up sequence is about 30
+#ifndef SSD1306_COMMAND_BYTES
+#define SSD1306_COMMAND_BYTES   64
+#endif
+
+// A transaction still on the bus after this long has failed; a whole frame takes ~90 ms at 100 kHz
+#ifndef SSD1306_TRANSFER_TIMEOUT_MS
+#define SSD1306_TRANSFER_TIMEOUT_MS 150
+#endif
+
+// Failed transactions in a row before flushes stop for good, see ssd1306_GaveUpGetter
+#ifndef SSD1306_MAX_FAILURES
+#define SSD1306_MAX_FAILURES    3
+#endif
+
+#if (SSD1306_QUEUE_SIZE & (SSD1306_QUEUE_SIZE - 1)) || SSD1306_QUEUE_SIZE > 128 \
+        || (SSD1306_COMMAND_BYTES & (SSD1306_COMMAND_BYTES - 1))
+#error "SSD1306_QUEUE_SIZE and SSD1306_COMMAND_BYTES must be powers of two, the queue at most 128"
+#endif
+
+// Draw text a glyph column at a time; 0 draws it a pixel at a time, e.g. to compare
+#ifndef SSD1306_BLIT_TEXT
+#define SSD1306_BLIT_TEXT       1
+#endif
+
 #ifndef SSD1306_BUFFER_SIZE
 #define SSD1306_BUFFER_SIZE   SSD1306_WIDTH * SSD1306_HEIGHT / 8
 #endif
@@ -159,13 +206,30 @@ typedef struct {
     const uint8_t *const char_width;    /**< Proportional character width in pixels (NULL for monospaced) */
 } SSD1306_Font_t;
 
+#define SSD1306_NO_GLYPH        0xFF    // character left out of a page-major font
+
+/** Page-major font, generated from the fonts above by Tools/host/fontconv */
+typedef struct {
+	const uint8_t width;                /**< Font width in pixels */
+	const uint8_t height;               /**< Font height in pixels */
+	const uint8_t *const index;         /**< Glyph of each character from ' ' to '~', SSD1306_NO_GLYPH if left out */
+	const uint8_t *const data;          /**< Per glyph, one row of column bytes per page, bit 0 at the top */
+} SSD1306_PageFont_t;
+
 // Procedure definitions
 void ssd1306_Init(void);
+uint8_t ssd1306_WriteInitCommand(uint8_t index);
+void ssd1306_InitFinish(void);
 void ssd1306_Fill(SSD1306_COLOR color);
 void ssd1306_UpdateScreen(void);
+void ssd1306_InvalidateScreen(void);
+uint8_t ssd1306_ProcessEvents(void);
+uint8_t ssd1306_FlushStarted(void);
 void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color);
 char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color);
 char ssd1306_WriteString(char* str, SSD1306_Font_t Font, SSD1306_COLOR color);
+char ssd1306_WritePageChar(char ch, const SSD1306_PageFont_t* Font, SSD1306_COLOR color);
+char ssd1306_WritePageString(const char* str, const SSD1306_PageFont_t* Font, SSD1306_COLOR color);
 void ssd1306_SetCursor(uint8_t x, uint8_t y);
 void ssd1306_Line(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color);
@@ -175,6 +239,8 @@ void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR
 void ssd1306_Polyline(const SSD1306_VERTEX *par_vertex, uint16_t par_size, SSD1306_COLOR color);
 void ssd1306_DrawRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
 void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_VerticalLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color);
+void ssd1306_ScrollPagesLeft(uint8_t firstPage, uint8_t lastPage, uint8_t columns);
 
 /**
  * @brief Invert color of pixels in rectangle (include border)
@@ -213,7 +279,11 @@ uint8_t ssd1306_GetDisplayOn();
 // Low-level procedures
 void ssd1306_Reset(void);
 void ssd1306_WriteCommand(uint8_t byte);
-void ssd1306_WriteData(uint8_t* buffer, size_t buff_size);
+SSD1306_Error_t ssd1306_WriteCommands(const uint8_t* bytes, uint16_t count);
+uint16_t ssd1306_CommandsDroppedGetter(void);
+uint16_t ssd1306_TransferFailuresGetter(void);
+uint8_t ssd1306_GaveUpGetter(void);
+SSD1306_Error_t ssd1306_WriteData(uint8_t* buffer, size_t buff_size);
 SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len);
 
 _END_STD_C
@@ -42,15 +42,16 @@
 // Set inverse color if needed
 // # define SSD1306_INVERSE_COLOR
 
-// Include only needed fonts
-#define SSD1306_INCLUDE_FONT_6x8
-#define SSD1306_INCLUDE_FONT_7x10
-#define SSD1306_INCLUDE_FONT_11x18
-#define SSD1306_INCLUDE_FONT_16x26
+// Include only needed fonts. The UI draws with the page-major
+// subsets in ssd1306_page_fonts.c, which need none of these.
+//#define SSD1306_INCLUDE_FONT_6x8
+//#define SSD1306_INCLUDE_FONT_7x10
+//#define SSD1306_INCLUDE_FONT_11x18
+//#define SSD1306_INCLUDE_FONT_16x26
 
-#define SSD1306_INCLUDE_FONT_16x24
+//#define SSD1306_INCLUDE_FONT_16x24
 
-#define SSD1306_INCLUDE_FONT_16x15
+//#define SSD1306_INCLUDE_FONT_16x15
 
 // The width of the screen can be set using this
 // define. The default value is 128.
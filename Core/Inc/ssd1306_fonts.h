@@ -26,4 +26,7 @@ extern const SSD1306_Font_t Font_16x24;
 extern const SSD1306_Font_t Font_16x15;
 #endif
 
+/* Page-major subsets in ssd1306_page_fonts.c, generated by Tools/host/Makefile (UI_FONTS) */
+extern const SSD1306_PageFont_t PageFont_7x10;
+
 #endif // __SSD1306_FONTS_H__
@@ -16,7 +16,8 @@ typedef enum {
     STATE_CURRENT_STEPS,
     STATE_DISTANCE_TRAVELLED,
     STATE_GOAL_PROGRESS,
-    STATE_SET_GOAL
+    STATE_SET_GOAL,
+    STATE_STEP_HISTORY
 } DisplayState;
 
 typedef enum {
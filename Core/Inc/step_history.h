@@ -0,0 +1,32 @@
+/*
+ * step_history.h
+ *
+ * Steps taken in each of the last STEP_HISTORY_MINUTES minutes, for the
+ * step history graph on the display.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_STEP_HISTORY_H_
+#define INC_STEP_HISTORY_H_
+
+#include <stdint.h>
+
+#ifndef STEP_HISTORY_MINUTES
+#define STEP_HISTORY_MINUTES	128		// a power of two; the graph shows one minute per column
+#endif
+
+#if (STEP_HISTORY_MINUTES & (STEP_HISTORY_MINUTES - 1)) || STEP_HISTORY_MINUTES > 256
+#error "STEP_HISTORY_MINUTES must be a power of two up to 256"
+#endif
+
+#define STEP_HISTORY_PERIOD_MS	60000	// stepHistory_Execute closes a minute each run
+#define STEP_HISTORY_MAX_STEPS	255		// a minute's count saturates here
+
+void stepHistory_Init (void);
+void stepHistory_Execute (void);
+uint32_t stepHistory_MinutesGetter (void);
+uint8_t stepHistory_MinuteGetter (uint32_t minute);
+
+#endif /* INC_STEP_HISTORY_H_ */
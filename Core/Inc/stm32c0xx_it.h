@@ -49,11 +49,11 @@
 void NMI_Handler(void);
 void HardFault_Handler(void);
 void SVC_Handler(void);
-void PendSV_Handler(void);
 void SysTick_Handler(void);
 void DMA1_Channel1_IRQHandler(void);
 void DMA1_Channel2_3_IRQHandler(void);
 void I2C1_IRQHandler(void);
+void USART2_IRQHandler(void);
 /* USER CODE BEGIN EFP */
 
 /* USER CODE END EFP */
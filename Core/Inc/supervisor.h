@@ -0,0 +1,74 @@
+/*
+ * supervisor.h
+ *
+ * Task supervision: tasks check in with the supervisor when they finish a
+ * run on time, and the independent watchdog is only fed while every
+ * supervised task keeps doing so; kernel threads outside the task table
+ * join in with supervisor_AddThread. A watchdog reset keeps the trace ring
+ * and the task that was running for a report on the next boot.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_SUPERVISOR_H_
+#define INC_SUPERVISOR_H_
+
+#include <stdint.h>
+
+#ifndef SUPERVISOR_WATCHDOG
+#define SUPERVISOR_WATCHDOG 1		// 0 supervises and reports but never starts the IWDG, e.g. for debugging
+#endif
+
+#ifndef SUPERVISOR_TIMEOUT_MS
+#define SUPERVISOR_TIMEOUT_MS 1000	// IWDG timeout, longer than a healthy device goes unfed: the display riding out a failed transfer (SSD1306_TRANSFER_TIMEOUT_MS) and powering up again
+#endif
+
+#if SUPERVISOR_TIMEOUT_MS < 2 || SUPERVISOR_TIMEOUT_MS > 4096
+#error "SUPERVISOR_TIMEOUT_MS must be 2 to 4096 (LSI / 32, 12-bit reload)"
+#endif
+
+#ifndef SUPERVISOR_GRACE_MS
+#define SUPERVISOR_GRACE_MS 100		// a supervised task is overdue this long after its period without checking in
+#endif
+
+#ifndef SUPERVISOR_MAX_THREADS
+#define SUPERVISOR_MAX_THREADS 1	// kernel threads supervised besides the scheduled tasks
+#endif
+
+#define SUPERVISOR_NO_TASK 0xFF		// running task outside any scheduled task, e.g. during start-up
+
+/* Kept through resets other than power loss; startup code does not clear it */
+#define SUPERVISOR_NOINIT __attribute__ ((section (".noinit")))
+
+typedef enum {
+	SUPERVISOR_RESET_POWER,
+	SUPERVISOR_RESET_PIN,
+	SUPERVISOR_RESET_SOFTWARE,
+	SUPERVISOR_RESET_WATCHDOG,
+	SUPERVISOR_RESET_OTHER,
+} supervisor_reset_t;
+
+typedef struct {
+	supervisor_reset_t cause;
+	uint8_t task;				// running at a watchdog reset, SUPERVISOR_NO_TASK otherwise
+	uint16_t watchdog_resets;	// since power-up
+	uint32_t released;			// a bit per task index no longer supervised since this boot, see supervisor_Release
+} supervisor_report_t;
+
+void supervisor_Init (void);
+void supervisor_Execute (void);
+void supervisor_ReportGetter (supervisor_report_t* report);
+
+/* Called by the scheduler around and after each run */
+void supervisor_TaskStart (uint8_t task);
+void supervisor_TaskStop (void);
+void supervisor_CheckIn (uint8_t task);
+
+/* A thread that checks in with the returned index at least every period_ms */
+uint8_t supervisor_AddThread (uint16_t period_ms);
+
+/* Called by a task that can no longer keep its period */
+void supervisor_Release (void);
+
+#endif /* INC_SUPERVISOR_H_ */
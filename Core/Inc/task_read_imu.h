@@ -10,8 +10,18 @@
 
 #include <stdint.h>
 
+/* measured LSM6DS zero-g offsets, added to the raw readings */
+#define X_OFFSET 245
+#define Y_OFFSET 140
+#define Z_OFFSET (-300)
+
+#define BIT_SHIFT_SCALE 10 // scale magnitude by 2^10 = 1024
+
 void imu_Init (void);
 void imu_Execute (void);
+void imu_ExecuteAll (void);
+void imu_CountQueuedSteps (void);
+uint16_t imu_ProcessBlock (const int16_t* x, const int16_t* y, const int16_t* z, uint16_t count, uint8_t* steps);
 
 int16_t imu_xAccGetter (void);
 int16_t imu_xFilteredGetter (void);
@@ -0,0 +1,25 @@
+/*
+ * timebase.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_TIMEBASE_H_
+#define INC_TIMEBASE_H_
+
+#include <stdint.h>
+
+#define TIMEBASE_HZ			1000000U
+#define TIMEBASE_US_PER_MS	1000U
+#define TIMEBASE_MS(MS)		((uint32_t) (MS) * TIMEBASE_US_PER_MS)
+
+void timebase_Init (void);
+
+/* Microseconds since timebase_Init, monotonic for ~8.9 years (48 bits) */
+uint64_t timebase_MicrosGetter (void);
+
+/* Low 32 bits of the above, wraps every ~71.6 min: compare with signed differences only */
+uint32_t timebase_Micros32Getter (void);
+
+#endif /* INC_TIMEBASE_H_ */
@@ -0,0 +1,97 @@
+/*
+ * trace.h
+ *
+ * Always-on execution trace: timestamped binary events in a RAM ring,
+ * dumped over USART2 and converted on the host by Tools/host/trace2perfetto.
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: T. Linton, J. Legg
+ */
+
+#ifndef INC_TRACE_H_
+#define INC_TRACE_H_
+
+#include <stdint.h>
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE 1		// 0 compiles every TRACE_ macro to nothing
+#endif
+
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS 256		// 8 bytes each, the oldest are overwritten
+#endif
+
+#if (TRACE_BUFFER_EVENTS & (TRACE_BUFFER_EVENTS - 1)) != 0
+#error "TRACE_BUFFER_EVENTS must be a power of two"
+#endif
+
+#ifndef TRACE_SYSTICK
+#define TRACE_SYSTICK 0		// 1 also traces SysTick_Handler, 2 events every ms
+#endif
+
+/*
+ * Dump layout, little endian:
+ *
+ * header   "SCTE" | u16 version | u16 event_size | u32 clock_hz | u32 count
+ *          | u32 lost | u16 names_bytes
+ * names    scheduler task names, each NUL terminated, in table order
+ * events   count x { u32 time | u8 type | u8 id | u16 arg }, oldest first
+ *          time counts at clock_hz and wraps at 32 bits; an event may be
+ *          stamped slightly earlier than the one before it, see trace_Record
+ */
+#define TRACE_MAGIC			"SCTE"
+#define TRACE_VERSION		1
+#define TRACE_HEADER_SIZE	22
+#define TRACE_EVENT_SIZE	8
+
+typedef enum {
+	TRACE_TASK_START = 1,	// id = scheduler task index
+	TRACE_TASK_STOP,
+	TRACE_ISR_ENTER,		// id = trace_isr_t
+	TRACE_ISR_EXIT,
+	TRACE_DMA_START,		// id = trace_dma_t, arg = bytes or transfers
+	TRACE_DMA_COMPLETE,
+	TRACE_STEP,				// arg = steps found in the sample
+	TRACE_RESET,			// first event after a watchdog reset, id = task running, arg = resets since power-up
+} trace_type_t;
+
+typedef enum {
+	TRACE_ISR_SYSTICK,
+	TRACE_ISR_DMA_ADC,		// DMA1 channel 1
+	TRACE_ISR_DMA_I2C,		// DMA1 channels 2 and 3
+	TRACE_ISR_I2C1,
+} trace_isr_t;
+
+typedef enum {
+	TRACE_DMA_ADC,
+	TRACE_DMA_DISPLAY,
+} trace_dma_t;
+
+typedef struct {
+	uint32_t time_us;		// timebase_Micros32Getter
+	uint8_t type;
+	uint8_t id;
+	uint16_t arg;
+} trace_event_t;
+
+void trace_Start (uint8_t keep);
+void trace_Record (uint8_t type, uint8_t id, uint16_t arg);
+void trace_Dump (void);
+void trace_Execute (void);
+
+#if TRACE_ENABLE
+#define TRACE(TYPE, ID, ARG)	trace_Record ((TYPE), (ID), (ARG))
+#else
+#define TRACE(TYPE, ID, ARG)	((void) 0)
+#endif
+
+#define TRACE_TASK_START(TASK)		TRACE (TRACE_TASK_START, (TASK), 0)
+#define TRACE_TASK_STOP(TASK)		TRACE (TRACE_TASK_STOP, (TASK), 0)
+#define TRACE_ISR_ENTER(ISR)		TRACE (TRACE_ISR_ENTER, (ISR), 0)
+#define TRACE_ISR_EXIT(ISR)			TRACE (TRACE_ISR_EXIT, (ISR), 0)
+#define TRACE_DMA_START(DMA, SIZE)	TRACE (TRACE_DMA_START, (DMA), (SIZE))
+#define TRACE_DMA_COMPLETE(DMA)		TRACE (TRACE_DMA_COMPLETE, (DMA), 0)
+#define TRACE_STEP(STEPS)			TRACE (TRACE_STEP, 0, (STEPS))
+#define TRACE_RESET(TASK, COUNT)	TRACE (TRACE_RESET, (TASK), (COUNT))
+
+#endif /* INC_TRACE_H_ */
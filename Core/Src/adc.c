@@ -21,7 +21,20 @@
 #include "adc.h"
 
 /* USER CODE BEGIN 0 */
-static uint16_t raw_adc[3];
+#include "ring_buffer.h"
+#include "trace.h"
+
+#define ADC_CHANNELS			3
+#define ADC_RING_SIZE			2	// conversions finished but not yet taken by adc_Execute
+
+#if !RING_BUFFER_IS_POWER_OF_TWO(ADC_RING_SIZE)
+#error "ADC_RING_SIZE must be a power of two"
+#endif
+
+static uint16_t dma_adc[ADC_CHANNELS];		// written by DMA only
+static uint16_t raw_adc[ADC_CHANNELS];		// latest conversion, task side only
+static uint16_t adc_storage[ADC_RING_SIZE][ADC_CHANNELS];
+static ring_buffer_t adc_ring;
 /* USER CODE END 0 */
 
 ADC_HandleTypeDef hadc1;
@@ -91,7 +104,7 @@ void MX_ADC1_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN ADC1_Init 2 */
-
+  ringBuffer_Init(&adc_ring, adc_storage, sizeof(adc_storage[0]), ADC_RING_SIZE);
   /* USER CODE END ADC1_Init 2 */
 
 }
@@ -189,9 +202,14 @@ void HAL_ADC_MspDeInit(ADC_HandleTypeDef* adcHandle)
 }
 
 /* USER CODE BEGIN 1 */
+/* Take the conversions finished since the last run and start the next one */
 void adc_Execute (void)
 {
-	HAL_ADC_Start_DMA (&hadc1, (uint32_t*)raw_adc, 3);
+	while (ringBuffer_Pop (&adc_ring, raw_adc)) {
+		/* only the newest conversion is kept */
+	}
+	TRACE_DMA_START (TRACE_DMA_ADC, ADC_CHANNELS);
+	HAL_ADC_Start_DMA (&hadc1, (uint32_t*)dma_adc, ADC_CHANNELS);
 }
 
 
@@ -208,8 +226,12 @@ void adc_PotentiometerGetter (uint16_t* potentiometer_adc)
 }
 
 
+/* Hand the finished conversion to adc_Execute before the DMA buffer is reused */
 void HAL_ADC_ConvCpltCallback (ADC_HandleTypeDef *hadc)
 {
-
+	if (hadc == &hadc1) {
+		TRACE_DMA_COMPLETE (TRACE_DMA_ADC);
+		ringBuffer_Push (&adc_ring, dma_adc);
+	}
 }
 /* USER CODE END 1 */
@@ -13,7 +13,13 @@
 #include "task_display.h"
 #include "task_read_imu.h"
 #include "task_buzzer.h"
+#include "step_history.h"
 #include "adc.h"
+#include "scheduler.h"
+#include "kernel.h"
+#include "trace.h"
+#include "supervisor.h"
+#include "timebase.h"
 
 #define TICK_FREQUENCY_HZ 1000
 #define HZ_TO_TICKS(FREQUENCY_HZ) (TICK_FREQUENCY_HZ / FREQUENCY_HZ)
@@ -25,78 +31,304 @@
 #define POLL_BUTTONS_PERIOD_TICKS       HZ_TO_TICKS(POLL_BUTTONS_FREQUENCY_HZ)
 #define IMU_PERIOD_TICKS				HZ_TO_TICKS(IMU_FREQUENCY_HZ)
 #define BUZZER_PERIOD_TICKS				HZ_TO_TICKS(BUZZER_FREQUENCY_HZ)
+#define TRACE_PERIOD_TICKS				HZ_TO_TICKS(TRACE_FREQUENCY_HZ)
+#define SUPERVISOR_PERIOD_TICKS			HZ_TO_TICKS(SUPERVISOR_FREQUENCY_HZ)
+#define HISTORY_PERIOD_TICKS			(STEP_HISTORY_PERIOD_MS * TICK_FREQUENCY_HZ / 1000) // once a minute
 
 #define IMU_FREQUENCY_HZ				100
 #define POLL_BUTTONS_FREQUENCY_HZ 		100
 #define JOYSTICK_FREQUENCY_HZ 			8
 #define ADC_FREQUENCY_HZ 				8
 #define LEDS_FREQUENCY_HZ				4
-#define DISPLAY_FREQUENCY_HZ 			4
+#define DISPLAY_FREQUENCY_HZ 			20 // only redraws and sends what changed, so idle runs cost a comparison
 #define BUZZER_FREQUENCY_HZ				1
+#define TRACE_FREQUENCY_HZ				4
+#define SUPERVISOR_FREQUENCY_HZ			10
 
-static uint32_t poll_buttons_next_run 	= 0;
-static uint32_t display_next_run 		= 0;
-static uint32_t joystick_next_run 		= 0;
-static uint32_t leds_next_run			= 0;
-static uint32_t adc_next_run 			= 0;
-static uint32_t imu_next_run 			= 0;
-static uint32_t buzzer_next_run 		= 0;
+#ifndef APP_TICKLESS_IDLE
+#define APP_TICKLESS_IDLE				1 // stretch SysTick over idle periods instead of waking every tick
+#endif
+#define DUTY_WINDOW_TICKS				1000 // busy cycles per 1000 ticks / cycles per tick = permille
 
+/*
+ * Every task runs first one period after start-up; IMU sampling has the highest priority.
+ * Filter windows and peak cooldowns count samples, so a late IMU task catches up to keep
+ * 100 samples a second; the other tasks only need the latest state.
+ * Sampling, buttons and the display, which waits on I2C DMA, are supervised;
+ * the supervisor runs last so it sees every task that was due before it.
+ * With APP_USE_KERNEL the IMU has a thread of its own instead, supervised as a thread.
+ */
+static const scheduler_task_t tasks[] = {
+	/* name			execute						period						phase						priority	overrun							supervised */
+#if !APP_USE_KERNEL
+	{"imu",			imu_Execute,				IMU_PERIOD_TICKS,			IMU_PERIOD_TICKS,			0,			SCHEDULER_OVERRUN_CATCH_UP,		1},
+#endif
+	{"buttons",		taskButtons_PollExecute,	POLL_BUTTONS_PERIOD_TICKS,	POLL_BUTTONS_PERIOD_TICKS,	1,			SCHEDULER_OVERRUN_SKIP,			1},
+	{"adc",			adc_Execute,				ADC_PERIOD_TICKS,			ADC_PERIOD_TICKS,			2,			SCHEDULER_OVERRUN_SKIP,			0},
+	{"joystick",	task_joystick_execute,		JOYSTICK_PERIOD_TICKS,		JOYSTICK_PERIOD_TICKS,		3,			SCHEDULER_OVERRUN_SKIP,			0},
+	{"buzzer",		buzzer_Execute,				BUZZER_PERIOD_TICKS,		BUZZER_PERIOD_TICKS,		4,			SCHEDULER_OVERRUN_REPHASE,		0},
+	{"leds",		taskLeds_Execute,			LEDS_PERIOD_TICKS,			LEDS_PERIOD_TICKS,			5,			SCHEDULER_OVERRUN_SKIP,			0},
+	{"history",		stepHistory_Execute,		HISTORY_PERIOD_TICKS,		HISTORY_PERIOD_TICKS,		6,			SCHEDULER_OVERRUN_SKIP,			0},
+	{"display",		taskDisplay_Execute,		DISPLAY_PERIOD_TICKS,		DISPLAY_PERIOD_TICKS,		7,			SCHEDULER_OVERRUN_REPHASE,		1},
+#if TRACE_ENABLE
+	{"trace",		trace_Execute,				TRACE_PERIOD_TICKS,			TRACE_PERIOD_TICKS,			8,			SCHEDULER_OVERRUN_REPHASE,		0},
+#endif
+	{"supervisor",	supervisor_Execute,			SUPERVISOR_PERIOD_TICKS,	SUPERVISOR_PERIOD_TICKS,	9,			SCHEDULER_OVERRUN_SKIP,			0},
+};
 
-void app_main (void)
+#define NUM_TASKS (sizeof(tasks) / sizeof(tasks[0]))
+_Static_assert (NUM_TASKS <= SCHEDULER_MAX_TASKS, "task table is longer than SCHEDULER_MAX_TASKS");
+
+#if APP_USE_KERNEL
+#define SENSOR_STACK_WORDS				128
+#define UI_STACK_WORDS					384 // display rendering and text formatting
+#define BACKGROUND_STACK_WORDS			64
+
+/* Lower number preempts higher */
+#define SENSOR_PRIORITY					0
+#define UI_PRIORITY						1
+#define BACKGROUND_PRIORITY				2
+
+static uint32_t sensor_stack[SENSOR_STACK_WORDS];
+static uint32_t ui_stack[UI_STACK_WORDS];
+static uint32_t background_stack[BACKGROUND_STACK_WORDS];
+
+static kernel_thread_t sensor_thread;
+static kernel_thread_t ui_thread;
+static kernel_thread_t background_thread;
+
+static uint8_t sensor_supervision;
+static uint32_t idle_cycles_start		= 0;
+#else
+static volatile uint8_t wake_pending	= 0;
+static uint32_t busy_cycles				= 0;
+#endif
+static uint32_t duty_window_start		= 0;
+static uint16_t duty_permille			= 0;
+
+
+/* Wake the main loop before the next deadline, safe to call from interrupts */
+void app_Wake (void)
 {
-	taskDisplay_Init ();
-	taskButtons_Init ();
-	stateMachine_Init ();
-	taskLeds_Init ();
-	imu_Init ();
+#if APP_USE_KERNEL
+	kernel_Wake (&ui_thread);
+#else
+	wake_pending = 1;
+#endif
+}
 
-	poll_buttons_next_run 	= HAL_GetTick () + POLL_BUTTONS_PERIOD_TICKS;
-	joystick_next_run 		= HAL_GetTick () + JOYSTICK_PERIOD_TICKS;
-	adc_next_run			= HAL_GetTick () + ADC_PERIOD_TICKS;
-	display_next_run 		= HAL_GetTick () + DISPLAY_PERIOD_TICKS;
-	imu_next_run			= HAL_GetTick () + IMU_PERIOD_TICKS;
-	leds_next_run			= HAL_GetTick () + LEDS_PERIOD_TICKS;
 
-	while (1)
-	{
-		uint32_t ticks = HAL_GetTick ();
+/* Share of CPU time spent running tasks over the last second, in 0.1% */
+uint16_t app_DutyCycleGetter (void)
+{
+	return duty_permille;
+}
 
-		if (ticks > joystick_next_run) {
-			task_joystick_execute ();
-			joystick_next_run += JOYSTICK_PERIOD_TICKS;
-		}
 
-		if (ticks > leds_next_run) {
-			taskLeds_Execute ();
-			leds_next_run += LEDS_PERIOD_TICKS;
-		}
+/* Whole SysTick ticks until wake_us (scheduler time), 0 if it has passed */
+static uint32_t app_TicksUntil (uint32_t wake_us)
+{
+	int32_t remaining = (int32_t) (wake_us - timebase_Micros32Getter ());
+	if (remaining <= 0) {
+		return 0;
+	}
+	return ((uint32_t) remaining + TIMEBASE_US_PER_MS - 1) / TIMEBASE_US_PER_MS;
+}
+
+
+#if APP_USE_KERNEL
+/* Stack high-water marks in words, to size the stacks above; the display shows them in test mode */
+void app_StackUsageGetter (uint16_t* sensor, uint16_t* ui, uint16_t* background)
+{
+	*sensor = kernel_StackUsedGetter (&sensor_thread);
+	*ui = kernel_StackUsedGetter (&ui_thread);
+	*background = kernel_StackUsedGetter (&background_thread);
+}
 
-		if (ticks > adc_next_run) {
-			adc_Execute ();
-			adc_next_run += ADC_PERIOD_TICKS;
-		}
 
-		if (ticks > poll_buttons_next_run) {
-			taskButtons_PollExecute ();
-			poll_buttons_next_run += POLL_BUTTONS_PERIOD_TICKS;
+/*
+ * IMU sampling and step detection, preempts everything else.
+ * Shares no state with the ui thread: steps reach the state machine
+ * through imu_CountQueuedSteps, so nothing here ever waits for a task.
+ * Checks in with the supervisor after each run done before the next
+ * period begins, as the scheduler does for its tasks.
+ */
+static void app_SensorThread (void)
+{
+	uint32_t next_run = HAL_GetTick ();
+
+	while (1) {
+		next_run += IMU_PERIOD_TICKS;
+		kernel_SleepUntil (next_run);
+		imu_ExecuteAll ();
+		if ((int32_t) (HAL_GetTick () - next_run) < (int32_t) IMU_PERIOD_TICKS) {
+			supervisor_CheckIn (sensor_supervision);
 		}
+	}
+}
+
+
+/* The scheduler's task table, between IMU samples; the only thread that touches the state machine */
+static void app_UiThread (void)
+{
+	while (1) {
+		imu_CountQueuedSteps ();
+		scheduler_Dispatch ();
+
+		kernel_SleepUntil (HAL_GetTick () + app_TicksUntil (scheduler_NearestDeadline ()));
+	}
+}
 
 
-		if (ticks > display_next_run) {
-			taskDisplay_Execute ();
-			display_next_run += DISPLAY_PERIOD_TICKS;
+/* Runs whenever nothing else can; its share of the window is the idle time */
+static void app_BackgroundThread (void)
+{
+	while (1) {
+		uint32_t ticks = HAL_GetTick ();
+		if (ticks - duty_window_start >= DUTY_WINDOW_TICKS) {
+			uint32_t idle_cycles = kernel_RunCyclesGetter (&background_thread);
+			uint32_t idle_permille = (idle_cycles - idle_cycles_start) / (SysTick->LOAD + 1);
+			duty_permille = idle_permille < DUTY_WINDOW_TICKS ? DUTY_WINDOW_TICKS - idle_permille : 0;
+			idle_cycles_start = idle_cycles;
+			duty_window_start = ticks;
 		}
 
-		if (ticks > imu_next_run) {
-			imu_Execute ();
-			imu_next_run += IMU_PERIOD_TICKS;
+		__DSB ();
+		__WFI ();
+	}
+}
+#else
+#if APP_TICKLESS_IDLE
+/*
+ * Sleep for up to sleep_ticks with a single SysTick interrupt at the end,
+ * then put back the ticks that were skipped. Called with interrupts masked;
+ * any other interrupt still ends the WFI and is taken once they are unmasked.
+ */
+static void app_SleepTicks (uint32_t sleep_ticks)
+{
+	uint32_t period = SysTick->LOAD + 1;
+	uint32_t max_ticks = SysTick_LOAD_RELOAD_Msk / period - 1;
+	if (sleep_ticks > max_ticks) {
+		sleep_ticks = max_ticks;
+	}
+
+	/* stop without reading CTRL, that would clear COUNTFLAG */
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk;
+	uint32_t remaining = SysTick->VAL;	// cycles left in the current tick
+	if (remaining == 0 || (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk)) {
+		/* a tick is due right now, let it through */
+		SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+		return;
+	}
+
+	uint32_t stretched = remaining + (sleep_ticks - 1) * period;
+	SysTick->LOAD = stretched - 1;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+
+	__DSB ();
+	__WFI ();
+
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk;
+	uint32_t skipped;
+	uint32_t next_tick;
+
+	if (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk) {
+		/* slept the whole way, SysTick_Handler adds the final tick */
+		skipped = sleep_ticks - 1;
+		next_tick = period - (stretched - SysTick->VAL);
+	} else {
+		/* woken early by another interrupt */
+		uint32_t slept = stretched - SysTick->VAL;
+		if (slept < remaining) {
+			skipped = 0;
+			next_tick = remaining - slept;
+		} else {
+			slept -= remaining;
+			skipped = 1 + slept / period;
+			next_tick = period - slept % period;
 		}
+	}
+	if (next_tick == 0 || next_tick > period) {
+		next_tick = period;
+	}
+
+	/* finish the current tick on time, then back to normal ticks */
+	SysTick->LOAD = next_tick - 1;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+	uwTick += skipped;
+	SysTick->LOAD = period - 1;
+}
+#endif
+
 
-		if (ticks > buzzer_next_run) {
-			buzzer_Execute ();
-			buzzer_next_run += BUZZER_PERIOD_TICKS;
+/* Sleep until wake_us (scheduler time) or until app_Wake is called */
+static void app_Idle (uint32_t wake_us)
+{
+	__disable_irq ();
+	uint32_t sleep_ticks = app_TicksUntil (wake_us);
+	if (!wake_pending && sleep_ticks > 0) {
+#if APP_TICKLESS_IDLE
+		if (sleep_ticks > 1) {
+			app_SleepTicks (sleep_ticks);
+		} else {
+			__WFI ();
 		}
+#else
+		__WFI ();
+#endif
+	}
+	wake_pending = 0;
+	__enable_irq ();
+}
+
+
+/* Busy cycles over the last DUTY_WINDOW_TICKS, as a permille of the window */
+static void app_UpdateDutyCycle (uint32_t busy_start)
+{
+	busy_cycles += scheduler_CycleStamp () - busy_start;
+
+	uint32_t ticks = HAL_GetTick ();
+	if (ticks - duty_window_start >= DUTY_WINDOW_TICKS) {
+		duty_permille = busy_cycles / (SysTick->LOAD + 1);
+		busy_cycles = 0;
+		duty_window_start = ticks;
 	}
 }
+#endif
+
+
+void app_main (void)
+{
+	timebase_Init ();
+	supervisor_Init ();
+	taskDisplay_Init ();
+	taskButtons_Init ();
+	stateMachine_Init ();
+	stepHistory_Init ();
+	taskLeds_Init ();
+	imu_Init ();
+
+	scheduler_Init (tasks, NUM_TASKS);
+	duty_window_start = HAL_GetTick ();
 
+#if APP_USE_KERNEL
+	sensor_supervision = supervisor_AddThread (IMU_PERIOD_TICKS);
+	kernel_CreateThread (&sensor_thread, "sensor", app_SensorThread,
+			sensor_stack, SENSOR_STACK_WORDS, SENSOR_PRIORITY);
+	kernel_CreateThread (&ui_thread, "ui", app_UiThread,
+			ui_stack, UI_STACK_WORDS, UI_PRIORITY);
+	kernel_CreateThread (&background_thread, "background", app_BackgroundThread,
+			background_stack, BACKGROUND_STACK_WORDS, BACKGROUND_PRIORITY);
+	kernel_Start ();
+#else
+	while (1)
+	{
+		uint32_t busy_start = scheduler_CycleStamp ();
+		scheduler_Dispatch ();
+		app_UpdateDutyCycle (busy_start);
+		app_Idle (scheduler_NearestDeadline ());
+	}
+#endif
+}
\ No newline at end of file
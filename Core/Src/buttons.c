@@ -17,6 +17,8 @@
 #include <stdbool.h>
 
 #include "buttons.h"
+#include "ring_buffer.h"
+#include "timebase.h"
 #include "stm32c0xx_hal.h"
 
 
@@ -24,6 +26,11 @@
 #define JOYSTICK_DEBOUNCE_MS    100
 #define JOYSTICK_MIN_HOLD_MS    1000
 #define NUM_BUT_POLLS 3 // min number of polls up/down/left/right buttons need to be consistent before being read
+#define EVENT_RING_SIZE 8 // button events not yet taken by buttons_EventGetter
+
+#if !RING_BUFFER_IS_POWER_OF_TWO(EVENT_RING_SIZE)
+#error "EVENT_RING_SIZE must be a power of two"
+#endif
 
 // *******************************************************
 // Typedefs
@@ -38,7 +45,6 @@ typedef struct
 	// Runtime properties
 	GPIO_PinState state;
 	uint8_t newStateCount;
-	bool hasChanged;
 } buttonProperties_t;
 
 // *******************************************************
@@ -81,6 +87,9 @@ buttonProperties_t buttons[NUM_BUTTONS] =
 		}
 };
 
+static buttonEvent_t eventStorage[EVENT_RING_SIZE];
+static ring_buffer_t eventRing;
+
 // *******************************************************
 // buttons_init: Initialise the variables associated with the set of buttons.
 void buttons_init (void)
@@ -89,15 +98,15 @@ void buttons_init (void)
 	{
 		buttons[i].state = buttons[i].normalState;
 		buttons[i].newStateCount = 0;
-		buttons[i].hasChanged = false;
 	}
+	ringBuffer_Init (&eventRing, eventStorage, sizeof(buttonEvent_t), EVENT_RING_SIZE);
 }
 
 // *******************************************************
 // buttons_update: Function designed to be called regularly. It polls all
-// buttons once and updates variables associated with the buttons if
-// necessary. It is efficient enough to be part of an ISR for e.g.,
-// a SysTick interrupt.
+// buttons once and queues an event for every confirmed change of state.
+// It is efficient enough to be part of an ISR for e.g., a SysTick
+// interrupt, as long as it is the only caller.
 // Debouncing algorithm: A finite state machine (FSM) is associated with each button.
 // A state change can be declared only after NUM_BUT_POLLS consecutive polls have
 // read the pin in the opposite condition, before the state changes and
@@ -119,8 +128,13 @@ void buttons_update (void)
         	if (buttons[i].newStateCount >= NUM_BUT_POLLS)
         	{
         		buttons[i].state = rawState;
-        		buttons[i].hasChanged = true;	// Reset by call to buttons_checkButton()
         		buttons[i].newStateCount = 0;
+
+        		buttonEvent_t event;
+        		event.button = (buttonName_t) i;
+        		event.state = (rawState == buttons[i].normalState) ? RELEASED : PUSHED;
+        		event.time_us = timebase_MicrosGetter();
+        		ringBuffer_Push (&eventRing, &event);
         	}
         }
         else
@@ -131,31 +145,25 @@ void buttons_update (void)
 }
 
 // *******************************************************
-// buttons_checkButton: Function returns the new button logical state if the button
-// logical state (PUSHED or RELEASED) has changed since the last call,
-// otherwise returns NO_CHANGE.
-buttonState_t buttons_checkButton (buttonName_t butName)
+// buttons_EventGetter: Takes the oldest queued button event. Returns false
+// if there is none.
+bool buttons_EventGetter (buttonEvent_t* event)
 {
-	if (buttons[butName].hasChanged)
-	{
-		buttons[butName].hasChanged = false;
-		if (buttons[butName].state == buttons[butName].normalState)
-			return RELEASED;
-		else
-			return PUSHED;
-	}
-	return NO_CHANGE;
+	return ringBuffer_Pop (&eventRing, event);
 }
 
-/* Detect joystick click that are short or long press events */
+/*
+ * Detect joystick click that are short or long press events
+ * Times are 64-bit, so a hold or a quiet spell longer than the 32-bit wrap (~71.6 min) is not misjudged
+ */
 joystick_event_t buttons_CheckHold(void)
 {
     static bool pressed = false;
-    static uint32_t last_tick = 0;
-    static uint32_t press_tick = 0;
+    static uint64_t last_change_us = 0;
+    static uint64_t press_us = 0;
 
     GPIO_PinState cur = HAL_GPIO_ReadPin(buttons[JOYSTICK_CLICK].port, buttons[JOYSTICK_CLICK].pin);
-    uint32_t now = HAL_GetTick();
+    uint64_t now = timebase_MicrosGetter();
 
     // Debounce: ignore if changed state within JOYSTICK_DEBOUNCE_MS
     GPIO_PinState expected_state;
@@ -164,7 +172,7 @@ joystick_event_t buttons_CheckHold(void)
     } else {
     	expected_state = GPIO_PIN_RESET;
     }
-    if (now - last_tick < JOYSTICK_DEBOUNCE_MS) {
+    if (now - last_change_us < TIMEBASE_MS(JOYSTICK_DEBOUNCE_MS)) {
 
     	if (cur != expected_state) {
     		return JOYSTICK_NONE;
@@ -172,23 +180,23 @@ joystick_event_t buttons_CheckHold(void)
     } // END Debounce
 
     if (cur != HAL_GPIO_ReadPin(buttons[JOYSTICK_CLICK].port, buttons[JOYSTICK_CLICK].pin)) {
-        last_tick = now;
+        last_change_us = now;
     }
 
     switch (pressed) {
       case false:
         // look for click
         if (cur == GPIO_PIN_SET) {
-            press_tick = now;
+            press_us = now;
             pressed = true;;
         }
         break;
 
       case true:
         if (cur == GPIO_PIN_RESET) {
-            uint32_t held = now - press_tick;
+            uint64_t held = now - press_us;
             pressed = false;
-            if (held >= JOYSTICK_MIN_HOLD_MS){
+            if (held >= TIMEBASE_MS(JOYSTICK_MIN_HOLD_MS)){
             	return JOYSTICK_LONG_PRESS;
             } else {
             	return JOYSTICK_SHORT_PRESS;
@@ -199,25 +207,18 @@ joystick_event_t buttons_CheckHold(void)
     return JOYSTICK_NONE;
 }
 
-/* detect double press of DOWN button within time */
-bool buttons_CheckDoublePush(void)
+/* detect double press of DOWN button within time, call with the time of every DOWN push */
+bool buttons_CheckDoublePush(uint64_t push_us)
 {
-    static uint32_t last_push_time = 0;
+    static uint64_t last_push_time = 0;
     static bool sw2_button_pushed_flag = false;
-    uint32_t current_time = HAL_GetTick();
 
-    if (buttons_checkButton(DOWN) == PUSHED) {
-        if (sw2_button_pushed_flag &&
-            (current_time - last_push_time <= MAX_DOUBLE_TAP_TIME_MS)) {
-            sw2_button_pushed_flag = false;
-            return true;
-        }
-        sw2_button_pushed_flag = true;
-        last_push_time = current_time;
-    }
-    else if (sw2_button_pushed_flag &&
-             (current_time - last_push_time > MAX_DOUBLE_TAP_TIME_MS)) {
+    if (sw2_button_pushed_flag &&
+        (push_us - last_push_time <= TIMEBASE_MS(MAX_DOUBLE_TAP_TIME_MS))) {
         sw2_button_pushed_flag = false;
+        return true;
     }
+    sw2_button_pushed_flag = true;
+    last_push_time = push_us;
     return false;
 }
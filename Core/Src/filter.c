@@ -15,9 +15,6 @@
 
 #include <stdint.h>
 
-#define ALPHA_SHIFT 3
-#define VAR_SCALING 23
-
 typedef struct {
 	uint32_t buffer[N_SIZE];
 	uint32_t mean;
@@ -0,0 +1,91 @@
+/*
+ * format.c
+ *
+ * Decimal formatting for the display, in place of snprintf. The M0+ has no
+ * divide instruction, so digits come from a divide by 10 done with shifts
+ * and adds rather than from the library's division routine.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "format.h"
+
+#include <stdint.h>
+
+
+/* n / 10 and n % 10: q is n * 0.8 by shifts and adds, over 8, then corrected by the remainder */
+static uint32_t format_DivU10 (uint32_t n, uint8_t* remainder)
+{
+	uint32_t q = (n >> 1) + (n >> 2);
+	q += q >> 4;
+	q += q >> 8;
+	q += q >> 16;
+	q >>= 3;
+	uint32_t r = n - ((q << 2) + q) * 2;
+	if (r > 9) {
+		q++;
+		r -= 10;
+	}
+	*remainder = r;
+	return q;
+}
+
+
+/* Digits of value, least significant first, zero padded to min_digits; returns how many */
+static uint8_t format_Digits (uint32_t value, uint8_t min_digits, char* digits)
+{
+	uint8_t count = 0;
+	uint8_t digit;
+
+	do {
+		value = format_DivU10 (value, &digit);
+		digits[count++] = '0' + digit;
+	} while (value != 0);
+
+	while (count < min_digits && count < FORMAT_UNSIGNED_DIGITS) {
+		digits[count++] = '0';
+	}
+	return count;
+}
+
+
+char* format_String (char* out, const char* text)
+{
+	while (*text) {
+		*out++ = *text++;
+	}
+	*out = '\0';
+	return out;
+}
+
+
+/* value in decimal, with leading zeros up to min_digits (at most FORMAT_UNSIGNED_DIGITS) */
+char* format_Unsigned (char* out, uint32_t value, uint8_t min_digits)
+{
+	char digits[FORMAT_UNSIGNED_DIGITS];
+	uint8_t count = format_Digits (value, min_digits, digits);
+
+	while (count > 0) {
+		*out++ = digits[--count];
+	}
+	*out = '\0';
+	return out;
+}
+
+
+/* value / 10^decimals with that many decimal places, e.g. 1234 with 2 as "12.34" */
+char* format_Fixed (char* out, uint32_t value, uint8_t decimals)
+{
+	char digits[FORMAT_UNSIGNED_DIGITS];
+	uint8_t count = format_Digits (value, decimals + 1, digits);
+
+	while (count > 0) {
+		if (count == decimals) {
+			*out++ = '.';
+		}
+		*out++ = digits[--count];
+	}
+	*out = '\0';
+	return out;
+}
@@ -0,0 +1,202 @@
+/*
+ * imu_log.c
+ *
+ * Encodes raw IMU samples into the compact columnar log described in
+ * imu_log.h, and decodes its columns.
+ *
+ * Samples are buffered for one block, then each axis is written as a
+ * column of zigzag varint deltas from the previous sample, so a typical
+ * walking sample takes 3-4 bytes instead of 6. No heap, no division,
+ * so it can log on the MCU as well as on the host.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "imu_log.h"
+#include "task_read_imu.h"
+
+#include <string.h>
+
+
+static void imuLog_PutU16 (uint8_t* p, uint16_t value)
+{
+	p[0] = (uint8_t) value;
+	p[1] = (uint8_t) (value >> 8);
+}
+
+
+static void imuLog_PutU32 (uint8_t* p, uint32_t value)
+{
+	imuLog_PutU16 (&p[0], (uint16_t) value);
+	imuLog_PutU16 (&p[2], (uint16_t) (value >> 16));
+}
+
+
+static uint16_t imuLog_GetU16 (const uint8_t* p)
+{
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+
+/* Write the deltas of one axis, returns bytes used */
+static uint16_t imuLog_EncodeColumn (const int16_t* values, uint16_t count, uint8_t* out)
+{
+	uint8_t* start = out;
+
+	for (uint16_t i = 1; i < count; i++) {
+		/* wrap-around difference, always fits 16 bits */
+		uint16_t delta = (uint16_t) values[i] - (uint16_t) values[i - 1];
+		uint16_t zigzag = (uint16_t) ((delta << 1) ^ (uint16_t) -(delta >> 15));
+
+		while (zigzag >= 0x80) {
+			*out++ = (uint8_t) (zigzag | 0x80);
+			zigzag >>= 7;
+		}
+		*out++ = (uint8_t) zigzag;
+	}
+	return (uint16_t) (out - start);
+}
+
+
+/* Start a new log and write its header */
+void imuLog_Init (imu_log_t* log, uint16_t rate_hz, imu_log_write_t write, void* context)
+{
+	uint8_t header[IMU_LOG_HEADER_SIZE];
+
+	log->write = write;
+	log->context = context;
+	log->samples = 0;
+	log->count = 0;
+	log->has_marks = 0;
+	memset (log->marks, 0, sizeof(log->marks));
+
+	memcpy (header, IMU_LOG_MAGIC, 4);
+	imuLog_PutU16 (&header[4], IMU_LOG_VERSION);
+	imuLog_PutU16 (&header[6], rate_hz);
+	imuLog_PutU16 (&header[8], (uint16_t) X_OFFSET);
+	imuLog_PutU16 (&header[10], (uint16_t) Y_OFFSET);
+	imuLog_PutU16 (&header[12], (uint16_t) Z_OFFSET);
+	imuLog_PutU16 (&header[14], IMU_LOG_BLOCK_SAMPLES);
+	log->write (header, sizeof(header), log->context);
+}
+
+
+/* Add one raw sample, mark is a single bit of user data (e.g. a step) */
+void imuLog_Append (imu_log_t* log, int16_t x, int16_t y, int16_t z, uint8_t mark)
+{
+	log->x[log->count] = x;
+	log->y[log->count] = y;
+	log->z[log->count] = z;
+	if (mark) {
+		log->marks[log->count >> 3] |= (uint8_t) (1 << (log->count & 7));
+		log->has_marks = 1;
+	}
+
+	log->count++;
+	if (log->count == IMU_LOG_BLOCK_SAMPLES) {
+		imuLog_Flush (log);
+	}
+}
+
+
+/* Encode and write the current block, even if it is not full */
+void imuLog_Flush (imu_log_t* log)
+{
+	if (log->count == 0) {
+		return;
+	}
+
+	uint8_t* out = &log->block[IMU_LOG_BLOCK_HEADER_SIZE];
+	uint16_t x_bytes = imuLog_EncodeColumn (log->x, log->count, out);
+	out += x_bytes;
+	uint16_t y_bytes = imuLog_EncodeColumn (log->y, log->count, out);
+	out += y_bytes;
+	uint16_t z_bytes = imuLog_EncodeColumn (log->z, log->count, out);
+	out += z_bytes;
+	if (log->has_marks) {
+		uint16_t mark_bytes = (uint16_t) ((log->count + 7) >> 3);
+		memcpy (out, log->marks, mark_bytes);
+		out += mark_bytes;
+	}
+
+	uint8_t* header = log->block;
+	imuLog_PutU16 (&header[0], log->count);
+	imuLog_PutU16 (&header[2], x_bytes);
+	imuLog_PutU16 (&header[4], y_bytes);
+	imuLog_PutU16 (&header[6], z_bytes);
+	imuLog_PutU32 (&header[8], log->samples);
+	imuLog_PutU16 (&header[12], (uint16_t) log->x[0]);
+	imuLog_PutU16 (&header[14], (uint16_t) log->y[0]);
+	imuLog_PutU16 (&header[16], (uint16_t) log->z[0]);
+	header[18] = log->has_marks ? IMU_LOG_FLAG_MARKS : 0;
+	header[19] = 0;
+
+	log->write (log->block, (uint16_t) (out - log->block), log->context);
+
+	log->samples += log->count;
+	log->count = 0;
+	log->has_marks = 0;
+	memset (log->marks, 0, sizeof(log->marks));
+}
+
+
+void imuLog_ParseBlockHeader (const uint8_t* data, imu_log_block_t* block)
+{
+	block->count = imuLog_GetU16 (&data[0]);
+	block->column_bytes[0] = imuLog_GetU16 (&data[2]);
+	block->column_bytes[1] = imuLog_GetU16 (&data[4]);
+	block->column_bytes[2] = imuLog_GetU16 (&data[6]);
+	block->first_sample = (uint32_t) imuLog_GetU16 (&data[8]) | ((uint32_t) imuLog_GetU16 (&data[10]) << 16);
+	block->first[0] = (int16_t) imuLog_GetU16 (&data[12]);
+	block->first[1] = (int16_t) imuLog_GetU16 (&data[14]);
+	block->first[2] = (int16_t) imuLog_GetU16 (&data[16]);
+	block->flags = data[18];
+}
+
+
+/* Total bytes of a block including its header */
+uint32_t imuLog_BlockSize (const imu_log_block_t* block)
+{
+	uint32_t size = IMU_LOG_BLOCK_HEADER_SIZE
+			+ block->column_bytes[0] + block->column_bytes[1] + block->column_bytes[2];
+	if (block->flags & IMU_LOG_FLAG_MARKS) {
+		size += ((uint32_t) block->count + 7) >> 3;
+	}
+	return size;
+}
+
+
+/*
+ * Decode count samples of one column straight into out
+ * Returns the bytes consumed, IMU_LOG_DECODE_ERROR if the column is malformed
+ */
+uint16_t imuLog_DecodeColumn (const uint8_t* data, uint16_t bytes, int16_t first, int16_t* out, uint16_t count)
+{
+	const uint8_t* p = data;
+	const uint8_t* end = data + bytes;
+	uint16_t value = (uint16_t) first;
+
+	if (count == 0) {
+		return 0;
+	}
+	out[0] = first;
+
+	for (uint16_t i = 1; i < count; i++) {
+		uint16_t zigzag = 0;
+		uint8_t shift = 0;
+		uint8_t byte;
+		do {
+			if (p == end || shift > 14) {
+				return IMU_LOG_DECODE_ERROR;
+			}
+			byte = *p++;
+			zigzag |= (uint16_t) ((byte & 0x7F) << shift);
+			shift += 7;
+		} while (byte & 0x80);
+
+		value += (uint16_t) ((zigzag >> 1) ^ (uint16_t) -(zigzag & 1));
+		out[i] = (int16_t) value;
+	}
+	return (uint16_t) (p - data);
+}
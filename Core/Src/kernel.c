@@ -0,0 +1,279 @@
+/*
+ * kernel.c
+ *
+ * Minimal preemptive kernel for the Cortex-M0+: a few fixed-priority
+ * threads on static stacks, switched by PendSV, woken by SysTick, with
+ * priority inheritance mutexes. Only used with APP_USE_KERNEL.
+ *
+ * The most urgent ready thread always runs. The least urgent thread must
+ * never sleep or block, so there is always one to run.
+ *
+ * Switches are requested by pending PendSV, which has the lowest priority,
+ * so a switch happens once every other interrupt has finished. Saving and
+ * restoring the threads is left to the port (kernel_port.h).
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "kernel.h"
+#include "kernel_port.h"
+#include "scheduler.h"
+#include "main.h"
+#include "stm32c0xx_hal.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+static kernel_thread_t* threads[KERNEL_MAX_THREADS];
+static uint8_t thread_count = 0;
+static kernel_thread_t* current = NULL;
+static uint8_t running = 0;
+
+static uint32_t last_switch;		// cycle stamp of the last switch
+static uint32_t pend_stamp;			// cycle stamp of the last PendSV request
+static kernel_switch_stats_t switch_stats;
+
+
+/* A thread that returns from its entry function is parked for good */
+static void kernel_ThreadExit (void)
+{
+	__disable_irq ();
+	current->state = KERNEL_BLOCKED;
+	current->blocked_on = NULL;
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+	__enable_irq ();
+
+	while (1) {
+	}
+}
+
+
+/* Most urgent ready thread, ties go to the first created */
+static kernel_thread_t* kernel_HighestReady (void)
+{
+	kernel_thread_t* best = NULL;
+
+	for (uint8_t i = 0; i < thread_count; i++) {
+		if (threads[i]->state == KERNEL_READY && (best == NULL || threads[i]->priority < best->priority)) {
+			best = threads[i];
+		}
+	}
+	return best;
+}
+
+
+/* Request a switch if a more urgent thread is ready, call with interrupts masked */
+static void kernel_Reschedule (void)
+{
+	if (running && kernel_HighestReady () != current && !(SCB->ICSR & SCB_ICSR_PENDSVSET_Msk)) {
+		pend_stamp = scheduler_CycleStamp ();
+		SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+	}
+}
+
+
+/*
+ * stack_words must hold the thread's deepest call chain plus one exception
+ * frame (8 words) and the saved registers (8 words); interrupt handlers
+ * themselves run on the main stack. More than KERNEL_MAX_THREADS threads
+ * stop in Error_Handler.
+ */
+void kernel_CreateThread (kernel_thread_t* thread, const char* name, kernel_entry_t entry,
+		uint32_t* stack, uint16_t stack_words, uint8_t priority)
+{
+	if (thread_count >= KERNEL_MAX_THREADS) {
+		Error_Handler ();
+	}
+
+	for (uint16_t i = 0; i < stack_words; i++) {
+		stack[i] = KERNEL_STACK_FILL;
+	}
+
+	thread->sp = kernel_PortInitStack (stack, stack_words, entry, kernel_ThreadExit);
+	thread->name = name;
+	thread->stack = stack;
+	thread->stack_words = stack_words;
+	thread->base_priority = priority;
+	thread->priority = priority;
+	thread->state = KERNEL_READY;
+	thread->wake_pending = 0;
+	thread->blocked_on = NULL;
+	thread->run_cycles = 0;
+
+	threads[thread_count++] = thread;
+}
+
+
+/* Move onto the thread stacks and hand over to the most urgent thread, does not return */
+void kernel_Start (void)
+{
+	NVIC_SetPriority (PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1);
+
+	__disable_irq ();
+	kernel_PortStart ();
+
+	last_switch = scheduler_CycleStamp ();
+	running = 1;
+	kernel_Reschedule ();
+	__enable_irq ();
+
+	while (1) {
+	}
+}
+
+
+/* Wake sleepers that are due, from SysTick_Handler */
+void kernel_Tick (void)
+{
+	if (!running) {
+		return;
+	}
+
+	uint32_t primask = __get_PRIMASK ();
+	__disable_irq ();
+
+	uint32_t ticks = HAL_GetTick ();
+	for (uint8_t i = 0; i < thread_count; i++) {
+		if (threads[i]->state == KERNEL_SLEEPING && (int32_t) (ticks - threads[i]->wake_tick) >= 0) {
+			threads[i]->state = KERNEL_READY;
+		}
+	}
+	kernel_Reschedule ();
+
+	__set_PRIMASK (primask);
+}
+
+
+/* Sleep until tick, or return at once if kernel_Wake was called since the last sleep */
+void kernel_SleepUntil (uint32_t tick)
+{
+	__disable_irq ();
+	if (current->wake_pending) {
+		current->wake_pending = 0;
+	} else if ((int32_t) (tick - HAL_GetTick ()) > 0) {
+		current->wake_tick = tick;
+		current->state = KERNEL_SLEEPING;
+		kernel_Reschedule ();
+	}
+	__enable_irq ();	// the switch is taken here
+}
+
+
+/* End a thread's sleep early, safe to call from interrupts */
+void kernel_Wake (kernel_thread_t* thread)
+{
+	uint32_t primask = __get_PRIMASK ();
+	__disable_irq ();
+
+	if (thread->state == KERNEL_SLEEPING) {
+		thread->state = KERNEL_READY;
+		kernel_Reschedule ();
+	} else {
+		thread->wake_pending = 1;
+	}
+
+	__set_PRIMASK (primask);
+}
+
+
+void kernel_MutexInit (kernel_mutex_t* mutex)
+{
+	mutex->owner = NULL;
+}
+
+
+/*
+ * Block until the mutex is free. While a more urgent thread waits, the
+ * owner runs at that thread's priority, so a less urgent thread cannot
+ * hold up the owner and, through it, the waiter.
+ */
+void kernel_MutexLock (kernel_mutex_t* mutex)
+{
+	__disable_irq ();
+	while (mutex->owner != NULL) {
+		if (current->priority < mutex->owner->priority) {
+			mutex->owner->priority = current->priority;
+		}
+		current->state = KERNEL_BLOCKED;
+		current->blocked_on = mutex;
+		kernel_Reschedule ();
+		__enable_irq ();	// the switch is taken here
+		__disable_irq ();
+	}
+	mutex->owner = current;
+	__enable_irq ();
+}
+
+
+/* Release the mutex, drop any inherited priority and let the waiters try again */
+void kernel_MutexUnlock (kernel_mutex_t* mutex)
+{
+	__disable_irq ();
+	mutex->owner = NULL;
+	current->priority = current->base_priority;
+
+	for (uint8_t i = 0; i < thread_count; i++) {
+		if (threads[i]->state == KERNEL_BLOCKED && threads[i]->blocked_on == mutex) {
+			threads[i]->blocked_on = NULL;
+			threads[i]->state = KERNEL_READY;
+		}
+	}
+	kernel_Reschedule ();
+	__enable_irq ();
+}
+
+
+/* High-water mark in words, from the fill pattern left untouched at the bottom */
+uint16_t kernel_StackUsedGetter (const kernel_thread_t* thread)
+{
+	uint16_t unused = 0;
+
+	while (unused < thread->stack_words && thread->stack[unused] == KERNEL_STACK_FILL) {
+		unused++;
+	}
+	return thread->stack_words - unused;
+}
+
+
+uint32_t kernel_RunCyclesGetter (const kernel_thread_t* thread)
+{
+	return thread->run_cycles;
+}
+
+
+void kernel_SwitchStatsGetter (kernel_switch_stats_t* stats)
+{
+	__disable_irq ();
+	*stats = switch_stats;
+	__enable_irq ();
+}
+
+
+/*
+ * Called from the port's PendSV_Handler only: store the outgoing thread's
+ * stack pointer and return the incoming one's. The measured switch time runs
+ * from the PendSV request to here; restoring the registers and the
+ * exception return add a fixed number of cycles on top.
+ */
+uint32_t* kernel_SwitchContext (uint32_t* sp)
+{
+	uint32_t now = scheduler_CycleStamp ();
+
+	if (current != NULL) {
+		current->sp = sp;
+		current->run_cycles += now - last_switch;
+	}
+	last_switch = now;
+
+	uint32_t cycles = now - pend_stamp;
+	switch_stats.count++;
+	switch_stats.last_cycles = cycles;
+	if (cycles > switch_stats.max_cycles) {
+		switch_stats.max_cycles = cycles;
+	}
+
+	current = kernel_HighestReady ();
+	return current->sp;
+}
+
@@ -0,0 +1,82 @@
+/*
+ * kernel_port.c
+ *
+ * Cortex-M0+ port of kernel.c. Threads run on PSP, handlers on MSP.
+ * PendSV has the lowest priority, so a switch happens once every other
+ * interrupt has finished; it saves r4-r11 below the hardware exception
+ * frame on the outgoing stack and restores them from the incoming one.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "kernel_port.h"
+#include "stm32c0xx_hal.h"
+
+#include <stdint.h>
+
+#define XPSR_THUMB			0x01000000
+#define HW_FRAME_WORDS		8	// r0-r3, r12, lr, pc, xPSR, stacked on exception entry
+#define SW_FRAME_WORDS		8	// r4-r11, stacked by PendSV_Handler
+#define BOOT_STACK_WORDS	(HW_FRAME_WORDS + SW_FRAME_WORDS + 8)
+
+
+/* An 8-byte aligned frame at the top of the stack that PendSV_Handler can return into */
+uint32_t* kernel_PortInitStack (uint32_t* stack, uint16_t stack_words, kernel_entry_t entry, kernel_entry_t exit)
+{
+	uint32_t* sp = (uint32_t*) ((uintptr_t) &stack[stack_words] & ~(uintptr_t) 7);
+
+	sp -= HW_FRAME_WORDS + SW_FRAME_WORDS;
+	for (uint8_t i = 0; i < SW_FRAME_WORDS + 5; i++) {
+		sp[i] = 0;	// r4-r11, r0-r3, r12
+	}
+	sp[SW_FRAME_WORDS + 5] = (uint32_t) exit;					// lr
+	sp[SW_FRAME_WORDS + 6] = (uint32_t) entry & ~1UL;			// pc
+	sp[SW_FRAME_WORDS + 7] = XPSR_THUMB;
+	return sp;
+}
+
+
+/* Switch thread mode to PSP, on a stack that only holds the frame PendSV saves on the way out */
+void kernel_PortStart (void)
+{
+	static uint32_t boot_stack[BOOT_STACK_WORDS];
+
+	__set_PSP ((uint32_t) &boot_stack[BOOT_STACK_WORDS]);
+	__set_CONTROL (0x02);
+	__ISB ();
+}
+
+
+/*
+ * Save r4-r11 below the hardware frame on the outgoing PSP, switch, and
+ * restore them from the incoming one. ARMv6-M has no stmdb and can only
+ * ldm/stm r0-r7, hence the shuffling through r4-r7.
+ */
+__attribute__((naked)) void PendSV_Handler (void)
+{
+	__asm volatile (
+		"	mrs		r0, psp					\n"
+		"	subs	r0, #32					\n"
+		"	stmia	r0!, {r4-r7}			\n"
+		"	mov		r4, r8					\n"
+		"	mov		r5, r9					\n"
+		"	mov		r6, r10					\n"
+		"	mov		r7, r11					\n"
+		"	stmia	r0!, {r4-r7}			\n"
+		"	subs	r0, #32					\n"
+		"	bl		kernel_SwitchContext	\n"
+		"	adds	r0, #16					\n"
+		"	ldmia	r0!, {r4-r7}			\n"
+		"	mov		r8, r4					\n"
+		"	mov		r9, r5					\n"
+		"	mov		r10, r6					\n"
+		"	mov		r11, r7					\n"
+		"	msr		psp, r0					\n"
+		"	subs	r0, #32					\n"
+		"	ldmia	r0!, {r4-r7}			\n"
+		"	movs	r0, #2					\n"
+		"	mvns	r0, r0					\n"	// EXC_RETURN 0xFFFFFFFD: thread mode, PSP
+		"	bx		r0						\n"
+	);
+}
@@ -1,7 +1,7 @@
 /*
  * peak_detection.c
  *
- * Increments step count using filtered IMU data
+ * Detects steps in filtered IMU data
  *
  * Created on: May 6, 2025
  * Author: T. Linton, J. Legg
@@ -9,26 +9,45 @@
 
 #include "peak_detection.h"
 #include "filter.h"
-#include "state_machine.h"
 
+/* Tuning defaults, may be overridden at compile time (see Tools/host sweep) */
+#ifndef VAR_THRESHOLD
 #define VAR_THRESHOLD			50000
+#endif
+#ifndef DELTA_MEAN_THRESHOLD
 #define DELTA_MEAN_THRESHOLD	2700
+#endif
+#ifndef COOLDOWN_SAMPLES
 #define COOLDOWN_SAMPLES 	 	30
-#define STEP_COUNT_INCREMENT 	1
+#endif
 #define MIN_SAMPLES				(3*N_SIZE)
 
+#if (MIN_SAMPLES > 255) || (COOLDOWN_SAMPLES > 255)
+#error "samples_taken and samples_since_step are uint8_t, reduce N_SIZE or COOLDOWN_SAMPLES"
+#endif
+
 static uint8_t  samples_taken	  	= 0;
 static uint8_t  samples_since_step 	= COOLDOWN_SAMPLES;
 static uint32_t prev_mag     	  	= 0;
 static uint32_t mean_threshold;
 
 
+/* Reset detector so that mean & variance must settle again */
+void peakDetection_Init (void)
+{
+	samples_taken		= 0;
+	samples_since_step	= COOLDOWN_SAMPLES;
+	prev_mag			= 0;
+}
+
+
 /*
- * Counts a step on the falling edge of peak in magnitude
+ * Detects a step on the falling edge of peak in magnitude
  * Uses variance to limit sensitivity when standing still
  * Waits for COOLDOWN_SAMPLES number of samples before counting a second step
+ * Returns 1 if a step was found on this sample; the caller counts it
  */
-void peakDetection_Execute(void)
+uint8_t peakDetection_Execute(void)
 {
     uint32_t current = filter_MagnitudeCurrentGetter ();
 
@@ -36,27 +55,30 @@ void peakDetection_Execute(void)
     if (samples_taken < MIN_SAMPLES) {
         samples_taken++;
         prev_mag = current;
-        return;
+        return 0;
     }
 
     if (samples_since_step < COOLDOWN_SAMPLES) {
     	samples_since_step++;
     	prev_mag = current;
-    	return;
+    	return 0;
     }
 
     uint32_t variance = filter_MagnitudeScaledVarGetter ();
     uint32_t mean = filter_MagnitudeMeanGetter ();
     mean_threshold = mean + (uint32_t) DELTA_MEAN_THRESHOLD;
 
+    uint8_t step = 0;
+
     /* detect downward crossing of mean+delta */
     if (	prev_mag > mean_threshold						// previous value was above the mean+DELTA
 		&& 	current <= mean									// current value is below mean
         && 	variance > (uint32_t) VAR_THRESHOLD) 			// current value is above variance threshold
     {
-        stateMachine_IncrementStepCount (STEP_COUNT_INCREMENT);
         samples_since_step = 0;
+        step = 1;
     }
 
     prev_mag = current;
+    return step;
 }
@@ -6,7 +6,6 @@
  */
 
 #include <stdbool.h>
-#include <stdio.h>
 
 #include "rgb.h"
 #include "gpio.h"
@@ -79,7 +78,6 @@ void rgb_colour_on(rgb_colour_t colour)
 // turn led off using active high or active low logic
 void rgb_led_off(rgb_led_t led)
 {
-	printf("Turning OFF LED index %d\n", led);
 	GPIO_PinState state = RGB_LEDS[led].active_high ? GPIO_PIN_RESET : GPIO_PIN_SET;
 	HAL_GPIO_WritePin(RGB_LEDS[led].port, RGB_LEDS[led].pin, state);
 }
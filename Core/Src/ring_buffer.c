@@ -0,0 +1,83 @@
+/*
+ * ring_buffer.c
+ *
+ * Single-producer/single-consumer ring buffer for passing data from
+ * interrupt handlers (or DMA callbacks) to tasks without masking interrupts.
+ *
+ * 16-bit loads and stores are single-copy atomic on the M0+, so each side
+ * only has to order its element copy against its own index update.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "ring_buffer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* Same instruction as CMSIS __DMB, and a plain fence for host builds */
+#if defined(__arm__)
+#define RING_BUFFER_BARRIER() __asm volatile ("dmb 0xF" ::: "memory")
+#else
+#define RING_BUFFER_BARRIER() __atomic_thread_fence (__ATOMIC_SEQ_CST)
+#endif
+
+
+/* capacity must be a power of two, up to RING_BUFFER_MAX_CAPACITY */
+void ringBuffer_Init (ring_buffer_t* ring, void* storage, uint16_t element_size, uint16_t capacity)
+{
+	ring->storage = storage;
+	ring->element_size = element_size;
+	ring->mask = capacity - 1;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->dropped = 0;
+}
+
+
+/* Producer side, returns 0 and counts a drop if the ring is full */
+uint8_t ringBuffer_Push (ring_buffer_t* ring, const void* element)
+{
+	uint16_t head = ring->head;
+
+	if ((uint16_t) (head - ring->tail) > ring->mask) {
+		ring->dropped++;
+		return 0;
+	}
+
+	memcpy (&ring->storage[(head & ring->mask) * ring->element_size], element, ring->element_size);
+	RING_BUFFER_BARRIER ();	// element written before it is published
+	ring->head = head + 1;
+	return 1;
+}
+
+
+/* Consumer side, returns 0 if the ring is empty */
+uint8_t ringBuffer_Pop (ring_buffer_t* ring, void* element)
+{
+	uint16_t tail = ring->tail;
+
+	if (tail == ring->head) {
+		return 0;
+	}
+
+	RING_BUFFER_BARRIER ();	// head read before the element it publishes
+	memcpy (element, &ring->storage[(tail & ring->mask) * ring->element_size], ring->element_size);
+	RING_BUFFER_BARRIER ();	// element read before its slot is handed back
+	ring->tail = tail + 1;
+	return 1;
+}
+
+
+/* Elements waiting; may grow under the consumer and shrink under the producer */
+uint16_t ringBuffer_CountGetter (const ring_buffer_t* ring)
+{
+	return (uint16_t) (ring->head - ring->tail);
+}
+
+
+uint16_t ringBuffer_DroppedGetter (const ring_buffer_t* ring)
+{
+	return ring->dropped;
+}
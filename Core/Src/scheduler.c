@@ -0,0 +1,337 @@
+/*
+ * scheduler.c
+ *
+ * Runs the tasks of a const table at their period and phase,
+ * highest priority first when several are due, and keeps per-task
+ * execution statistics timed with SysTick.
+ *
+ * A task that is part way through a longer job (see coroutine.h) calls
+ * scheduler_Resume before returning. It is then called again on every
+ * pass until it returns without doing so, and its period only advances
+ * once it has finished.
+ *
+ * A task whose job was one-off start-up work, such as powering up a
+ * peripheral, calls scheduler_Rephase. When that job finishes its period
+ * starts afresh, and the time it took is not counted as a deadline miss.
+ *
+ * Each run is reported to supervisor.c, and a run that finishes before
+ * its next period begins checks the task in with the watchdog.
+ *
+ * Scheduling runs on the TIM3 microsecond timebase; the table's periods
+ * and phases are in ms. Time comparisons use signed differences, so they
+ * stay correct across the 32-bit microsecond wrap (every ~71.6 min) as
+ * long as no deadline is more than 2^31 us (~35.8 min) away.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "scheduler.h"
+#include "trace.h"
+#include "supervisor.h"
+#include "timebase.h"
+#include "main.h"
+
+#include <stdint.h>
+
+typedef struct {
+	uint32_t next_run;
+	uint32_t run_count;
+	uint32_t last_cycles;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+	uint64_t total_cycles;
+	uint32_t deadline_misses;
+	uint32_t skipped_periods;
+	uint32_t catch_up_runs;
+	uint32_t resume_deadline;	// latest time (us) to call a resuming task again
+	uint8_t resuming;
+	uint8_t rephase;			// the job in progress is start-up work, see scheduler_Rephase
+	uint8_t catching_up;		// missed periods still to run back to back, already counted as one miss
+} task_state_t;
+
+static const scheduler_task_t* task_table;
+static uint8_t task_count = 0;
+static uint8_t run_order[SCHEDULER_MAX_TASKS];	// table indices by priority
+static task_state_t task_states[SCHEDULER_MAX_TASKS];
+
+/* set by the running task */
+static uint32_t run_start;
+static uint8_t resume_requested;
+static uint32_t resume_deadline;
+static uint8_t rephase_requested;
+
+
+/* A task is due once the time has reached its next run, wrap-safe */
+static uint8_t scheduler_IsDue (uint32_t now, uint32_t next_run)
+{
+	return (int32_t) (now - next_run) >= 0;
+}
+
+
+/*
+ * Cycle timestamp from the HAL tick and the SysTick down-counter
+ * Wraps after 2^32 cycles, so only differences are meaningful
+ */
+uint32_t scheduler_CycleStamp (void)
+{
+	uint32_t ticks;
+	uint32_t count;
+
+	do {
+		ticks = HAL_GetTick ();
+		count = SysTick->VAL;
+	} while (ticks != HAL_GetTick ());
+
+	return ticks * (SysTick->LOAD + 1) + (SysTick->LOAD - count);
+}
+
+
+/* Scheduler time in us, see timebase_Micros32Getter */
+uint32_t scheduler_TimeGetter (void)
+{
+	return timebase_Micros32Getter ();
+}
+
+
+/*
+ * The running task has not finished: call it again on the next pass after
+ * any wake-up, and at the latest timeout_us from now (0 = straight away)
+ */
+void scheduler_Resume (uint32_t timeout_us)
+{
+	resume_requested = 1;
+	resume_deadline = timebase_Micros32Getter () + timeout_us;
+}
+
+
+/*
+ * The running task's current job is one-off start-up work: when it
+ * finishes, start the next period from then rather than counting a miss
+ */
+void scheduler_Rephase (void)
+{
+	rephase_requested = 1;
+}
+
+
+/* The running task has used up SCHEDULER_BUDGET_CYCLES and should resume later */
+uint8_t scheduler_BudgetExpired (void)
+{
+	return scheduler_CycleStamp () - run_start > SCHEDULER_BUDGET_CYCLES;
+}
+
+
+void scheduler_ResetStats (void)
+{
+	for (uint8_t i = 0; i < task_count; i++) {
+		task_state_t* state = &task_states[i];
+		state->run_count = 0;
+		state->last_cycles = 0;
+		state->min_cycles = UINT32_MAX;
+		state->max_cycles = 0;
+		state->total_cycles = 0;
+		state->deadline_misses = 0;
+		state->skipped_periods = 0;
+		state->catch_up_runs = 0;
+	}
+}
+
+
+/* Take a task table; one longer than SCHEDULER_MAX_TASKS is a build mistake and stops here */
+void scheduler_Init (const scheduler_task_t* tasks, uint8_t num_tasks)
+{
+	uint32_t start = timebase_Micros32Getter ();
+
+	if (num_tasks > SCHEDULER_MAX_TASKS) {
+		Error_Handler ();
+	}
+
+	task_table = tasks;
+	task_count = num_tasks;
+
+	for (uint8_t i = 0; i < task_count; i++) {
+		task_states[i].next_run = start + TIMEBASE_MS(tasks[i].phase_ms);
+		task_states[i].resuming = 0;
+		task_states[i].rephase = 0;
+		task_states[i].catching_up = 0;
+
+		/* insertion sort by priority, table order breaks ties */
+		uint8_t j = i;
+		while (j > 0 && tasks[run_order[j - 1]].priority > tasks[i].priority) {
+			run_order[j] = run_order[j - 1];
+			j--;
+		}
+		run_order[j] = i;
+	}
+	scheduler_ResetStats ();
+}
+
+
+/*
+ * Move next_run on after a run that finished at now, past the start of
+ * the next period. Only reached on an overrun, so the division is rare.
+ */
+static void scheduler_Overrun (const scheduler_task_t* task, task_state_t* state, uint32_t now)
+{
+	uint32_t period = TIMEBASE_MS(task->period_ms);
+	uint32_t missed = (now - state->next_run) / period;	// periods that started during the run
+
+	switch (task->overrun) {
+		case SCHEDULER_OVERRUN_CATCH_UP:
+			if (missed > SCHEDULER_CATCH_UP_MAX) {
+				state->skipped_periods += missed - SCHEDULER_CATCH_UP_MAX;
+				state->next_run += (missed - SCHEDULER_CATCH_UP_MAX) * period;
+				missed = SCHEDULER_CATCH_UP_MAX;
+			}
+			state->next_run += period;
+			state->catching_up = missed;
+			break;
+
+		case SCHEDULER_OVERRUN_REPHASE:
+			state->skipped_periods += missed;
+			state->next_run = now + period;
+			break;
+
+		case SCHEDULER_OVERRUN_SKIP:
+		default:
+			state->skipped_periods += missed;
+			state->next_run += (missed + 1) * period;
+			break;
+	}
+}
+
+
+static void scheduler_Run (uint8_t index)
+{
+	const scheduler_task_t* task = &task_table[index];
+	task_state_t* state = &task_states[index];
+
+	resume_requested = 0;
+	rephase_requested = 0;
+	supervisor_TaskStart (index);
+	TRACE_TASK_START (index);
+	run_start = scheduler_CycleStamp ();
+	task->execute ();
+	uint32_t cycles = scheduler_CycleStamp () - run_start;
+	TRACE_TASK_STOP (index);
+	supervisor_TaskStop ();
+
+	state->run_count++;
+	state->last_cycles = cycles;
+	state->total_cycles += cycles;
+	if (cycles < state->min_cycles) {
+		state->min_cycles = cycles;
+	}
+	if (cycles > state->max_cycles) {
+		state->max_cycles = cycles;
+	}
+
+	state->resuming = resume_requested;
+	state->rephase |= rephase_requested;
+	if (resume_requested) {
+		state->resume_deadline = resume_deadline;
+		return;
+	}
+
+	uint32_t now = timebase_Micros32Getter ();
+	uint32_t period = TIMEBASE_MS(task->period_ms);
+	if (state->rephase) {
+		/* start-up work is done, the task is periodic from here */
+		state->rephase = 0;
+		state->next_run = now + period;
+		supervisor_CheckIn (index);
+	} else if (state->catching_up) {
+		/* a missed period's run, late by design; the overrun was the miss */
+		state->catching_up--;
+		state->catch_up_runs++;
+		state->next_run += period;
+		supervisor_CheckIn (index);
+	} else if (scheduler_IsDue (now, state->next_run + period)) {
+		/* the next period has already started */
+		state->deadline_misses++;
+		scheduler_Overrun (task, state, now);
+	} else {
+		state->next_run += period;
+		supervisor_CheckIn (index);
+	}
+}
+
+
+/* Run every task that is due or resuming, in priority order */
+void scheduler_Dispatch (void)
+{
+	uint32_t now = timebase_Micros32Getter ();
+
+	for (uint8_t i = 0; i < task_count; i++) {
+		uint8_t index = run_order[i];
+		if (task_states[index].resuming || scheduler_IsDue (now, task_states[index].next_run)) {
+			scheduler_Run (index);
+		}
+	}
+}
+
+
+/* Time (us) by which a task has to be called again */
+static uint32_t scheduler_WakeTime (const task_state_t* state)
+{
+	return state->resuming ? state->resume_deadline : state->next_run;
+}
+
+
+/* Earliest time (us) at which any task becomes due */
+uint32_t scheduler_NearestDeadline (void)
+{
+	uint32_t nearest = scheduler_WakeTime (&task_states[0]);
+
+	for (uint8_t i = 1; i < task_count; i++) {
+		uint32_t wake = scheduler_WakeTime (&task_states[i]);
+		if ((int32_t) (wake - nearest) < 0) {
+			nearest = wake;
+		}
+	}
+	return nearest;
+}
+
+
+uint8_t scheduler_TaskCountGetter (void)
+{
+	return task_count;
+}
+
+
+const scheduler_task_t* scheduler_TaskGetter (uint8_t task)
+{
+	return task < task_count ? &task_table[task] : 0;
+}
+
+
+/* Copy of a task's statistics, safe to call from any task */
+void scheduler_StatsGetter (uint8_t task, scheduler_stats_t* stats)
+{
+	if (task >= task_count) {
+		return;
+	}
+
+	const task_state_t* state = &task_states[task];
+	stats->run_count = state->run_count;
+	stats->last_cycles = state->last_cycles;
+	stats->min_cycles = state->run_count ? state->min_cycles : 0;
+	stats->max_cycles = state->max_cycles;
+	stats->mean_cycles = state->run_count ? (uint32_t) (state->total_cycles / state->run_count) : 0;
+	stats->deadline_misses = state->deadline_misses;
+	stats->skipped_periods = state->skipped_periods;
+	stats->catch_up_runs = state->catch_up_runs;
+}
+
+
+/* Deadline misses of all tasks since the last reset, for diagnostics */
+uint32_t scheduler_DeadlineMissesGetter (void)
+{
+	uint32_t misses = 0;
+
+	for (uint8_t i = 0; i < task_count; i++) {
+		misses += task_states[i].deadline_misses;
+	}
+	return misses;
+}
@@ -1,9 +1,12 @@
 #include "ssd1306.h"
-#include <math.h>
+#include "ring_buffer.h"
+#include "trace.h"
+#include "app.h"
+#include "timebase.h"
 #include <stdlib.h>
 #include <string.h>  // For memcpy
 
-// Screenbuffer
+// Screenbuffer, the back buffer every draw call writes into
 static uint8_t SSD1306_Buffer[SSD1306_BUFFER_SIZE];
 
 // Screen object
@@ -11,53 +14,415 @@ static SSD1306_t SSD1306;
 
 #if defined(SSD1306_USE_I2C)
 
-static uint8_t updateScreenPageIndex = 0;
+#define SSD1306_EVENT_RING_SIZE 4   // flush transfers completed or failed but not yet followed up
+#define SSD1306_EVENT_SENT      1   // a flush's data is on the panel
+#define SSD1306_EVENT_FAILED    0   // a transaction failed and the queue was dropped
+#define SSD1306_PAGES           (SSD1306_HEIGHT/8)
+#define SSD1306_X_OFFSET_COLUMN ((SSD1306_X_OFFSET_UPPER << 4) | SSD1306_X_OFFSET_LOWER)
+
+/*
+ * Front buffer: the frame the panel shows or is being sent. Only a flush
+ * writes it, and only while no transfer is in flight, so DMA never reads
+ * a frame that is half drawn and drawing never waits for the bus.
+ */
+static uint8_t SSD1306_Front[SSD1306_BUFFER_SIZE];
+static uint8_t frontValid = 0;   // 0 until the whole panel has been written, e.g. after power-up
+
+// A rectangle narrower than the screen is packed here, row after row, for its DMA transfer
+static uint8_t SSD1306_Window[SSD1306_BUFFER_SIZE];
+
+static uint8_t updateScreenBusy = 0;      // a flush's data is queued or in flight; only touched outside interrupts
+static uint8_t updateScreenPending = 0;   // a flush was asked for while busy, or has to be sent again
+static uint8_t failuresInARow = 0;        // failed transactions since a flush last got through
+static uint16_t transferFailures = 0;
+static uint8_t eventStorage[SSD1306_EVENT_RING_SIZE];
+static ring_buffer_t eventRing = RING_BUFFER_INIT(eventStorage, SSD1306_EVENT_RING_SIZE);
+
+/*
+ * Transmit queue. Commands and frame data go out in the order they were
+ * queued, each entry as one DMA transaction: a control byte of 0x00 (every
+ * byte after it a command) or 0x40 (display data). Consecutive commands
+ * join the last entry while it has not started, so a run of them is one
+ * transaction. The completion interrupt starts the next entry, so nothing
+ * waits for the bus. Entries are added outside interrupts with interrupts
+ * masked and taken off by the completion interrupt.
+ *
+ * A transaction that HAL refuses to start, that ends in a bus error, or
+ * that is still on the bus after SSD1306_TRANSFER_TIMEOUT_MS drops the
+ * whole queue; ssd1306_ProcessEvents then sends the whole frame again.
+ * Commands dropped with it are not sent again.
+ */
+#define SSD1306_CONTROL_COMMANDS 0x00
+#define SSD1306_CONTROL_DATA     0x40
+
+typedef struct {
+    uint8_t control;
+    uint16_t length;
+    uint16_t release;   // command bytes freed when done, including any skipped at the end of commandBytes
+    uint8_t* data;
+} ssd1306_transaction_t;
+
+static ssd1306_transaction_t queue[SSD1306_QUEUE_SIZE];
+static volatile uint8_t queueHead = 0;    // next free entry, counts freely
+static volatile uint8_t queueTail = 0;    // entry on the bus or next to start
+static volatile uint8_t queueBusy = 0;    // queue[queueTail] is on the bus
+static volatile uint32_t transferStart;   // time (us) queue[queueTail] went on the bus
+
+// Queued command bytes; every entry's bytes are contiguous
+static uint8_t commandBytes[SSD1306_COMMAND_BYTES];
+static uint16_t commandHead = 0;          // next free byte, counts freely
+static volatile uint16_t commandTail = 0; // oldest byte not yet sent
+static uint16_t commandsDropped = 0;
+
+#define SSD1306_QUEUE_ENTRY(INDEX) (&queue[(uint8_t) (INDEX) & (SSD1306_QUEUE_SIZE - 1)])
+#define SSD1306_QUEUE_FULL()       ((uint8_t) (queueHead - queueTail) >= SSD1306_QUEUE_SIZE)
+
+/*
+ * Drop every queued transaction after the one on the bus failed, and pass
+ * the failure on to ssd1306_ProcessEvents. In an interrupt or with interrupts masked.
+ */
+static void ssd1306_Abort(void) {
+    uint8_t failed = SSD1306_EVENT_FAILED;
+
+    if (SSD1306_QUEUE_ENTRY(queueTail)->control == SSD1306_CONTROL_DATA) {
+        TRACE_DMA_COMPLETE(TRACE_DMA_DISPLAY);
+    }
+    queueTail = queueHead;
+    commandTail = commandHead;
+    queueBusy = 0;
+    ringBuffer_Push(&eventRing, &failed);
+    app_Wake();
+}
+
+/*
+ * Put the entry at the tail on the bus, if there is one. The bus must be idle.
+ * Returns SSD1306_ERR if HAL refused it and the queue was dropped.
+ */
+static SSD1306_Error_t ssd1306_StartNext(void) {
+    if (queueTail == queueHead) {
+        queueBusy = 0;
+        return SSD1306_OK;
+    }
+    ssd1306_transaction_t* entry = SSD1306_QUEUE_ENTRY(queueTail);
+    queueBusy = 1;
+    transferStart = timebase_Micros32Getter();
+    if (entry->control == SSD1306_CONTROL_DATA) {
+        TRACE_DMA_START(TRACE_DMA_DISPLAY, entry->length);
+    }
+    if (HAL_I2C_Mem_Write_DMA(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, entry->control, 1, entry->data, entry->length) != HAL_OK) {
+        ssd1306_Abort();
+        return SSD1306_ERR;
+    }
+    return SSD1306_OK;
+}
+
+/*
+ * Add an entry and start it if the bus is idle. Interrupts must be masked.
+ * Returns SSD1306_ERR if the queue is full, or if the bus refused the entry
+ * and it was dropped with the rest of the queue.
+ */
+static SSD1306_Error_t ssd1306_Queue(uint8_t control, uint8_t* data, uint16_t length, uint16_t release) {
+    if (SSD1306_QUEUE_FULL()) {
+        return SSD1306_ERR;
+    }
+    ssd1306_transaction_t* entry = SSD1306_QUEUE_ENTRY(queueHead);
+    entry->control = control;
+    entry->data = data;
+    entry->length = length;
+    entry->release = release;
+    queueHead++;
+    if (!queueBusy) {
+        return ssd1306_StartNext();
+    }
+    return SSD1306_OK;
+}
 
 void ssd1306_Reset(void) {
     /* for I2C - do nothing */
 }
 
+/*
+ * Queue command bytes. They join the last queued transaction if that is
+ * commands and has not started. Returns SSD1306_ERR, dropping them, if
+ * the queue is full or the bus refused them.
+ */
+SSD1306_Error_t ssd1306_WriteCommands(const uint8_t* bytes, uint16_t count) {
+    SSD1306_Error_t result = SSD1306_OK;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    uint16_t offset = commandHead % SSD1306_COMMAND_BYTES;
+    uint16_t skip = (offset + count > SSD1306_COMMAND_BYTES) ? SSD1306_COMMAND_BYTES - offset : 0;
+    ssd1306_transaction_t* last = SSD1306_QUEUE_ENTRY(queueHead - 1);
+    // only bytes that follow on from the last entry's join it, not ones wrapped to the start of commandBytes
+    uint8_t join = queueHead != queueTail && last->control == SSD1306_CONTROL_COMMANDS
+            && last->data + last->length == &commandBytes[(offset + skip) % SSD1306_COMMAND_BYTES]
+            && !(queueBusy && (uint8_t) (queueHead - 1) == queueTail);
+
+    if ((uint16_t) (commandHead - commandTail) + skip + count > SSD1306_COMMAND_BYTES
+            || (!join && SSD1306_QUEUE_FULL())) {
+        result = SSD1306_ERR;
+    } else {
+        // the bytes are in place before the DMA may start on them
+        offset = (offset + skip) % SSD1306_COMMAND_BYTES;
+        memcpy(&commandBytes[offset], bytes, count);
+        commandHead += skip + count;
+        if (join) {
+            last->length += count;
+            last->release += count;
+        } else {
+            // bytes the bus refused were released with the rest of the queue
+            result = ssd1306_Queue(SSD1306_CONTROL_COMMANDS, &commandBytes[offset], count, skip + count);
+        }
+    }
+
+    if (result != SSD1306_OK) {
+        commandsDropped++;
+    }
+
+    __set_PRIMASK(primask);
+    return result;
+}
+
 // Send a byte to the command register
 void ssd1306_WriteCommand(uint8_t byte) {
-    HAL_I2C_Mem_Write(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x00, 1, &byte, 1, HAL_MAX_DELAY);
+    ssd1306_WriteCommands(&byte, 1);
 }
 
-// Send data
-void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
-	HAL_I2C_Mem_Write_DMA(&SSD1306_I2C_PORT, SSD1306_I2C_ADDR, 0x40, 1, buffer, buff_size);
+// Queue data; the buffer must be left alone until the transfer completes
+SSD1306_Error_t ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    SSD1306_Error_t result = ssd1306_Queue(SSD1306_CONTROL_DATA, buffer, buff_size, 0);
+    __set_PRIMASK(primask);
+    return result;
 }
 
-void ssd1306_UpdatePage(uint8_t pageIndex) {
-	ssd1306_WriteCommand(0xB0 + pageIndex); // Set the current RAM page address.
-	ssd1306_WriteCommand(0x00 + SSD1306_X_OFFSET_LOWER);
-	ssd1306_WriteCommand(0x10 + SSD1306_X_OFFSET_UPPER);
-	ssd1306_WriteData(&SSD1306_Buffer[SSD1306_WIDTH*pageIndex],SSD1306_WIDTH);
+#if SSD1306_FLUSH_DIFF
+/*
+ * Columns first..last of the page that differ between back and front buffer,
+ * or 0 if none do. Scans in from both ends, so an unchanged page costs one pass.
+ */
+static uint8_t ssd1306_DirtyColumns(uint8_t pageIndex, uint8_t* first, uint8_t* last) {
+    const uint8_t* back = &SSD1306_Buffer[SSD1306_WIDTH*pageIndex];
+    const uint8_t* front = &SSD1306_Front[SSD1306_WIDTH*pageIndex];
+
+    uint8_t start = 0;
+    while (start < SSD1306_WIDTH && back[start] == front[start]) {
+        start++;
+    }
+    if (start == SSD1306_WIDTH) {
+        return 0;
+    }
+
+    uint8_t end = SSD1306_WIDTH - 1;
+    while (back[end] == front[end]) {
+        end--;
+    }
+    *first = start;
+    *last = end;
+    return 1;
 }
+#endif
 
-/* Write the screenbuffer with changed to the screen */
+/*
+ * Copy columns first..last of pages firstPage..lastPage to the front buffer
+ * and queue them as one DMA transfer, after the commands setting the column
+ * and page address window; horizontal addressing (selected by the init
+ * sequence) then fills it row by row. The full width is sent
+ * straight from the front buffer, a narrower window is packed first.
+ * The data is not queued if the window could not be.
+ */
+static SSD1306_Error_t ssd1306_UpdateWindow(uint8_t firstPage, uint8_t lastPage, uint8_t first, uint8_t last) {
+    uint8_t window[] = {
+        0x21, SSD1306_X_OFFSET_COLUMN + first, SSD1306_X_OFFSET_COLUMN + last,  // Set column address window
+        0x22, firstPage, lastPage,                                              // Set page address window
+    };
+    uint8_t width = last - first + 1;
+    uint16_t length = 0;
+    uint8_t* data;
+
+    for (uint8_t page = firstPage; page <= lastPage; page++) {
+        uint16_t offset = SSD1306_WIDTH*page + first;
+        memcpy(&SSD1306_Front[offset], &SSD1306_Buffer[offset], width);
+        if (width < SSD1306_WIDTH) {
+            memcpy(&SSD1306_Window[length], &SSD1306_Front[offset], width);
+        }
+        length += width;
+    }
+    data = (width < SSD1306_WIDTH) ? SSD1306_Window : &SSD1306_Front[SSD1306_WIDTH*firstPage];
+
+    if (ssd1306_WriteCommands(window, sizeof(window)) != SSD1306_OK) {
+        return SSD1306_ERR;
+    }
+    return ssd1306_WriteData(data, length);
+}
+
+/*
+ * Swap the back buffer to the front and start sending it: with SSD1306_FLUSH_DIFF
+ * only the smallest rectangle holding every difference between the two, otherwise
+ * the whole frame. A flush that cannot be queued is sent whole by a later one.
+ */
+static void ssd1306_Flush(void) {
+	uint8_t firstPage = 0;
+	uint8_t lastPage = SSD1306_PAGES - 1;
+	uint8_t first = 0;
+	uint8_t last = SSD1306_WIDTH - 1;
+
+	updateScreenPending = 0;
+#if SSD1306_FLUSH_DIFF
+	if (frontValid) {
+		firstPage = SSD1306_PAGES;
+		lastPage = 0;
+		first = SSD1306_WIDTH - 1;
+		last = 0;
+		for (uint8_t page = 0; page < SSD1306_PAGES; page++) {
+			uint8_t pageFirst;
+			uint8_t pageLast;
+			if (ssd1306_DirtyColumns(page, &pageFirst, &pageLast)) {
+				if (firstPage == SSD1306_PAGES) {
+					firstPage = page;
+				}
+				lastPage = page;
+				first = (pageFirst < first) ? pageFirst : first;
+				last = (pageLast > last) ? pageLast : last;
+			}
+		}
+		if (firstPage == SSD1306_PAGES) {
+			return;
+		}
+	}
+#endif
+	frontValid = 1;
+	updateScreenBusy = 1;
+	if (ssd1306_UpdateWindow(firstPage, lastPage, first, last) != SSD1306_OK) {
+		// the front buffer no longer matches the panel
+		frontValid = 0;
+		updateScreenBusy = 0;
+		updateScreenPending = 1;
+	}
+}
+
+/*
+ * Send the back buffer to the screen. If a transfer is still in flight the
+ * flush is held until ssd1306_ProcessEvents sees it complete, and then sends
+ * the back buffer as it is at that point. Drawing can go on meanwhile.
+ */
 void ssd1306_UpdateScreen(void) {
-    // Write data to first page of RAM. Subsequent pages will be triggered
-	// automatically via interrupt callback when each page is completed.
-	// Number of pages depends on the screen height:
-    //
-    //  * 32px   ==  4 pages
-    //  * 64px   ==  8 pages
-    //  * 128px  ==  16 pages
+	if (updateScreenBusy) {
+		updateScreenPending = 1;
+	} else {
+		ssd1306_Flush();
+	}
+}
+
+/* Send the whole screenbuffer on the next flush, e.g. after the panel lost its contents */
+void ssd1306_InvalidateScreen(void) {
+	frontValid = 0;
+}
+
+/*
+ * Pick up completed and failed transfers, give up on one stuck past its
+ * timeout, and start a flush held back by one. After SSD1306_MAX_FAILURES
+ * failures in a row flushes are held for good (ssd1306_GaveUpGetter), so
+ * nobody should wait on them any more.
+ */
+static void ssd1306_HandleEvents(void) {
+	uint8_t event;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if (queueBusy && timebase_Micros32Getter() - transferStart > TIMEBASE_MS(SSD1306_TRANSFER_TIMEOUT_MS)) {
+		// resetting the peripheral stops the DMA; the filters come back as MX_I2C1_Init sets them
+		HAL_I2C_DeInit(&SSD1306_I2C_PORT);
+		HAL_I2C_Init(&SSD1306_I2C_PORT);
+		ssd1306_Abort();
+	}
+	__set_PRIMASK(primask);
+
+	while (ringBuffer_Pop(&eventRing, &event)) {
+		updateScreenBusy = 0;
+		if (event == SSD1306_EVENT_FAILED) {
+			// the panel holds part of a frame at most, so send the whole back buffer again
+			transferFailures++;
+			failuresInARow++;
+			frontValid = 0;
+			updateScreenPending = 1;
+		} else {
+			failuresInARow = 0;
+		}
+	}
+	if (!updateScreenBusy && updateScreenPending && failuresInARow < SSD1306_MAX_FAILURES) {
+		ssd1306_Flush();
+	}
+}
+
+/*
+ * Pick up completed transfers and start a flush held back by one. Call between
+ * frames, not part way through drawing one. Returns 1 once everything asked
+ * for has been sent.
+ */
+uint8_t ssd1306_ProcessEvents(void) {
+	ssd1306_HandleEvents();
+	return !updateScreenBusy && !updateScreenPending;
+}
+
+/*
+ * As ssd1306_ProcessEvents, but returns 1 once the last flush asked for has
+ * gone on the bus, so a frame can be drawn while the one before is sent
+ */
+uint8_t ssd1306_FlushStarted(void) {
+	ssd1306_HandleEvents();
+	return !updateScreenPending;
+}
+
+/* Command bytes dropped because the queue was full or the bus failed, to size SSD1306_COMMAND_BYTES and SSD1306_QUEUE_SIZE */
+uint16_t ssd1306_CommandsDroppedGetter(void) {
+	return commandsDropped;
+}
 
-	updateScreenPageIndex = 0;
-	ssd1306_UpdatePage(updateScreenPageIndex);
+/* Transactions that failed, each dropping the queue: bus errors, refused starts and timeouts */
+uint16_t ssd1306_TransferFailuresGetter(void) {
+	return transferFailures;
 }
 
-/* Gets called by HAL when the entire buffer (i.e. one page) is transmitted through DMA */
+/* 1 once SSD1306_MAX_FAILURES transactions in a row failed and flushes stopped for good */
+uint8_t ssd1306_GaveUpGetter(void) {
+    return failuresInARow >= SSD1306_MAX_FAILURES;
+}
+
+/*
+ * Gets called by HAL when a queued transaction has been transmitted through DMA.
+ * Starts the next one; a flush's data completing is passed on to
+ * ssd1306_ProcessEvents outside the interrupt.
+ */
 void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
 {
-	if (hi2c == &SSD1306_I2C_PORT)
+	if (hi2c == &SSD1306_I2C_PORT && queueBusy)
 	{
-		updateScreenPageIndex++;
-		if (updateScreenPageIndex < SSD1306_HEIGHT/8)
-		{
-			ssd1306_UpdatePage(updateScreenPageIndex);
+		ssd1306_transaction_t* entry = SSD1306_QUEUE_ENTRY(queueTail);
+		if (entry->control == SSD1306_CONTROL_DATA) {
+			uint8_t done = 1;
+			TRACE_DMA_COMPLETE(TRACE_DMA_DISPLAY);
+			ringBuffer_Push(&eventRing, &done);
+			app_Wake();
+		} else {
+			commandTail += entry->release;
 		}
+		queueTail++;
+		ssd1306_StartNext();
+	}
+}
+
+/*
+ * Gets called by HAL when a transaction ends in a bus error, e.g. no
+ * acknowledge; HAL has already stopped the DMA
+ */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	if (hi2c == &SSD1306_I2C_PORT && queueBusy)
+	{
+		ssd1306_Abort();
 	}
 }
 
@@ -83,11 +448,34 @@ void ssd1306_WriteCommand(uint8_t byte) {
 }
 
 // Send data
-void ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
+SSD1306_Error_t ssd1306_WriteData(uint8_t* buffer, size_t buff_size) {
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_RESET); // select OLED
     HAL_GPIO_WritePin(SSD1306_DC_Port, SSD1306_DC_Pin, GPIO_PIN_SET); // data
     HAL_SPI_Transmit(&SSD1306_SPI_PORT, buffer, buff_size, HAL_MAX_DELAY);
     HAL_GPIO_WritePin(SSD1306_CS_Port, SSD1306_CS_Pin, GPIO_PIN_SET); // un-select OLED
+    return SSD1306_OK;
+}
+
+// Send command bytes one at a time
+SSD1306_Error_t ssd1306_WriteCommands(const uint8_t* bytes, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        ssd1306_WriteCommand(bytes[i]);
+    }
+    return SSD1306_OK;
+}
+
+/* SPI sends every command as it is written */
+uint16_t ssd1306_CommandsDroppedGetter(void) {
+    return 0;
+}
+
+/* SPI transfers are blocking and not checked */
+uint16_t ssd1306_TransferFailuresGetter(void) {
+    return 0;
+}
+
+uint8_t ssd1306_GaveUpGetter(void) {
+    return 0;
 }
 
 /* Write the screenbuffer with changed to the screen */
@@ -106,6 +494,19 @@ void ssd1306_UpdateScreen(void) {
     }
 }
 
+/* SPI always sends the whole screenbuffer */
+void ssd1306_InvalidateScreen(void) {
+}
+
+/* SPI transfers are blocking, nothing is left to follow up */
+uint8_t ssd1306_ProcessEvents(void) {
+    return 1;
+}
+
+uint8_t ssd1306_FlushStarted(void) {
+    return 1;
+}
+
 #else
 #error "You should define SSD1306_USE_SPI or SSD1306_USE_I2C macro"
 #endif
@@ -121,99 +522,111 @@ SSD1306_Error_t ssd1306_FillBuffer(uint8_t* buf, uint32_t len) {
     return ret;
 }
 
-/* Initialize the oled screen */
-void ssd1306_Init(void) {
-    // Reset OLED
-    ssd1306_Reset();
-
-    // Wait for the screen to boot
-    HAL_Delay(100);
-
-    // Init OLED
-    ssd1306_SetDisplayOn(0); //display off
+/* Power-up command sequence, sent after the screen has booted */
+static const uint8_t ssd1306_InitCommands[] = {
+    0xAE, //display off
 
-    ssd1306_WriteCommand(0x20); //Set Memory Addressing Mode
-    ssd1306_WriteCommand(0x00); // 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
-                                // 10b,Page Addressing Mode (RESET); 11b,Invalid
+    0x20, //Set Memory Addressing Mode
+    0x00, // 00b,Horizontal Addressing Mode; 01b,Vertical Addressing Mode;
+          // 10b,Page Addressing Mode (RESET); 11b,Invalid
 
-    ssd1306_WriteCommand(0xB0); //Set Page Start Address for Page Addressing Mode,0-7
+    0xB0, //Set Page Start Address for Page Addressing Mode,0-7
 
 #ifdef SSD1306_MIRROR_VERT
-    ssd1306_WriteCommand(0xC0); // Mirror vertically
+    0xC0, // Mirror vertically
 #else
-    ssd1306_WriteCommand(0xC8); //Set COM Output Scan Direction
+    0xC8, //Set COM Output Scan Direction
 #endif
 
-    ssd1306_WriteCommand(0x00); //---set low column address
-    ssd1306_WriteCommand(0x10); //---set high column address
+    0x00, //---set low column address
+    0x10, //---set high column address
 
-    ssd1306_WriteCommand(0x40); //--set start line address - CHECK
+    0x40, //--set start line address - CHECK
 
-    ssd1306_SetContrast(0xFF);
+    0x81, //--set contrast control register
+    0xFF,
 
 #ifdef SSD1306_MIRROR_HORIZ
-    ssd1306_WriteCommand(0xA0); // Mirror horizontally
+    0xA0, // Mirror horizontally
 #else
-    ssd1306_WriteCommand(0xA1); //--set segment re-map 0 to 127 - CHECK
+    0xA1, //--set segment re-map 0 to 127 - CHECK
 #endif
 
 #ifdef SSD1306_INVERSE_COLOR
-    ssd1306_WriteCommand(0xA7); //--set inverse color
+    0xA7, //--set inverse color
 #else
-    ssd1306_WriteCommand(0xA6); //--set normal color
+    0xA6, //--set normal color
 #endif
 
 // Set multiplex ratio.
 #if (SSD1306_HEIGHT == 128)
     // Found in the Luma Python lib for SH1106.
-    ssd1306_WriteCommand(0xFF);
+    0xFF,
 #else
-    ssd1306_WriteCommand(0xA8); //--set multiplex ratio(1 to 64) - CHECK
+    0xA8, //--set multiplex ratio(1 to 64) - CHECK
 #endif
 
 #if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x1F); //
+    0x1F, //
 #elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x3F); //
+    0x3F, //
 #elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x3F); // Seems to work for 128px high displays too.
+    0x3F, // Seems to work for 128px high displays too.
 #else
 #error "Only 32, 64, or 128 lines of height are supported!"
 #endif
 
-    ssd1306_WriteCommand(0xA4); //0xa4,Output follows RAM content;0xa5,Output ignores RAM content
+    0xA4, //0xa4,Output follows RAM content;0xa5,Output ignores RAM content
 
-    ssd1306_WriteCommand(0xD3); //-set display offset - CHECK
-    ssd1306_WriteCommand(0x00); //-not offset
+    0xD3, //-set display offset - CHECK
+    0x00, //-not offset
 
-    ssd1306_WriteCommand(0xD5); //--set display clock divide ratio/oscillator frequency
-    ssd1306_WriteCommand(0xF0); //--set divide ratio
+    0xD5, //--set display clock divide ratio/oscillator frequency
+    0xF0, //--set divide ratio
 
-    ssd1306_WriteCommand(0xD9); //--set pre-charge period
-    ssd1306_WriteCommand(0x22); //
+    0xD9, //--set pre-charge period
+    0x22, //
 
-    ssd1306_WriteCommand(0xDA); //--set com pins hardware configuration - CHECK
+    0xDA, //--set com pins hardware configuration - CHECK
 #if (SSD1306_HEIGHT == 32)
-    ssd1306_WriteCommand(0x02);
+    0x02,
 #elif (SSD1306_HEIGHT == 64)
-    ssd1306_WriteCommand(0x12);
+    0x12,
 #elif (SSD1306_HEIGHT == 128)
-    ssd1306_WriteCommand(0x12);
+    0x12,
 #else
 #error "Only 32, 64, or 128 lines of height are supported!"
 #endif
 
-    ssd1306_WriteCommand(0xDB); //--set vcomh
-    ssd1306_WriteCommand(0x20); //0x20,0.77xVcc
+    0xDB, //--set vcomh
+    0x20, //0x20,0.77xVcc
 
-    ssd1306_WriteCommand(0x8D); //--set DC-DC enable
-    ssd1306_WriteCommand(0x14); //
-    ssd1306_SetDisplayOn(1); //--turn on SSD1306 panel
+    0x8D, //--set DC-DC enable
+    0x14, //
+    0xAF, //--turn on SSD1306 panel
+};
+
+/*
+ * Send command number index of the power-up sequence. Returns 0 once past the end.
+ * Lets a caller spread the sequence over several runs instead of blocking for all of it.
+ */
+uint8_t ssd1306_WriteInitCommand(uint8_t index) {
+    if (index >= sizeof(ssd1306_InitCommands)) {
+        return 0;
+    }
+    ssd1306_WriteCommand(ssd1306_InitCommands[index]);
+    return 1;
+}
+
+/* Clear the screen once the power-up sequence has been sent */
+void ssd1306_InitFinish(void) {
+    SSD1306.DisplayOn = 1;
 
     // Clear screen
     ssd1306_Fill(Black);
     
-    // Flush buffer to screen
+    // Flush the whole buffer to screen, the panel RAM is undefined after power-up
+    ssd1306_InvalidateScreen();
     ssd1306_UpdateScreen();
     
     // Set default values for screen object
@@ -223,6 +636,22 @@ void ssd1306_Init(void) {
     SSD1306.Initialized = 1;
 }
 
+/* Initialize the oled screen, blocking */
+void ssd1306_Init(void) {
+    // Reset OLED
+    ssd1306_Reset();
+
+    // Wait for the screen to boot
+    HAL_Delay(SSD1306_BOOT_TIME_MS);
+
+    // Init OLED
+    for (uint8_t i = 0; ssd1306_WriteInitCommand(i); i++) {
+    }
+    ssd1306_InitFinish();
+    while (!ssd1306_ProcessEvents()) {
+    }
+}
+
 /* Fill the whole screen with the given color */
 void ssd1306_Fill(SSD1306_COLOR color) {
     memset(SSD1306_Buffer, (color == Black) ? 0x00 : 0xFF, sizeof(SSD1306_Buffer));
@@ -248,6 +677,67 @@ void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
     }
 }
 
+/*
+ * Write one column of a character cell, bit 0 its top row, into the
+ * screenbuffer from out downwards, starting shift rows into that page.
+ * Rows outside the cell are kept.
+ */
+static void ssd1306_BlitColumn(uint8_t* out, uint32_t bits, uint8_t height, uint8_t shift) {
+    uint32_t cell = (height < 32) ? (1UL << height) - 1 : 0xFFFFFFFFUL;
+
+    if(shift == 0) {
+        // Page-aligned: every page but the last is one whole byte
+        uint8_t left = height;
+        for(; left >= 8; left -= 8, bits >>= 8, out += SSD1306_WIDTH) {
+            *out = (uint8_t) bits;
+        }
+        if(left) {
+            uint8_t keep = 0xFF << left;
+            *out = (*out & keep) | ((uint8_t) bits & ~keep);
+        }
+    } else {
+        // Row of the cell at the top of each page, negative for the first
+        for(int8_t row = -shift; row < height; row += 8, out += SSD1306_WIDTH) {
+            uint8_t page_bits = (row < 0) ? bits << -row : bits >> row;
+            uint8_t page_mask = (row < 0) ? cell << -row : cell >> row;
+            *out = (*out & ~page_mask) | (page_bits & page_mask);
+        }
+    }
+}
+
+#if SSD1306_BLIT_TEXT
+/*
+ * Draw a glyph a column at a time. The fonts store each row left-aligned
+ * in 16 bits; the glyph is turned into columns with bit 0 the top row,
+ * which match the page bytes of the screenbuffer shifted by CurrentY % 8.
+ * The whole character cell is written, background included, as by
+ * per-pixel drawing.
+ */
+static void ssd1306_BlitGlyph(const uint16_t* rows, SSD1306_Font_t Font, SSD1306_COLOR color) {
+    uint32_t columns[16];
+    uint32_t cell = (Font.height < 32) ? (1UL << Font.height) - 1 : 0xFFFFFFFFUL;
+    uint16_t width_mask = 0xFFFF << (16 - Font.width);
+    uint8_t* top = &SSD1306_Buffer[SSD1306.CurrentX + (SSD1306.CurrentY / 8) * SSD1306_WIDTH];
+    uint8_t i, j;
+
+    for(j = 0; j < Font.width; j++) {
+        columns[j] = (color == White) ? 0 : cell;
+    }
+    for(i = 0; i < Font.height; i++) {
+        uint16_t row = rows[i] & width_mask;
+        for(j = 0; row != 0; j++, row <<= 1) {
+            if(row & 0x8000) {
+                columns[j] ^= 1UL << i;
+            }
+        }
+    }
+
+    for(j = 0; j < Font.width; j++) {
+        ssd1306_BlitColumn(top + j, columns[j], Font.height, SSD1306.CurrentY % 8);
+    }
+}
+#endif
+
 /*
  * Draw 1 char to the screen buffer
  * ch       => char om weg te schrijven
@@ -255,7 +745,9 @@ void ssd1306_DrawPixel(uint8_t x, uint8_t y, SSD1306_COLOR color) {
  * color    => Black or White
  */
 char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color) {
+#if !SSD1306_BLIT_TEXT
     uint32_t i, b, j;
+#endif
     
     // Check if character is valid
     if (ch < 32 || ch > 126)
@@ -269,6 +761,9 @@ char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color) {
         return 0;
     }
     
+#if SSD1306_BLIT_TEXT
+    ssd1306_BlitGlyph(&Font.data[(ch - 32) * Font.height], Font, color);
+#else
     // Use the font to write
     for(i = 0; i < Font.height; i++) {
         b = Font.data[(ch - 32) * Font.height + i];
@@ -280,6 +775,7 @@ char ssd1306_WriteChar(char ch, SSD1306_Font_t Font, SSD1306_COLOR color) {
             }
         }
     }
+#endif
     
     // The current space is now taken
     SSD1306.CurrentX += Font.char_width ? Font.char_width[ch - 32] : Font.width;
@@ -302,6 +798,75 @@ char ssd1306_WriteString(char* str, SSD1306_Font_t Font, SSD1306_COLOR color) {
     return *str;
 }
 
+/*
+ * Draw 1 char of a page-major font (see Tools/host/fontconv) to the screen buffer.
+ * At a page-aligned Y in White each page of the glyph is copied as it is;
+ * otherwise its columns are shifted into place.
+ */
+char ssd1306_WritePageChar(char ch, const SSD1306_PageFont_t* Font, SSD1306_COLOR color) {
+    uint8_t pages = (Font->height + 7) / 8;
+
+    // Check if character is in the font
+    if (ch < 32 || ch > 126 || Font->index[ch - 32] == SSD1306_NO_GLYPH)
+        return 0;
+
+    // Check remaining space on current line
+    if (SSD1306_WIDTH < (SSD1306.CurrentX + Font->width) ||
+        SSD1306_HEIGHT < (SSD1306.CurrentY + Font->height))
+    {
+        // Not enough space on current line
+        return 0;
+    }
+
+    const uint8_t* glyph = &Font->data[Font->index[ch - 32] * pages * Font->width];
+    uint8_t* top = &SSD1306_Buffer[SSD1306.CurrentX + (SSD1306.CurrentY / 8) * SSD1306_WIDTH];
+    uint8_t shift = SSD1306.CurrentY % 8;
+
+    if (shift == 0 && color == White) {
+        uint8_t page = 0;
+        for (; page < Font->height / 8; page++) {
+            memcpy(top + page * SSD1306_WIDTH, glyph + page * Font->width, Font->width);
+        }
+        if (Font->height % 8) {
+            // Last page only partly in the cell; the converter clears the rows below it
+            uint8_t keep = 0xFF << (Font->height % 8);
+            uint8_t* out = top + page * SSD1306_WIDTH;
+            for (uint8_t j = 0; j < Font->width; j++) {
+                out[j] = (out[j] & keep) | glyph[page * Font->width + j];
+            }
+        }
+    } else {
+        uint32_t invert = (color == White) ? 0 : 0xFFFFFFFFUL;
+        for (uint8_t j = 0; j < Font->width; j++) {
+            uint32_t bits = 0;
+            for (uint8_t page = 0; page < pages; page++) {
+                bits |= (uint32_t) glyph[page * Font->width + j] << (8 * page);
+            }
+            ssd1306_BlitColumn(top + j, bits ^ invert, Font->height, shift);
+        }
+    }
+
+    // The current space is now taken
+    SSD1306.CurrentX += Font->width;
+
+    // Return written char for validation
+    return ch;
+}
+
+/* Write full string of a page-major font to screenbuffer */
+char ssd1306_WritePageString(const char* str, const SSD1306_PageFont_t* Font, SSD1306_COLOR color) {
+    while (*str) {
+        if (ssd1306_WritePageChar(*str, Font, color) != *str) {
+            // Char could not be written
+            return *str;
+        }
+        str++;
+    }
+
+    // Everything ok
+    return *str;
+}
+
 /* Position the cursor */
 void ssd1306_SetCursor(uint8_t x, uint8_t y) {
     SSD1306.CurrentX = x;
@@ -349,9 +914,42 @@ void ssd1306_Polyline(const SSD1306_VERTEX *par_vertex, uint16_t par_size, SSD13
     return;
 }
 
-/* Convert Degrees to Radians */
-static float ssd1306_DegToRad(float par_deg) {
-    return par_deg * (3.14f / 180.0f);
+/* sin of 0..90 degrees in Q14 (16384 = 1), the quarter wave the other quadrants are folded onto */
+static const int16_t SSD1306_SineTable[91] = {
+        0,   286,   572,   857,  1143,  1428,  1713,  1997,  2280,  2563,
+     2845,  3126,  3406,  3686,  3964,  4240,  4516,  4790,  5063,  5334,
+     5604,  5872,  6138,  6402,  6664,  6924,  7182,  7438,  7692,  7943,
+     8192,  8438,  8682,  8923,  9162,  9397,  9630,  9860, 10087, 10311,
+    10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+    12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+    14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+    15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+    16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+    16384,
+};
+
+/* sin of a whole number of degrees, in Q14 */
+static int16_t ssd1306_Sin(uint16_t par_deg) {
+    uint16_t angle = par_deg % 360;
+
+    if (angle < 90) {
+        return SSD1306_SineTable[angle];
+    } else if (angle < 180) {
+        return SSD1306_SineTable[180 - angle];
+    } else if (angle < 270) {
+        return -SSD1306_SineTable[angle - 180];
+    }
+    return -SSD1306_SineTable[360 - angle];
+}
+
+static int16_t ssd1306_Cos(uint16_t par_deg) {
+    return ssd1306_Sin(par_deg % 360 + 90);
+}
+
+/* A Q14 fraction of the radius, rounded to the nearest pixel */
+static int16_t ssd1306_Scale(int16_t par_q14, uint8_t par_r) {
+    int32_t product = (int32_t)par_q14 * par_r;
+    return (product >= 0 ? product + 8192 : product - 8192) / 16384;
 }
 
 /* Normalize degree to [0;360] */
@@ -366,42 +964,72 @@ static uint16_t ssd1306_NormalizeTo0_360(uint16_t par_deg) {
     return loc_angle;
 }
 
+/*
+ * Whether the offset (dx, dy) from the centre lies between the directions
+ * (ax, ay) and (bx, by), sweep degrees apart, going the way the angle grows.
+ * Cross products stand in for angles: with x = sin and y = cos, vx*uy - vy*ux
+ * has the sign of sin(v - u), positive when v is less than half a turn past u.
+ */
+static uint8_t ssd1306_InArc(int16_t dx, int16_t dy, int16_t ax, int16_t ay, int16_t bx, int16_t by, uint16_t sweep) {
+    int32_t from_start = (int32_t)dx * ay - (int32_t)dy * ax;  // > 0 past the start
+    int32_t to_end = (int32_t)bx * dy - (int32_t)by * dx;      // > 0 before the end
+
+    if (sweep >= 360) {
+        return 1;
+    }
+    if (sweep <= 180) {
+        return from_start >= 0 && to_end >= 0;
+    }
+    // more than half a turn: everything but the gap from end back round to start
+    return from_start >= 0 || to_end >= 0;
+}
+
+/*
+ * The pixels of a circle by the midpoint algorithm, one octant computed and
+ * mirrored into the other seven, keeping those from start_angle to end_angle.
+ */
+static void ssd1306_ArcPixels(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t end_angle, SSD1306_COLOR color) {
+    int16_t ax = ssd1306_Sin(start_angle);
+    int16_t ay = ssd1306_Cos(start_angle);
+    int16_t bx = ssd1306_Sin(end_angle);
+    int16_t by = ssd1306_Cos(end_angle);
+    uint16_t sweep = end_angle - start_angle;
+    int16_t px = radius;
+    int16_t py = 0;
+    int16_t d = 1 - radius;
+
+    while (px >= py) {
+        const int16_t offsets[8][2] = {
+            { px,  py}, { py,  px}, {-py,  px}, {-px,  py},
+            {-px, -py}, {-py, -px}, { py, -px}, { px, -py},
+        };
+        for (uint8_t i = 0; i < 8; i++) {
+            if (ssd1306_InArc(offsets[i][0], offsets[i][1], ax, ay, bx, by, sweep)) {
+                ssd1306_DrawPixel(x + offsets[i][0], y + offsets[i][1], color);
+            }
+        }
+        py++;
+        if (d < 0) {
+            d += 2 * py + 1;
+        } else {
+            px--;
+            d += 2 * (py - px) + 1;
+        }
+    }
+}
+
 /*
  * DrawArc. Draw angle is beginning from 4 quart of trigonometric circle (3pi/2)
  * start_angle in degree
  * sweep in degree
  */
 void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
-    static const uint8_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
-    float approx_degree;
-    uint32_t approx_segments;
-    uint8_t xp1,xp2;
-    uint8_t yp1,yp2;
-    uint32_t count;
-    uint32_t loc_sweep;
-    float rad;
-    
-    loc_sweep = ssd1306_NormalizeTo0_360(sweep);
-    
-    count = (ssd1306_NormalizeTo0_360(start_angle) * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
-    approx_segments = (loc_sweep * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
-    approx_degree = loc_sweep / (float)approx_segments;
-    while(count < approx_segments)
-    {
-        rad = ssd1306_DegToRad(count*approx_degree);
-        xp1 = x + (int8_t)(sinf(rad)*radius);
-        yp1 = y + (int8_t)(cosf(rad)*radius);    
-        count++;
-        if(count != approx_segments) {
-            rad = ssd1306_DegToRad(count*approx_degree);
-        } else {
-            rad = ssd1306_DegToRad(loc_sweep);
-        }
-        xp2 = x + (int8_t)(sinf(rad)*radius);
-        yp2 = y + (int8_t)(cosf(rad)*radius);    
-        ssd1306_Line(xp1,yp1,xp2,yp2,color);
+    uint16_t loc_start = ssd1306_NormalizeTo0_360(start_angle);
+    uint16_t loc_sweep = ssd1306_NormalizeTo0_360(sweep);
+
+    if (loc_start < loc_sweep) {
+        ssd1306_ArcPixels(x, y, radius, loc_start, loc_sweep, color);
     }
-    
     return;
 }
 
@@ -412,44 +1040,19 @@ void ssd1306_DrawArc(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle,
  * sweep: finish angle in degree
  */
 void ssd1306_DrawArcWithRadiusLine(uint8_t x, uint8_t y, uint8_t radius, uint16_t start_angle, uint16_t sweep, SSD1306_COLOR color) {
-    const uint32_t CIRCLE_APPROXIMATION_SEGMENTS = 36;
-    float approx_degree;
-    uint32_t approx_segments;
-    uint8_t xp1;
-    uint8_t xp2 = 0;
-    uint8_t yp1;
-    uint8_t yp2 = 0;
-    uint32_t count;
-    uint32_t loc_sweep;
-    float rad;
-    
-    loc_sweep = ssd1306_NormalizeTo0_360(sweep);
-    
-    count = (ssd1306_NormalizeTo0_360(start_angle) * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
-    approx_segments = (loc_sweep * CIRCLE_APPROXIMATION_SEGMENTS) / 360;
-    approx_degree = loc_sweep / (float)approx_segments;
-
-    rad = ssd1306_DegToRad(count*approx_degree);
-    uint8_t first_point_x = x + (int8_t)(sinf(rad)*radius);
-    uint8_t first_point_y = y + (int8_t)(cosf(rad)*radius);   
-    while (count < approx_segments) {
-        rad = ssd1306_DegToRad(count*approx_degree);
-        xp1 = x + (int8_t)(sinf(rad)*radius);
-        yp1 = y + (int8_t)(cosf(rad)*radius);    
-        count++;
-        if (count != approx_segments) {
-            rad = ssd1306_DegToRad(count*approx_degree);
-        } else {
-            rad = ssd1306_DegToRad(loc_sweep);
-        }
-        xp2 = x + (int8_t)(sinf(rad)*radius);
-        yp2 = y + (int8_t)(cosf(rad)*radius);    
-        ssd1306_Line(xp1,yp1,xp2,yp2,color);
+    uint16_t loc_start = ssd1306_NormalizeTo0_360(start_angle);
+    uint16_t loc_sweep = ssd1306_NormalizeTo0_360(sweep);
+
+    if (loc_start >= loc_sweep) {
+        return;
     }
-    
+    ssd1306_ArcPixels(x, y, radius, loc_start, loc_sweep, color);
+
     // Radius line
-    ssd1306_Line(x,y,first_point_x,first_point_y,color);
-    ssd1306_Line(x,y,xp2,yp2,color);
+    ssd1306_Line(x, y, x + ssd1306_Scale(ssd1306_Sin(loc_start), radius),
+            y + ssd1306_Scale(ssd1306_Cos(loc_start), radius), color);
+    ssd1306_Line(x, y, x + ssd1306_Scale(ssd1306_Sin(loc_sweep), radius),
+            y + ssd1306_Scale(ssd1306_Cos(loc_sweep), radius), color);
     return;
 }
 
@@ -488,7 +1091,23 @@ void ssd1306_DrawCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR
     return;
 }
 
-/* Draw filled circle. Pixel positions calculated using Bresenham's algorithm */
+/* One row of a filled shape, clipped to the screen */
+static void ssd1306_Span(int16_t x1, int16_t x2, int16_t y, SSD1306_COLOR color) {
+    if (y < 0 || y >= SSD1306_HEIGHT) {
+        return;
+    }
+    if (x1 < 0) {
+        x1 = 0;
+    }
+    if (x2 >= SSD1306_WIDTH) {
+        x2 = SSD1306_WIDTH - 1;
+    }
+    for (int16_t x = x1; x <= x2; x++) {
+        ssd1306_DrawPixel(x, y, color);
+    }
+}
+
+/* Draw filled circle. Pixel positions calculated using Bresenham's algorithm, each step filling the rows it reaches */
 void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR par_color) {
     int32_t x = -par_r;
     int32_t y = 0;
@@ -500,11 +1119,8 @@ void ssd1306_FillCircle(uint8_t par_x,uint8_t par_y,uint8_t par_r,SSD1306_COLOR
     }
 
     do {
-        for (uint8_t _y = (par_y + y); _y >= (par_y - y); _y--) {
-            for (uint8_t _x = (par_x - x); _x >= (par_x + x); _x--) {
-                ssd1306_DrawPixel(_x, _y, par_color);
-            }
-        }
+        ssd1306_Span(par_x + x, par_x - x, par_y + y, par_color);
+        ssd1306_Span(par_x + x, par_x - x, par_y - y, par_color);
 
         e2 = err;
         if (e2 <= y) {
@@ -549,6 +1165,49 @@ void ssd1306_FillRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2, SSD13
     return;
 }
 
+/* Draw a vertical line, setting or clearing a page byte at a time */
+void ssd1306_VerticalLine(uint8_t x, uint8_t y1, uint8_t y2, SSD1306_COLOR color) {
+    uint8_t y_start = ((y1<=y2) ? y1 : y2);
+    uint8_t y_end   = ((y1<=y2) ? y2 : y1);
+
+    if (x >= SSD1306_WIDTH || y_start >= SSD1306_HEIGHT) {
+        return;
+    }
+    if (y_end >= SSD1306_HEIGHT) {
+        y_end = SSD1306_HEIGHT - 1;
+    }
+
+    for (uint8_t page = y_start / 8; page <= y_end / 8; page++) {
+        uint8_t top = (page == y_start / 8) ? y_start % 8 : 0;
+        uint8_t bottom = (page == y_end / 8) ? y_end % 8 : 7;
+        uint8_t mask = (uint8_t)((0xFF << top) & (0xFF >> (7 - bottom)));
+        uint8_t* column = &SSD1306_Buffer[x + page * SSD1306_WIDTH];
+
+        if (color == White) {
+            *column |= mask;
+        } else {
+            *column &= ~mask;
+        }
+    }
+}
+
+/*
+ * Move pages firstPage..lastPage of the screenbuffer left by columns,
+ * clearing the columns that come in on the right. Rows of a page are
+ * contiguous, so this is a memmove per page; the rest of the screen is
+ * untouched.
+ */
+void ssd1306_ScrollPagesLeft(uint8_t firstPage, uint8_t lastPage, uint8_t columns) {
+    if (columns > SSD1306_WIDTH) {
+        columns = SSD1306_WIDTH;
+    }
+    for (uint8_t page = firstPage; page <= lastPage && page < SSD1306_HEIGHT / 8; page++) {
+        uint8_t* row = &SSD1306_Buffer[SSD1306_WIDTH * page];
+        memmove(row, row + columns, SSD1306_WIDTH - columns);
+        memset(row + SSD1306_WIDTH - columns, 0x00, columns);
+    }
+}
+
 SSD1306_Error_t ssd1306_InvertRectangle(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
   if ((x2 >= SSD1306_WIDTH) || (y2 >= SSD1306_HEIGHT)) {
     return SSD1306_ERR;
@@ -9,7 +9,6 @@
 
 #include "state_machine.h"
 #include "rotary_pot.h"
-#include <stdio.h>
 #include <task_buzzer.h>
 
 #define DEFAULT_GOAL 1000
@@ -35,6 +34,9 @@ void stateMachine_PreviousState(void)
 {
 	switch (step_counter.current_display_state) {
 		case STATE_CURRENT_STEPS:
+			step_counter.current_display_state = STATE_STEP_HISTORY;
+			break;
+		case STATE_STEP_HISTORY:
 			step_counter.current_display_state = STATE_DISTANCE_TRAVELLED;
 			break;
 		case STATE_DISTANCE_TRAVELLED:
@@ -56,6 +58,9 @@ void stateMachine_NextState(void)
 			step_counter.current_display_state = STATE_GOAL_PROGRESS;
 			break;
 		case STATE_DISTANCE_TRAVELLED:
+			step_counter.current_display_state = STATE_STEP_HISTORY;
+			break;
+		case STATE_STEP_HISTORY:
 			step_counter.current_display_state = STATE_CURRENT_STEPS;
 			break;
 		case STATE_GOAL_PROGRESS:
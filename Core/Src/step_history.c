@@ -0,0 +1,58 @@
+/*
+ * step_history.c
+ *
+ * Per-minute step counts in a fixed ring, one byte a minute. The task runs
+ * once a minute and stores the steps counted since its last run, so step
+ * detection itself is untouched. Minutes are numbered from start-up; the
+ * ring keeps the last STEP_HISTORY_MINUTES of them.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "step_history.h"
+#include "state_machine.h"
+
+#include <stdint.h>
+#include <string.h>
+
+static uint8_t minute_steps[STEP_HISTORY_MINUTES];
+static uint32_t minutes;			// minutes closed since start-up, counts freely
+static uint32_t last_step_count;
+
+
+void stepHistory_Init (void)
+{
+	memset (minute_steps, 0, sizeof(minute_steps));
+	minutes = 0;
+	last_step_count = stateMachine_StepCountGetter ();
+}
+
+
+/* Close the minute: steps since the last run, 0 if the count was lowered */
+void stepHistory_Execute (void)
+{
+	uint32_t step_count = stateMachine_StepCountGetter ();
+	uint32_t steps = step_count > last_step_count ? step_count - last_step_count : 0;
+
+	minute_steps[minutes & (STEP_HISTORY_MINUTES - 1)] =
+			steps < STEP_HISTORY_MAX_STEPS ? steps : STEP_HISTORY_MAX_STEPS;
+	last_step_count = step_count;
+	minutes++;
+}
+
+
+uint32_t stepHistory_MinutesGetter (void)
+{
+	return minutes;
+}
+
+
+/* Steps in the given minute, 0 if it has not closed yet or has left the ring */
+uint8_t stepHistory_MinuteGetter (uint32_t minute)
+{
+	if (minute >= minutes || minutes - minute > STEP_HISTORY_MINUTES) {
+		return 0;
+	}
+	return minute_steps[minute & (STEP_HISTORY_MINUTES - 1)];
+}
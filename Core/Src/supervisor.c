@@ -0,0 +1,252 @@
+/*
+ * supervisor.c
+ *
+ * Watchdog supervision of the scheduled tasks. The scheduler checks a
+ * task in whenever it finishes a run before its next period begins; a
+ * kernel thread added with supervisor_AddThread checks itself in after
+ * the table's tasks, and only has to keep its period.
+ * supervisor_Execute feeds the IWDG only if, since its last run, no
+ * supervised task missed a deadline and each one checked in within its
+ * period plus SUPERVISOR_GRACE_MS. A hung bus call stops the main loop
+ * and with it the feeding; a task that keeps overrunning, or a coroutine
+ * that never finishes, withholds it. Either way the IWDG resets the
+ * device once SUPERVISOR_TIMEOUT_MS pass without a feed.
+ *
+ * Nothing has to run before the reset: the task that is running and the
+ * trace ring live in .noinit RAM, which the startup code does not clear,
+ * so after a watchdog reset they still hold the state at the moment of
+ * the reset. A TRACE_RESET event marks the reset in the kept trace, the
+ * next trace dump shows what led up to it, and the display shows the
+ * report (supervisor_ReportGetter) in test mode.
+ *
+ * The IWDG runs from the LSI, independently of the system clock, and is
+ * set up here with registers the same way as TIM3 in timebase.c. Once
+ * started it cannot be stopped; it is frozen while a debugger halts the
+ * core.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "supervisor.h"
+#include "scheduler.h"
+#include "timebase.h"
+#include "trace.h"
+#include "main.h"
+#include "stm32c0xx_hal.h"
+
+#include <stdint.h>
+
+#define SUPERVISOR_MAGIC		0x53555056U	// "SUPV", the record survived the reset
+
+#define IWDG_KEY_RELOAD			0xAAAAU
+#define IWDG_KEY_ACCESS			0x5555U
+#define IWDG_KEY_START			0xCCCCU
+#define IWDG_PRESCALER_DIV32	3U		// 32 kHz LSI / 32 = 1 count per ms
+
+#define SUPERVISOR_SLOTS		(SCHEDULER_MAX_TASKS + SUPERVISOR_MAX_THREADS)	// the task table, then the threads
+
+typedef struct {
+	uint32_t magic;
+	uint16_t watchdog_resets;
+	volatile uint8_t running_task;
+} supervisor_record_t;
+
+static SUPERVISOR_NOINIT supervisor_record_t record;
+static supervisor_report_t report;
+
+static uint32_t check_ins[SUPERVISOR_SLOTS];		// last on-time finish (us)
+static uint32_t misses_seen[SCHEDULER_MAX_TASKS];
+static uint16_t thread_periods[SUPERVISOR_MAX_THREADS];	// ms
+static uint8_t thread_count = 0;
+static uint8_t started = 0;
+
+_Static_assert (SCHEDULER_MAX_TASKS <= 32, "supervisor_report_t.released has a bit per task");
+
+
+/* What caused the last reset; an internal reset also drives NRST, so the pin comes last */
+static supervisor_reset_t supervisor_ResetCause (void)
+{
+	if (__HAL_RCC_GET_FLAG (RCC_FLAG_IWDGRST)) {
+		return SUPERVISOR_RESET_WATCHDOG;
+	}
+	if (__HAL_RCC_GET_FLAG (RCC_FLAG_SFTRST)) {
+		return SUPERVISOR_RESET_SOFTWARE;
+	}
+	if (__HAL_RCC_GET_FLAG (RCC_FLAG_PWRRST)) {
+		return SUPERVISOR_RESET_POWER;
+	}
+	if (__HAL_RCC_GET_FLAG (RCC_FLAG_PINRST)) {
+		return SUPERVISOR_RESET_PIN;
+	}
+	return SUPERVISOR_RESET_OTHER;
+}
+
+
+static void supervisor_StartWatchdog (void)
+{
+#if SUPERVISOR_WATCHDOG
+	__HAL_RCC_DBGMCU_CLK_ENABLE ();
+	__HAL_DBGMCU_FREEZE_IWDG ();
+
+	IWDG->KR = IWDG_KEY_START;		// also starts the LSI
+	IWDG->KR = IWDG_KEY_ACCESS;
+	IWDG->PR = IWDG_PRESCALER_DIV32;
+	IWDG->RLR = SUPERVISOR_TIMEOUT_MS - 1;
+	while (IWDG->SR != 0) {
+		/* a few LSI cycles until the new prescaler and reload apply */
+	}
+	IWDG->KR = IWDG_KEY_RELOAD;
+#endif
+}
+
+
+/*
+ * Find out why the device reset, keep or clear the trace to match, and
+ * start the watchdog. Call first thing after timebase_Init, before
+ * anything is traced.
+ */
+void supervisor_Init (void)
+{
+	report.cause = supervisor_ResetCause ();
+	__HAL_RCC_CLEAR_RESET_FLAGS ();
+
+	uint8_t kept = record.magic == SUPERVISOR_MAGIC && report.cause != SUPERVISOR_RESET_POWER;
+	if (!kept) {
+		record.magic = SUPERVISOR_MAGIC;
+		record.watchdog_resets = 0;
+	}
+
+	if (kept && report.cause == SUPERVISOR_RESET_WATCHDOG) {
+		record.watchdog_resets++;
+		report.task = record.running_task;
+		trace_Start (1);
+		TRACE_RESET (report.task, record.watchdog_resets);
+	} else {
+		report.task = SUPERVISOR_NO_TASK;
+		trace_Start (0);
+	}
+	report.watchdog_resets = record.watchdog_resets;
+	report.released = 0;
+	record.running_task = SUPERVISOR_NO_TASK;
+
+	supervisor_StartWatchdog ();
+}
+
+
+void supervisor_ReportGetter (supervisor_report_t* out)
+{
+	*out = report;
+}
+
+
+void supervisor_TaskStart (uint8_t task)
+{
+	record.running_task = task;
+}
+
+
+void supervisor_TaskStop (void)
+{
+	record.running_task = SUPERVISOR_NO_TASK;
+}
+
+
+/* The task finished a run before its next period began */
+void supervisor_CheckIn (uint8_t task)
+{
+	if (task < SUPERVISOR_SLOTS) {
+		check_ins[task] = timebase_Micros32Getter ();
+	}
+}
+
+
+/*
+ * Supervise a kernel thread outside the task table, before kernel_Start.
+ * It passes the index returned to supervisor_CheckIn each time it finishes
+ * a run on time. More than SUPERVISOR_MAX_THREADS stop in Error_Handler.
+ */
+uint8_t supervisor_AddThread (uint16_t period_ms)
+{
+	if (thread_count >= SUPERVISOR_MAX_THREADS) {
+		Error_Handler ();
+	}
+	thread_periods[thread_count] = period_ms;
+	check_ins[SCHEDULER_MAX_TASKS + thread_count] = timebase_Micros32Getter ();
+	return SCHEDULER_MAX_TASKS + thread_count++;
+}
+
+
+/*
+ * Stop supervising the running task, for good: it has lost what it works
+ * with, e.g. the display once the driver gave up on its bus. A watchdog
+ * reset would not bring that back and would lose the step count, so the
+ * report records it instead.
+ */
+void supervisor_Release (void)
+{
+	uint8_t task = record.running_task;
+
+	if (task < SCHEDULER_MAX_TASKS) {
+		report.released |= 1U << task;
+	}
+}
+
+
+/* Start counting from now */
+static void supervisor_Start (uint32_t now)
+{
+	for (uint8_t i = 0; i < scheduler_TaskCountGetter (); i++) {
+		scheduler_stats_t stats;
+		scheduler_StatsGetter (i, &stats);
+		misses_seen[i] = stats.deadline_misses;
+		check_ins[i] = now;
+	}
+	for (uint8_t i = 0; i < thread_count; i++) {
+		check_ins[SCHEDULER_MAX_TASKS + i] = now;
+	}
+	started = 1;
+}
+
+
+/* Feed the watchdog if every supervised task is keeping its deadlines */
+void supervisor_Execute (void)
+{
+	uint32_t now = timebase_Micros32Getter ();
+	uint8_t healthy = 1;
+
+	if (!started) {
+		supervisor_Start (now);
+	}
+
+	for (uint8_t i = 0; i < scheduler_TaskCountGetter (); i++) {
+		const scheduler_task_t* task = scheduler_TaskGetter (i);
+		if (!task->supervised || (report.released & (1U << i))) {
+			continue;
+		}
+
+		scheduler_stats_t stats;
+		scheduler_StatsGetter (i, &stats);
+		if (stats.deadline_misses != misses_seen[i]) {
+			misses_seen[i] = stats.deadline_misses;
+			healthy = 0;
+		}
+		if ((int32_t) (now - check_ins[i]) > (int32_t) TIMEBASE_MS(task->period_ms + SUPERVISOR_GRACE_MS)) {
+			healthy = 0;
+		}
+	}
+	for (uint8_t i = 0; i < thread_count; i++) {
+		if ((int32_t) (now - check_ins[SCHEDULER_MAX_TASKS + i])
+				> (int32_t) TIMEBASE_MS(thread_periods[i] + SUPERVISOR_GRACE_MS)) {
+			healthy = 0;
+		}
+	}
+
+#if SUPERVISOR_WATCHDOG
+	if (healthy) {
+		IWDG->KR = IWDG_KEY_RELOAD;
+	}
+#else
+	(void) healthy;
+#endif
+}
@@ -23,9 +23,11 @@ void taskButtons_Init (void)
 	buttons_init ();
 }
 
-/* Psoll buttons and handle joystick and button events */
+/* Poll buttons and handle joystick and button events */
 void taskButtons_PollExecute (void)
 {
+    buttonEvent_t event;
+
     buttons_update ();
     joystick_event_t joystick_event = buttons_CheckHold ();
 
@@ -41,20 +43,24 @@ void taskButtons_PollExecute (void)
             stateMachine_RevertGoal ();
         }
         joystick_event = JOYSTICK_NONE;
-        return; // Disable other buttons when setting goal
-    }
-    joystick_event = JOYSTICK_NONE;
 
-
-    if (buttons_checkButton (UP) == PUSHED) {
-        stateMachine_IncrementStepCount (STEP_INCREMENT);
+        /* Disable other buttons when setting goal */
+        while (buttons_EventGetter (&event)) {
+            /* discard */
+        }
+        return;
     }
+    joystick_event = JOYSTICK_NONE;
 
+    while (buttons_EventGetter (&event)) {
+        if (event.state != PUSHED) {
+            continue;
+        }
 
-    if (buttons_CheckDoublePush ()) {
-        stateMachine_ToggleTestState ();
+        if (event.button == UP) {
+            stateMachine_IncrementStepCount (STEP_INCREMENT);
+        } else if (event.button == DOWN && buttons_CheckDoublePush (event.time_us)) {
+            stateMachine_ToggleTestState ();
+        }
     }
 }
-
-
-
@@ -9,6 +9,7 @@
 
 #include "task_buzzer.h"
 #include "pwm.h"
+#include "timebase.h"
 
 #include <stdint.h>
 #include <stdbool.h>
@@ -16,7 +17,7 @@
 #define BUZZER_REACHED_GOAL_TIME_MS 750
 #define BUZZER_0N_CCR 255
 
-static uint32_t buzzer_on_tick = 0;
+static uint64_t buzzer_on_us = 0;
 static bool buzzer_off = true;
 
 
@@ -26,7 +27,7 @@ void buzzer_Execute (void)
 	if (buzzer_off) {
 		return;
 	}
-	if ((HAL_GetTick () - buzzer_on_tick) >= BUZZER_REACHED_GOAL_TIME_MS) {
+	if ((timebase_MicrosGetter () - buzzer_on_us) >= TIMEBASE_MS(BUZZER_REACHED_GOAL_TIME_MS)) {
 		buzzer_TurnOff ();
 	}
 }
@@ -43,7 +44,7 @@ void buzzer_TurnOff (void)
 /* Turn buzzer on and start timer */
 void buzzer_TurnOn (void)
 {
-	buzzer_on_tick = HAL_GetTick ();
+	buzzer_on_us = timebase_MicrosGetter ();
 	buzzer_off = false;
 	pwm_setDutyCycle (&htim16, TIM_CHANNEL_1, BUZZER_0N_CCR);
 }
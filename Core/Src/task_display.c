@@ -4,6 +4,20 @@
  * Prints to OLED display the state of step counter
  * Uses integer math (no floats) for conversion between steps/km/m/yd
  *
+ * Each run gathers what the screen shows into a view and compares it with
+ * the view last rendered. Nothing is drawn or sent while they are equal;
+ * otherwise only the lines whose fields changed are cleared and redrawn,
+ * and the driver sends only the columns that differ.
+ *
+ * The step history state adds a graph of steps per minute, one column a
+ * minute with the latest on the right. It is drawn whole when the state is
+ * entered; after that each new minute scrolls the graph's pages left and
+ * draws one column, so nothing is redrawn from the history.
+ *
+ * With APP_USE_KERNEL, test mode uses the graph's rows outside the step
+ * history for the threads' stack high-water marks and the slowest context
+ * switch, as measured on the board.
+ *
  * Created on: Mar 11, 2025
  * Author: T. Linton, J. Legg
  */
@@ -13,48 +27,178 @@
 #include "ssd1306.h"
 #include "state_machine.h"
 #include "rotary_pot.h"
+#include "app.h"
+#include "scheduler.h"
+#include "coroutine.h"
+#include "timebase.h"
+#include "format.h"
+#include "step_history.h"
+#include "supervisor.h"
+#include "kernel.h"
 
-#include <stdio.h>
 #include <string.h>
 #include <stdint.h>
 
 #define STEP_TO_METRE_X100      90        // 90 metres to 100 steps
 #define METRE_TO_YARD_X100      109       // 109 yards to 100 steps
-#define METRE_X100_TO_KM        100000
 #define KM_TO_METRE				1000
 #define DECIMAL_POINT_SCALE     100       // scale for 2 decimal places
+#define DECIMAL_PLACES          2
+
+#ifndef DISPLAY_BENCH
+#define DISPLAY_BENCH			0		// 1 times text drawing once after power-up and shows it
+#endif
+#define DISPLAY_BENCH_REPEATS	100
+
+#define TEST_MODE_TOP			0		// test mode and CPU lines
+#define TEST_MODE_BOTTOM		21
+#define MAIN_TOP				24		// steps, distance, goal line
+#define MAIN_BOTTOM				33
+#define GRAPH_FIRST_PAGE		5		// step history graph, rows 40 to 63
+#define GRAPH_LAST_PAGE			7
+#define GRAPH_TOP				(GRAPH_FIRST_PAGE * 8)
+#define GRAPH_BOTTOM			(GRAPH_LAST_PAGE * 8 + 7)
+#define GRAPH_HEIGHT			(GRAPH_BOTTOM - GRAPH_TOP + 1)
+#define GRAPH_FULL_SCALE		150		// steps a minute for a full-height column, a brisk walk
+#define KERNEL_TOP				GRAPH_TOP	// kernel lines in test mode, where the graph goes
+#define KERNEL_BOTTOM			GRAPH_BOTTOM
+
+/* Everything the screen shows; fields that are not shown stay 0 so they cannot cause a redraw */
+typedef struct {
+	uint8_t test_mode;
+	uint16_t duty;
+	uint32_t misses;
+	uint16_t watchdog_resets;	// since power-up
+	uint8_t reset_task;			// running at the last reset, if that was the watchdog
+	DisplayState state;
+	UnitDisplayMode units;
+	uint32_t steps;
+	uint32_t goal;
+	uint32_t pot_goal;
+	uint32_t minutes;		// minutes of step history closed
+	uint8_t kernel_lines;		// test mode with APP_USE_KERNEL, outside the step history
+	uint16_t stack_used[3];		// words, sensor, ui and background threads
+	uint32_t switch_max;		// cycles
+} display_view_t;
 
 
 static char buffer[32];
 
-/* Initialise OLED display */
+static display_view_t view;
+static display_view_t rendered;
+static uint8_t rendered_valid = 0;
+static uint8_t graph_shown = 0;
+static uint32_t graph_minutes;		// the newest minute on the graph is the one before this
+
+static coroutine_t display_co;
+static uint8_t screen_ready = 0;
+static uint8_t init_command;
+static uint16_t init_failures;	// driver transfer failures before the power-up began
+
+/* The OLED is brought up by the first runs of taskDisplay_Execute */
 void taskDisplay_Init (void)
 {
-	ssd1306_Init ();
+	COROUTINE_INIT (&display_co);
+	screen_ready = 0;
+	rendered_valid = 0;
+	graph_shown = 0;
+}
+
+
+/* Gather what the screen would show now */
+static void taskDisplay_ViewGetter (display_view_t* out)
+{
+	memset (out, 0, sizeof(*out));
+
+	out->test_mode = stateMachine_TestModeEnabledGetter ();
+	if (out->test_mode) {
+		out->duty = app_DutyCycleGetter ();
+		out->misses = scheduler_DeadlineMissesGetter ();
+
+		supervisor_report_t report;
+		supervisor_ReportGetter (&report);
+		out->watchdog_resets = report.watchdog_resets;
+		out->reset_task = report.task;
+	}
+
+	out->state = stateMachine_DisplayStateGetter ();
+	switch (out->state) {
+		case STATE_CURRENT_STEPS:
+		case STATE_DISTANCE_TRAVELLED:
+			out->units = stateMachine_DisplayUnitGetter ();
+			out->steps = stateMachine_StepCountGetter ();
+			if (out->units == UNITS_PERCENT) {
+				out->goal = stateMachine_GoalGetter ();
+			}
+			break;
+		case STATE_GOAL_PROGRESS:
+			out->steps = stateMachine_StepCountGetter ();
+			out->goal = stateMachine_GoalGetter ();
+			break;
+		case STATE_SET_GOAL:
+			out->pot_goal = rotaryPot_ReadGoal ();
+			break;
+		case STATE_STEP_HISTORY:
+			out->minutes = stepHistory_MinutesGetter ();
+			out->steps = out->minutes > 0 ? stepHistory_MinuteGetter (out->minutes - 1) : 0;
+			break;
+		default:
+			break;
+	}
+
+#if APP_USE_KERNEL
+	if (out->test_mode && out->state != STATE_STEP_HISTORY) {
+		kernel_switch_stats_t switches;
+		kernel_SwitchStatsGetter (&switches);
+		app_StackUsageGetter (&out->stack_used[0], &out->stack_used[1], &out->stack_used[2]);
+		out->switch_max = switches.max_cycles;
+		out->kernel_lines = 1;
+	}
+#endif
 }
 
 
-/* Write test mode status to buffer and display it */
+/*
+ * Write test mode status to buffer and display it, with CPU load and deadline misses in test mode.
+ * After a watchdog reset the status gives way to the number of them and the task that was running.
+ */
 void taskDisplay_PrintTestMode (void)
 {
-	if (stateMachine_TestModeEnabledGetter ()) {
-		snprintf (buffer, sizeof(buffer), "Test Mode ON");
+	if (view.test_mode) {
+		if (view.watchdog_resets > 0) {
+			char* end = format_Unsigned (format_String (buffer, "WDT "), view.watchdog_resets, 1);
+			const scheduler_task_t* task = scheduler_TaskGetter (view.reset_task);
+			if (task != 0) {
+				format_String (format_String (end, " "), task->name);
+			}
+			ssd1306_WritePageString (buffer, &PageFont_7x10, White);
+		} else {
+			ssd1306_WritePageString ("Test Mode ON", &PageFont_7x10, White);
+		}
+
+		char* end = format_String (buffer, "CPU ");
+		end = format_Fixed (end, view.duty, 1);
+		end = format_String (end, "% Miss ");
+		format_Unsigned (end, view.misses, 1);
+		ssd1306_SetCursor (0, 12);
+		ssd1306_WritePageString (buffer, &PageFont_7x10, White);
 	} else {
-		snprintf (buffer, sizeof(buffer), "Test Mode OFF");
+		ssd1306_WritePageString ("Test Mode OFF", &PageFont_7x10, White);
 	}
-	ssd1306_WriteString (buffer, Font_7x10, White);
 }
 
 
 /* Format and write step count or percentage to buffer */
 void taskDisplay_PrintSteps (void)
 {
-	if (stateMachine_DisplayUnitGetter () == UNITS_STEPS) {
-		snprintf(buffer, sizeof(buffer), "Steps: %lu",
-				stateMachine_StepCountGetter ());
+	char* end = format_String (buffer, "Steps: ");
+
+	if (view.units == UNITS_STEPS) {
+		format_Unsigned (end, view.steps, 1);
 	} else {
-		uint16_t percent = (stateMachine_StepCountGetter () * 100) / stateMachine_GoalGetter ();
-		snprintf(buffer, sizeof(buffer), "Steps: %u%%", percent);
+		uint16_t percent = (view.steps * 100) / view.goal;
+		end = format_Unsigned (end, percent, 1);
+		format_String (end, "%");
 	}
 
 }
@@ -63,71 +207,269 @@ void taskDisplay_PrintSteps (void)
 /* Calculate distance in km or yd and write string to buffer */
 void taskDisplay_Distance (void)
 {
-	uint32_t dist_m_x100 = stateMachine_StepCountGetter() * STEP_TO_METRE_X100;
+	uint32_t dist_m_x100 = view.steps * STEP_TO_METRE_X100;
+	char* end = format_String (buffer, "Dist: ");
 
-	if (stateMachine_DisplayUnitGetter() == UNITS_KM) {
-		uint32_t km_whole = dist_m_x100 / METRE_X100_TO_KM;
-		uint32_t km_frac  = (dist_m_x100 % METRE_X100_TO_KM) / KM_TO_METRE;
-		snprintf(buffer, sizeof(buffer), "Dist: %lu.%02lu km", km_whole, km_frac);
+	if (view.units == UNITS_KM) {
+		uint32_t km_x100 = dist_m_x100 / KM_TO_METRE;
+		end = format_Fixed (end, km_x100, DECIMAL_PLACES);
+		format_String (end, " km");
 	} else {
 		uint32_t yards_x100 = (dist_m_x100 * METRE_TO_YARD_X100) / DECIMAL_POINT_SCALE;
-		snprintf(buffer, sizeof(buffer), "Dist: %lu.%02lu yd",
-				yards_x100 / DECIMAL_POINT_SCALE, yards_x100 % DECIMAL_POINT_SCALE);
+		end = format_Fixed (end, yards_x100, DECIMAL_PLACES);
+		format_String (end, " yd");
 	}
 }
 
 
-/*
- * Clears display
- * Calls print functions
- * Updates screen
- */
-void taskDisplay_Execute (void)
+/* Write steps taken out of the goal to buffer */
+static void taskDisplay_PrintGoalProgress (void)
 {
-	ssd1306_Fill (Black);
+	char* end = format_Unsigned (buffer, view.steps, 1);
+	end = format_String (end, " steps / ");
+	format_Unsigned (end, view.goal, 1);
+}
+
 
-	ssd1306_SetCursor(0, 0);
+/* Write test mode status and, in test mode, CPU load, deadline misses and the last watchdog reset */
+static void taskDisplay_RenderTestMode (void)
+{
+	ssd1306_FillRectangle (0, TEST_MODE_TOP, SSD1306_WIDTH - 1, TEST_MODE_BOTTOM, Black);
+	ssd1306_SetCursor (0, TEST_MODE_TOP);
 	taskDisplay_PrintTestMode ();
+}
+
 
-	ssd1306_SetCursor (0, 24);
-    switch (stateMachine_DisplayStateGetter ()) {
+/* Write the line for the display state */
+static void taskDisplay_RenderMain (void)
+{
+	ssd1306_FillRectangle (0, MAIN_TOP, SSD1306_WIDTH - 1, MAIN_BOTTOM, Black);
+	ssd1306_SetCursor (0, MAIN_TOP);
+    switch (view.state) {
 		case STATE_CURRENT_STEPS:
 			taskDisplay_PrintSteps ();
 			break;
 		case STATE_GOAL_PROGRESS:
-			snprintf(buffer, sizeof(buffer), "%lu steps / %lu",
-					stateMachine_StepCountGetter (), stateMachine_GoalGetter ());
+			taskDisplay_PrintGoalProgress ();
 			break;
 		case STATE_DISTANCE_TRAVELLED:
 			taskDisplay_Distance ();
 			break;
 		case STATE_SET_GOAL:
-			snprintf(buffer, sizeof(buffer), "Set Goal: %lu", rotaryPot_ReadGoal ());
+			format_Unsigned (format_String (buffer, "Set Goal: "), view.pot_goal, 1);
+			break;
+		case STATE_STEP_HISTORY:
+			format_Unsigned (format_String (buffer, "Steps/min: "), view.steps, 1);
 			break;
 
 		default:
-			snprintf(buffer, sizeof(buffer), " ");
+			format_String (buffer, " ");
 			break;
     }
-    ssd1306_WriteString(buffer, Font_7x10, White);
+    ssd1306_WritePageString(buffer, &PageFont_7x10, White);
+}
+
+
+/* Stack words used by the sensor, ui and background threads, and the slowest switch so far */
+static void taskDisplay_RenderKernel (void)
+{
+	char* end = buffer;
+
+	ssd1306_FillRectangle (0, KERNEL_TOP, SSD1306_WIDTH - 1, KERNEL_BOTTOM, Black);
+	end = format_String (end, "Stack");
+	for (uint8_t i = 0; i < 3; i++) {
+		end = format_Unsigned (format_String (end, " "), view.stack_used[i], 1);
+	}
+	ssd1306_SetCursor (0, KERNEL_TOP);
+	ssd1306_WritePageString (buffer, &PageFont_7x10, White);
 
-    ssd1306_UpdateScreen();
+	format_Unsigned (format_String (buffer, "Switch max "), view.switch_max, 1);
+	ssd1306_SetCursor (0, KERNEL_TOP + 12);
+	ssd1306_WritePageString (buffer, &PageFont_7x10, White);
 }
 
 
+/* Column x of the graph for a minute's steps; the column must be clear */
+static void taskDisplay_GraphColumn (uint8_t x, uint8_t steps)
+{
+	uint16_t height = ((uint16_t) steps * GRAPH_HEIGHT + GRAPH_FULL_SCALE - 1) / GRAPH_FULL_SCALE;
+
+	if (height > GRAPH_HEIGHT) {
+		height = GRAPH_HEIGHT;
+	}
+	if (height > 0) {
+		ssd1306_VerticalLine (x, GRAPH_BOTTOM + 1 - height, GRAPH_BOTTOM, White);
+	}
+}
+
+
+/*
+ * Bring the graph up to view.minutes: drawn whole when first shown or too
+ * far behind, otherwise scrolled left a column per new minute with only
+ * the new columns drawn. Returns 0 if nothing changed.
+ */
+static uint8_t taskDisplay_RenderGraph (void)
+{
+	uint32_t behind = view.minutes - graph_minutes;
+
+	if (graph_shown && behind == 0) {
+		return 0;
+	}
+	if (!graph_shown || behind >= SSD1306_WIDTH) {
+		ssd1306_FillRectangle (0, GRAPH_TOP, SSD1306_WIDTH - 1, GRAPH_BOTTOM, Black);
+		behind = view.minutes < SSD1306_WIDTH ? view.minutes : SSD1306_WIDTH;
+	} else {
+		ssd1306_ScrollPagesLeft (GRAPH_FIRST_PAGE, GRAPH_LAST_PAGE, behind);
+	}
+
+	for (uint32_t minute = view.minutes - behind; minute < view.minutes; minute++) {
+		taskDisplay_GraphColumn (SSD1306_WIDTH - (view.minutes - minute), stepHistory_MinuteGetter (minute));
+	}
+	graph_minutes = view.minutes;
+	graph_shown = 1;
+	return 1;
+}
 
 
+/*
+ * Redraws the lines whose fields differ from the last rendered view.
+ * Returns 0 if nothing changed.
+ */
+static uint8_t taskDisplay_Render (void)
+{
+	uint8_t changed = 0;
 
+	taskDisplay_ViewGetter (&view);
 
+	if (!rendered_valid || view.test_mode != rendered.test_mode
+			|| view.duty != rendered.duty || view.misses != rendered.misses
+			|| view.watchdog_resets != rendered.watchdog_resets || view.reset_task != rendered.reset_task) {
+		taskDisplay_RenderTestMode ();
+		changed = 1;
+	}
+	if (!rendered_valid || view.state != rendered.state || view.units != rendered.units
+			|| view.steps != rendered.steps || view.goal != rendered.goal
+			|| view.pot_goal != rendered.pot_goal) {
+		taskDisplay_RenderMain ();
+		changed = 1;
+	}
+	if (view.state == STATE_STEP_HISTORY) {
+		changed |= taskDisplay_RenderGraph ();
+	} else if (graph_shown) {
+		ssd1306_FillRectangle (0, GRAPH_TOP, SSD1306_WIDTH - 1, GRAPH_BOTTOM, Black);
+		graph_shown = 0;
+		changed = 1;
+	}
+	if (view.kernel_lines && (!rendered_valid || !rendered.kernel_lines || view.switch_max != rendered.switch_max
+			|| memcmp (view.stack_used, rendered.stack_used, sizeof(view.stack_used)) != 0)) {
+		taskDisplay_RenderKernel ();
+		changed = 1;
+	} else if (!view.kernel_lines && rendered_valid && rendered.kernel_lines && view.state != STATE_STEP_HISTORY) {
+		ssd1306_FillRectangle (0, KERNEL_TOP, SSD1306_WIDTH - 1, KERNEL_BOTTOM, Black);
+		changed = 1;
+	}
 
+	rendered = view;
+	rendered_valid = 1;
+	return changed;
+}
 
 
+#if DISPLAY_BENCH
+#include <stdio.h>
 
+/*
+ * Time drawing the main line on the device, to compare SSD1306_BLIT_TEXT settings, and formatting a line.
+ * The board has no console, so the results stay on the graph's rows until the graph or the kernel lines
+ * take them: "Text <us>/<us>" for the main line page-aligned and 4 rows down, "Dist <us>/<us>" for the
+ * distance line formatted and with snprintf, each per line.
+ */
+static void taskDisplay_Bench (void)
+{
+	uint32_t text_us[2];
+
+	format_String (buffer, "Steps: 12345");
+	for (uint8_t n = 0; n < 2; n++) {
+		uint32_t start = timebase_Micros32Getter ();
+		for (uint8_t i = 0; i < DISPLAY_BENCH_REPEATS; i++) {
+			ssd1306_SetCursor (0, MAIN_TOP + n * 4);
+			ssd1306_WritePageString (buffer, &PageFont_7x10, White);
+		}
+		text_us[n] = (timebase_Micros32Getter () - start) / DISPLAY_BENCH_REPEATS;
+	}
+	ssd1306_Fill (Black);
 
+	/* the distance line, the longest to format, against what snprintf took for it */
+	view.steps = 12345;
+	view.units = UNITS_KM;
+	uint32_t start = timebase_Micros32Getter ();
+	for (uint8_t i = 0; i < DISPLAY_BENCH_REPEATS; i++) {
+		taskDisplay_Distance ();
+	}
+	uint32_t formatted = timebase_Micros32Getter () - start;
 
+	start = timebase_Micros32Getter ();
+	for (uint8_t i = 0; i < DISPLAY_BENCH_REPEATS; i++) {
+		uint32_t km_x100 = view.steps * STEP_TO_METRE_X100 / KM_TO_METRE;
+		snprintf (buffer, sizeof(buffer), "Dist: %lu.%02lu km", km_x100 / DECIMAL_POINT_SCALE,
+				km_x100 % DECIMAL_POINT_SCALE);
+	}
+	uint32_t printed = timebase_Micros32Getter () - start;
 
+	char* end = format_Unsigned (format_String (buffer, "Text "), text_us[0], 1);
+	format_String (format_Unsigned (format_String (end, "/"), text_us[1], 1), " us");
+	ssd1306_SetCursor (0, GRAPH_TOP);
+	ssd1306_WritePageString (buffer, &PageFont_7x10, White);
 
+	end = format_Unsigned (format_String (buffer, "Dist "), formatted / DISPLAY_BENCH_REPEATS, 1);
+	format_String (format_Unsigned (format_String (end, "/"), printed / DISPLAY_BENCH_REPEATS, 1), " us");
+	ssd1306_SetCursor (0, GRAPH_TOP + 12);
+	ssd1306_WritePageString (buffer, &PageFont_7x10, White);
+}
+#endif
 
 
+/*
+ * Coroutine: powers up the OLED on its first run, then every period
+ * redraws what changed into the back buffer and flushes it, once the
+ * previous frame's transfer has finished.
+ * The power-up spans several periods; it is start-up work, not a missed
+ * deadline, so the task's period starts once the screen is ready. A bus
+ * failure during it may have lost part of the sequence, so it starts again.
+ * Once the driver gives up on the bus nothing is drawn or waited for, and
+ * the task leaves supervision rather than have the watchdog reset a device
+ * that counts steps fine without its screen.
+ */
+void taskDisplay_Execute (void)
+{
+	COROUTINE_BEGIN (&display_co);
+
+	while (!screen_ready && !ssd1306_GaveUpGetter ()) {
+		scheduler_Rephase ();
+		init_failures = ssd1306_TransferFailuresGetter ();
+		ssd1306_Reset ();
+		COROUTINE_SLEEP (&display_co, SSD1306_BOOT_TIME_MS);
+
+		for (init_command = 0; ssd1306_WriteInitCommand (init_command); init_command++) {
+			COROUTINE_YIELD_IF_OVER_BUDGET (&display_co);
+		}
+		ssd1306_InitFinish ();
+		COROUTINE_AWAIT (&display_co, ssd1306_ProcessEvents () || ssd1306_GaveUpGetter ());
+		screen_ready = (ssd1306_TransferFailuresGetter () == init_failures);
+#if DISPLAY_BENCH
+		if (screen_ready) {
+			taskDisplay_Bench ();
+		}
+#endif
+	}
 
+	/* drawn while the last frame may still be on the bus, only the flush waits for it; not at all on a dead one */
+	if (ssd1306_GaveUpGetter ()) {
+		supervisor_Release ();
+	} else if (taskDisplay_Render ()) {
+		ssd1306_UpdateScreen ();
+	}
+	COROUTINE_AWAIT (&display_co, ssd1306_FlushStarted () || ssd1306_GaveUpGetter ());
 
+	COROUTINE_END (&display_co);
+}
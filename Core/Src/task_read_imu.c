@@ -13,14 +13,31 @@
 #include "imu_lsm6ds.h"
 #include "filter.h"
 #include "peak_detection.h"
+#include "state_machine.h"
+#include "ring_buffer.h"
+#include "trace.h"
+#include "coroutine.h"
 
 #include <stdint.h>
 
-#define X_OFFSET 245
-#define Y_OFFSET 140
-#define Z_OFFSET (-300)
+#define IMU_SAMPLE_RING_SIZE 8	// samples read but not yet processed
+#define IMU_STEP_RING_SIZE 16	// steps found by imu_ExecuteAll but not yet counted
 
-#define BIT_SHIFT_SCALE 10 // scale magnitude by 2^10 = 1024
+#if !RING_BUFFER_IS_POWER_OF_TWO(IMU_SAMPLE_RING_SIZE) || !RING_BUFFER_IS_POWER_OF_TWO(IMU_STEP_RING_SIZE)
+#error "IMU_SAMPLE_RING_SIZE and IMU_STEP_RING_SIZE must be powers of two"
+#endif
+
+typedef struct {
+	int16_t x;
+	int16_t y;
+	int16_t z;
+} imu_sample_t;
+
+static imu_sample_t sample_storage[IMU_SAMPLE_RING_SIZE];
+static ring_buffer_t sample_ring;
+static uint8_t step_storage[IMU_STEP_RING_SIZE];
+static ring_buffer_t step_ring;
+static coroutine_t imu_co;
 
 static int16_t raw_x_acc;
 static int16_t raw_y_acc;
@@ -33,7 +50,16 @@ static uint32_t acc_mag;
 /* Initialise filter and imu sensor settings */
 void imu_Init (void)
 {
+	imu_filtered[0] = 0;
+	imu_filtered[1] = 0;
+	imu_filtered[2] = 0;
+	acc_mag = 0;
+	ringBuffer_Init (&sample_ring, sample_storage, sizeof(imu_sample_t), IMU_SAMPLE_RING_SIZE);
+	ringBuffer_Init (&step_ring, step_storage, sizeof(uint8_t), IMU_STEP_RING_SIZE);
+	COROUTINE_INIT (&imu_co);
+
 	filter_Init();
+	peakDetection_Init ();
 	imu_lsm6ds_write_byte(CTRL1_XL, CTRL1_XL_HIGH_PERFORMANCE);
 }
 
@@ -49,7 +75,10 @@ void imu_CalcAccMagnitude (void)
 	acc_mag = acc_mag >> BIT_SHIFT_SCALE;
 }
 
-/* Read raw acceleration data from imu */
+/*
+ * Read raw acceleration data from imu and queue it for processing
+ * Only producer of sample_ring, so it can move to a data-ready interrupt
+ */
 void imu_ReadRawData (void)
 {
 	uint8_t acc_x_low 	= imu_lsm6ds_read_byte (OUTX_L_XL);
@@ -59,9 +88,11 @@ void imu_ReadRawData (void)
 	uint8_t acc_z_low 	= imu_lsm6ds_read_byte (OUTZ_L_XL);
 	uint8_t acc_z_high 	= imu_lsm6ds_read_byte (OUTZ_H_XL);
 
-	raw_x_acc = (int16_t) ((acc_x_high << 8) | acc_x_low);
-	raw_y_acc = (int16_t) ((acc_y_high << 8) | acc_y_low);
-	raw_z_acc = (int16_t) ((acc_z_high << 8) | acc_z_low);
+	imu_sample_t sample;
+	sample.x = (int16_t) ((acc_x_high << 8) | acc_x_low);
+	sample.y = (int16_t) ((acc_y_high << 8) | acc_y_low);
+	sample.z = (int16_t) ((acc_z_high << 8) | acc_z_low);
+	ringBuffer_Push (&sample_ring, &sample);
 }
 
 
@@ -74,15 +105,106 @@ void imu_ScaleRawData (void)
 }
 
 
-/* read, scale, filter, update magnitude, and detect peaks */
-void imu_Execute (void)
+/* scale, filter, update magnitude and detect peaks for the sample in raw_*_acc, returns the steps found */
+static uint8_t imu_ProcessSample (void)
 {
-	imu_ReadRawData ();
 	imu_ScaleRawData ();
 	filter_IIR (raw_x_acc, raw_y_acc, raw_z_acc, imu_filtered);
 	imu_CalcAccMagnitude ();
 	filter_MagnitudeUpdate (acc_mag); // finds mean of previous magnitudes
-	peakDetection_Execute ();
+
+	uint8_t steps = peakDetection_Execute ();
+	if (steps) {
+		TRACE_STEP (steps);
+	}
+	return steps;
+}
+
+
+/*
+ * Coroutine: read, then scale, filter, update magnitude, and detect peaks for every
+ * queued sample, yielding if a backlog takes longer than the scheduler budget
+ */
+void imu_Execute (void)
+{
+	imu_sample_t sample;
+	uint8_t steps;
+
+	COROUTINE_BEGIN (&imu_co);
+
+	imu_ReadRawData ();
+	while (ringBuffer_Pop (&sample_ring, &sample)) {
+		raw_x_acc = sample.x;
+		raw_y_acc = sample.y;
+		raw_z_acc = sample.z;
+		steps = imu_ProcessSample ();
+		if (steps) {
+			stateMachine_IncrementStepCount (steps);
+		}
+		COROUTINE_YIELD_IF_OVER_BUDGET (&imu_co);
+	}
+
+	COROUTINE_END (&imu_co);
+}
+
+
+/*
+ * read, then process every queued sample without yielding
+ * For a dedicated thread (APP_USE_KERNEL), which is not bound by the scheduler budget
+ * and does not own the state machine: steps are queued for imu_CountQueuedSteps
+ */
+void imu_ExecuteAll (void)
+{
+	imu_sample_t sample;
+
+	imu_ReadRawData ();
+	while (ringBuffer_Pop (&sample_ring, &sample)) {
+		raw_x_acc = sample.x;
+		raw_y_acc = sample.y;
+		raw_z_acc = sample.z;
+		uint8_t steps = imu_ProcessSample ();
+		if (steps) {
+			ringBuffer_Push (&step_ring, &steps);
+		}
+	}
+}
+
+
+/* Add the steps queued by imu_ExecuteAll to the count, from the thread that runs the tasks */
+void imu_CountQueuedSteps (void)
+{
+	uint8_t steps;
+
+	while (ringBuffer_Pop (&step_ring, &steps)) {
+		stateMachine_IncrementStepCount (steps);
+	}
+}
+
+
+/*
+ * Run a block of raw samples (e.g. an LSM6DS FIFO burst or a logged trace)
+ * through the same pipeline as imu_Execute
+ * steps, if not NULL, gets 1 for every sample on which a step was counted
+ * Returns the number of steps counted in the block
+ */
+uint16_t imu_ProcessBlock (const int16_t* x, const int16_t* y, const int16_t* z, uint16_t count, uint8_t* steps)
+{
+	uint16_t detected = 0;
+
+	for (uint16_t i = 0; i < count; i++) {
+		raw_x_acc = x[i];
+		raw_y_acc = y[i];
+		raw_z_acc = z[i];
+		uint8_t step = imu_ProcessSample ();
+		if (step) {
+			stateMachine_IncrementStepCount (step);
+		}
+		if (steps) {
+			steps[i] = step;
+		}
+		detected += step;
+	}
+	return detected;
 }
 
 
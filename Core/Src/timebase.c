@@ -0,0 +1,89 @@
+/*
+ * timebase.c
+ *
+ * Free-running microsecond clock on TIM3, independent of SysTick, so it
+ * keeps counting while SysTick is stretched for tickless idle.
+ *
+ * TIM3 is a 16-bit timer prescaled to 1 MHz. Its update interrupt counts
+ * overflows (one every 65.536 ms) into the upper bits. Reads need no
+ * locking: they retry if an overflow was counted part way through, and
+ * pick up an overflow that is still pending when interrupts are masked.
+ *
+ * TIM3 is set up here rather than in CubeMX, the same way as SysTick in
+ * app.c.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "timebase.h"
+#include "stm32c0xx_hal.h"
+
+#include <stdint.h>
+
+#define TIMEBASE_IRQ_PRIO	0	// above everything that reads the clock for long
+
+static volatile uint32_t overflows = 0;
+
+
+void timebase_Init (void)
+{
+	__HAL_RCC_TIM3_CLK_ENABLE ();
+
+	/* PCLK drives TIM3 directly while the APB prescaler is 1, as configured */
+	TIM3->CR1 = 0;
+	TIM3->PSC = HAL_RCC_GetPCLK1Freq () / TIMEBASE_HZ - 1;
+	TIM3->ARR = 0xFFFF;
+	TIM3->CNT = 0;
+	TIM3->EGR = TIM_EGR_UG;		// load PSC now
+	TIM3->SR = 0;
+	TIM3->DIER = TIM_DIER_UIE;
+
+	overflows = 0;
+	HAL_NVIC_SetPriority (TIM3_IRQn, TIMEBASE_IRQ_PRIO, 0);
+	HAL_NVIC_EnableIRQ (TIM3_IRQn);
+	TIM3->CR1 = TIM_CR1_CEN;
+}
+
+
+/* Overflow count and counter read as one value, see the file comment */
+static uint64_t timebase_Read (void)
+{
+	uint32_t high;
+	uint32_t seen;
+	uint16_t low;
+
+	do {
+		seen = overflows;
+		high = seen;
+		low = TIM3->CNT;
+		if (TIM3->SR & TIM_SR_UIF) {
+			/* wrapped, the interrupt has not counted it yet */
+			low = TIM3->CNT;
+			high++;
+		}
+	} while (seen != overflows);
+
+	return ((uint64_t) high << 16) | low;
+}
+
+
+uint64_t timebase_MicrosGetter (void)
+{
+	return timebase_Read ();
+}
+
+
+uint32_t timebase_Micros32Getter (void)
+{
+	return (uint32_t) timebase_Read ();
+}
+
+
+void TIM3_IRQHandler (void)
+{
+	if (TIM3->SR & TIM_SR_UIF) {
+		TIM3->SR = ~TIM_SR_UIF;
+		overflows++;
+	}
+}
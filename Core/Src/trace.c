@@ -0,0 +1,189 @@
+/*
+ * trace.c
+ *
+ * Execution trace recorder. Events go into a RAM ring that overwrites the
+ * oldest, so the last TRACE_BUFFER_EVENTS events before a dump are always
+ * available. Sending any byte to USART2 dumps the ring (see trace.h for
+ * the layout); recording pauses while the dump is sent.
+ *
+ * The dump goes out by interrupt, one part (header, each task name, the
+ * two halves of the ring) at a time, each started by the completion of
+ * the one before. No task waits for the UART, so a dump does not change
+ * the timing it shows.
+ *
+ * The ring is in .noinit RAM so that it survives a watchdog reset, see
+ * supervisor.c.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "trace.h"
+#include "scheduler.h"
+#include "supervisor.h"
+#include "timebase.h"
+#include "usart.h"
+#include "stm32c0xx_hal.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define TRACE_MASK			(TRACE_BUFFER_EVENTS - 1)
+#define TRACE_IDLE			0xFF	// dump_part when no dump is being sent
+
+static SUPERVISOR_NOINIT trace_event_t events[TRACE_BUFFER_EVENTS];
+static SUPERVISOR_NOINIT uint32_t written;		// events recorded since the last dump
+static volatile uint8_t paused = 0;
+
+/* The dump in progress, read by the UART interrupt */
+static uint8_t header[TRACE_HEADER_SIZE];
+static volatile uint8_t dump_part = TRACE_IDLE;	// next part to send, see trace_SendNext
+static uint32_t dump_count;
+static uint32_t dump_oldest;
+static uint32_t dump_first;		// events from dump_oldest to the end of the ring
+
+
+/* Start recording; keep = 1 carries on after the events from before a reset */
+void trace_Start (uint8_t keep)
+{
+	if (!keep) {
+		written = 0;
+	}
+	paused = 0;
+}
+
+
+/*
+ * Safe to call from tasks and interrupts alike. The time is read before
+ * interrupts are masked, so they are only held off for the slot's stores;
+ * an interrupt in between may record its events first, with later times.
+ */
+void trace_Record (uint8_t type, uint8_t id, uint16_t arg)
+{
+	uint32_t time_us = timebase_Micros32Getter ();
+	uint32_t primask = __get_PRIMASK ();
+	__disable_irq ();
+
+	if (!paused) {
+		trace_event_t* event = &events[written & TRACE_MASK];
+		written++;
+		event->time_us = time_us;
+		event->type = type;
+		event->id = id;
+		event->arg = arg;
+	}
+
+	__set_PRIMASK (primask);
+}
+
+
+static void trace_Put16 (uint8_t* out, uint16_t value)
+{
+	out[0] = value;
+	out[1] = value >> 8;
+}
+
+
+static void trace_Put32 (uint8_t* out, uint32_t value)
+{
+	trace_Put16 (out, value);
+	trace_Put16 (out + 2, value >> 16);
+}
+
+
+/*
+ * Start sending the next part of the dump, skipping empty ones, or finish
+ * the dump after the last. Parts: the header, one per task name, then the
+ * events from the oldest to the end of the ring and from its start.
+ */
+static void trace_SendNext (void)
+{
+	uint8_t names = scheduler_TaskCountGetter ();
+
+	while (dump_part != TRACE_IDLE) {
+		uint8_t part = dump_part++;
+		const void* data;
+		uint16_t length;
+
+		if (part == 0) {
+			data = header;
+			length = sizeof(header);
+		} else if (part <= names) {
+			data = scheduler_TaskGetter (part - 1)->name;
+			length = strlen (data) + 1;
+		} else if (part == names + 1) {
+			/* trace_event_t matches the little endian dump layout, send it as it is */
+			data = &events[dump_oldest];
+			length = dump_first * sizeof(trace_event_t);
+		} else if (part == names + 2) {
+			data = &events[0];
+			length = (dump_count - dump_first) * sizeof(trace_event_t);
+		} else {
+			break;
+		}
+
+		if (length > 0 && HAL_UART_Transmit_IT (&huart2, data, length) == HAL_OK) {
+			return;
+		}
+		if (length > 0) {
+			break;		// the UART would not take it, give up on this dump
+		}
+	}
+
+	dump_part = TRACE_IDLE;
+	written = 0;
+	paused = 0;
+}
+
+
+/* Start sending the recorded events over USART2, oldest first, and start over once sent; returns at once */
+void trace_Dump (void)
+{
+	if (dump_part != TRACE_IDLE) {
+		return;
+	}
+	uint16_t names_bytes = 0;
+
+	paused = 1;
+
+	dump_count = written < TRACE_BUFFER_EVENTS ? written : TRACE_BUFFER_EVENTS;
+	dump_oldest = (written - dump_count) & TRACE_MASK;
+	dump_first = dump_count < TRACE_BUFFER_EVENTS - dump_oldest ? dump_count : TRACE_BUFFER_EVENTS - dump_oldest;
+
+	for (uint8_t i = 0; i < scheduler_TaskCountGetter (); i++) {
+		names_bytes += strlen (scheduler_TaskGetter (i)->name) + 1;
+	}
+
+	memcpy (header, TRACE_MAGIC, 4);
+	trace_Put16 (&header[4], TRACE_VERSION);
+	trace_Put16 (&header[6], TRACE_EVENT_SIZE);
+	trace_Put32 (&header[8], TIMEBASE_HZ);
+	trace_Put32 (&header[12], dump_count);
+	trace_Put32 (&header[16], written - dump_count);
+	trace_Put16 (&header[20], names_bytes);
+
+	dump_part = 0;
+	trace_SendNext ();
+}
+
+
+/* The last part went out, carry on with the dump */
+void HAL_UART_TxCpltCallback (UART_HandleTypeDef* huart)
+{
+	if (huart == &huart2) {
+		trace_SendNext ();
+	}
+}
+
+
+/* Dump when anything arrives on USART2, unless a dump is still being sent */
+void trace_Execute (void)
+{
+	if (__HAL_UART_GET_FLAG (&huart2, UART_FLAG_ORE)) {
+		__HAL_UART_CLEAR_OREFLAG (&huart2);
+	}
+	if (__HAL_UART_GET_FLAG (&huart2, UART_FLAG_RXNE)) {
+		(void) huart2.Instance->RDR;
+		trace_Dump ();
+	}
+}
@@ -0,0 +1,336 @@
+/*
+ * diffcheck.c
+ *
+ * Differential check of the fixed-point step pipeline against the double
+ * precision model in reference.c.
+ *
+ * Every sample goes through the unmodified firmware (imu_Execute) and the
+ * reference. Each stage's error (firmware - reference) is reported twice:
+ *  - stage only:  the reference stage is fed the firmware's own upstream
+ *                 values, so this is what that one shift or truncation costs
+ *  - cumulative:  the reference runs end to end, so upstream error is included
+ *
+ * With no trace arguments (or -s) a set of synthetic edge cases is run:
+ * constant, full-scale, square wave, ramp and impulse inputs.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "reference.h"
+#include "trace_io.h"
+#include "stubs.h"
+#include "task_read_imu.h"
+#include "filter.h"
+#include "state_machine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <getopt.h>
+
+#define SYNTHETIC_SAMPLES	2000
+#define ONE_G				16384	// LSM6DS at +-2g
+#define FULL_SCALE			32767
+
+typedef enum {
+	STAGE_OFFSET,
+	STAGE_IIR,
+	STAGE_MAGNITUDE,
+	STAGE_MEAN,
+	STAGE_VARIANCE,
+	NUM_STAGES
+} stage_t;
+
+static const char* const stage_names[NUM_STAGES] = {
+	[STAGE_OFFSET]		= "offset",
+	[STAGE_IIR]			= "iir",
+	[STAGE_MAGNITUDE]	= "magnitude",
+	[STAGE_MEAN]		= "mean",
+	[STAGE_VARIANCE]	= "scaled variance",
+};
+
+typedef struct {
+	uint64_t count;
+	double sum;
+	double sum_sq;
+	double max_abs;
+	uint32_t max_index;
+} error_stats_t;
+
+typedef struct {
+	error_stats_t local[NUM_STAGES];
+	error_stats_t cumulative[NUM_STAGES];
+	uint32_t samples;
+	uint32_t offset_wraps;			// int16_t overflow after adding X_OFFSET etc.
+	uint32_t negative_differences;	// sum_of_sq - mean^2 < 0 in the unsigned firmware maths
+} diff_result_t;
+
+
+static void diffcheck_Record (error_stats_t* stats, double firmware, double reference, uint32_t index)
+{
+	double error = firmware - reference;
+	stats->count++;
+	stats->sum += error;
+	stats->sum_sq += error * error;
+	if (fabs (error) > stats->max_abs || stats->count == 1) {
+		stats->max_abs = fabs (error);
+		stats->max_index = index;
+	}
+}
+
+
+static void diffcheck_Merge (error_stats_t* total, const error_stats_t* stats)
+{
+	if (stats->max_abs > total->max_abs || total->count == 0) {
+		total->max_abs = stats->max_abs;
+		total->max_index = stats->max_index;
+	}
+	total->count += stats->count;
+	total->sum += stats->sum;
+	total->sum_sq += stats->sum_sq;
+}
+
+
+static void diffcheck_Run (const trace_t* trace, diff_result_t* result)
+{
+	reference_t reference;
+	reference_window_t local_window;
+	reference_sample_t expected;
+	reference_sample_t local;
+	int16_t previous_filtered[3] = {0, 0, 0};
+
+	memset (result, 0, sizeof(*result));
+	stateMachine_Init ();
+	imu_Init ();
+	reference_Init (&reference);
+	reference_WindowInit (&local_window);
+
+	for (uint32_t i = 0; i < trace->count; i++) {
+		stubs_SetImuSample (trace->x[i], trace->y[i], trace->z[i]);
+		imu_Execute ();
+		reference_Execute (&reference, trace->x[i], trace->y[i], trace->z[i], &expected);
+
+		int16_t offset[3] = {imu_xAccGetter (), imu_yAccGetter (), imu_zAccGetter ()};
+		int16_t filtered[3] = {imu_xFilteredGetter (), imu_yFilteredGetter (), imu_zFilteredGetter ()};
+		uint32_t magnitude = filter_MagnitudeCurrentGetter ();
+		uint32_t mean = filter_MagnitudeMeanGetter ();
+		uint32_t variance = filter_MagnitudeScaledVarGetter ();
+
+		for (int axis = 0; axis < 3; axis++) {
+			diffcheck_Record (&result->local[STAGE_OFFSET], offset[axis], expected.offset[axis], i);
+			diffcheck_Record (&result->cumulative[STAGE_OFFSET], offset[axis], expected.offset[axis], i);
+			if (offset[axis] != expected.offset[axis]) {
+				result->offset_wraps++;
+			}
+
+			double iir = reference_IIR (previous_filtered[axis], offset[axis]);
+			diffcheck_Record (&result->local[STAGE_IIR], filtered[axis], iir, i);
+			diffcheck_Record (&result->cumulative[STAGE_IIR], filtered[axis], expected.filtered[axis], i);
+			previous_filtered[axis] = filtered[axis];
+		}
+
+		double local_magnitude = reference_Magnitude (filtered[0], filtered[1], filtered[2]);
+		diffcheck_Record (&result->local[STAGE_MAGNITUDE], magnitude, local_magnitude, i);
+		diffcheck_Record (&result->cumulative[STAGE_MAGNITUDE], magnitude, expected.magnitude, i);
+
+		/* the local window holds the firmware's integer magnitudes */
+		reference_WindowUpdate (&local_window, magnitude, &local);
+		diffcheck_Record (&result->local[STAGE_MEAN], mean, local.mean, i);
+		diffcheck_Record (&result->cumulative[STAGE_MEAN], mean, expected.mean, i);
+		diffcheck_Record (&result->local[STAGE_VARIANCE], variance, local.scaled_variance, i);
+		diffcheck_Record (&result->cumulative[STAGE_VARIANCE], variance, expected.scaled_variance, i);
+
+		/* the firmware subtracts the truncated mean, check it cannot go below zero either */
+		double truncated_mean = (double) mean;
+		double sum_of_sq = local.unscaled_difference + local.mean * local.mean;
+		if (local.unscaled_difference < 0.0 || sum_of_sq < truncated_mean * truncated_mean) {
+			result->negative_differences++;
+		}
+	}
+	result->samples = trace->count;
+}
+
+
+static void diffcheck_Accumulate (diff_result_t* total, const diff_result_t* result)
+{
+	for (int stage = 0; stage < NUM_STAGES; stage++) {
+		diffcheck_Merge (&total->local[stage], &result->local[stage]);
+		diffcheck_Merge (&total->cumulative[stage], &result->cumulative[stage]);
+	}
+	total->samples += result->samples;
+	total->offset_wraps += result->offset_wraps;
+	total->negative_differences += result->negative_differences;
+}
+
+
+static void diffcheck_PrintStats (const error_stats_t* stats)
+{
+	double bias = stats->count ? stats->sum / stats->count : 0.0;
+	double rms = stats->count ? sqrt (stats->sum_sq / stats->count) : 0.0;
+	printf ("  %10.3f %10.3f %11.3f %7u", bias, rms, stats->max_abs, stats->max_index);
+}
+
+
+static void diffcheck_Print (const char* name, const diff_result_t* result)
+{
+	printf ("%s: %u samples\n", name, result->samples);
+	printf ("%-16s  %-41s  %s\n", "", "------------- stage only --------------",
+			"------------- cumulative --------------");
+	printf ("%-16s  %10s %10s %11s %7s  %10s %10s %11s %7s\n", "stage",
+			"bias", "rms", "max|err|", "sample", "bias", "rms", "max|err|", "sample");
+	for (int stage = 0; stage < NUM_STAGES; stage++) {
+		printf ("%-16s", stage_names[stage]);
+		diffcheck_PrintStats (&result->local[stage]);
+		diffcheck_PrintStats (&result->cumulative[stage]);
+		printf ("\n");
+	}
+	printf ("int16 wrap after offset: %u, negative sum_of_sq - mean^2: %u\n\n",
+			result->offset_wraps, result->negative_differences);
+}
+
+
+/* Synthetic inputs that stress the integer widths and shifts */
+typedef enum {
+	CASE_ZERO,
+	CASE_ONE_G,
+	CASE_POSITIVE_FULL_SCALE,
+	CASE_NEGATIVE_FULL_SCALE,
+	CASE_SQUARE,
+	CASE_RAMP,
+	CASE_IMPULSE,
+	CASE_WALK,
+	NUM_CASES
+} synthetic_case_t;
+
+static const char* const case_names[NUM_CASES] = {
+	[CASE_ZERO]					= "constant 0",
+	[CASE_ONE_G]				= "constant 1g on z",
+	[CASE_POSITIVE_FULL_SCALE]	= "constant +full scale",
+	[CASE_NEGATIVE_FULL_SCALE]	= "constant -full scale",
+	[CASE_SQUARE]				= "+-full scale square wave",
+	[CASE_RAMP]					= "full range ramp on x",
+	[CASE_IMPULSE]				= "full scale impulse",
+	[CASE_WALK]					= "2 Hz walk, 1g +- 0.5g",
+};
+
+
+static void diffcheck_Synthesize (synthetic_case_t which, trace_t* trace)
+{
+	trace_Free (trace);
+	trace_Init (trace, TRACE_DEFAULT_RATE_HZ);
+
+	for (uint32_t i = 0; i < SYNTHETIC_SAMPLES; i++) {
+		int32_t x = 0, y = 0, z = 0;
+		switch (which) {
+			case CASE_ZERO:
+				break;
+			case CASE_ONE_G:
+				z = ONE_G;
+				break;
+			case CASE_POSITIVE_FULL_SCALE:
+				x = y = z = FULL_SCALE;
+				break;
+			case CASE_NEGATIVE_FULL_SCALE:
+				x = y = z = -FULL_SCALE - 1;
+				break;
+			case CASE_SQUARE:
+				x = y = z = ((i / 25) & 1) ? FULL_SCALE : -FULL_SCALE - 1;
+				break;
+			case CASE_RAMP:
+				x = -FULL_SCALE - 1 + (int32_t) ((65535ULL * i) / (SYNTHETIC_SAMPLES - 1));
+				z = ONE_G;
+				break;
+			case CASE_IMPULSE:
+				x = y = z = (i == SYNTHETIC_SAMPLES / 2) ? FULL_SCALE : 0;
+				break;
+			case CASE_WALK:
+				z = ONE_G + (int32_t) lround (0.5 * ONE_G * sin (2.0 * M_PI * 2.0 * i / TRACE_DEFAULT_RATE_HZ));
+				break;
+			default:
+				break;
+		}
+		trace_Append (trace, (int16_t) x, (int16_t) y, (int16_t) z, 0);
+	}
+}
+
+
+static void diffcheck_Usage (const char* program)
+{
+	fprintf (stderr,
+			"usage: %s [options] [trace...]\n"
+			"  -s, --synthetic  also run the synthetic edge cases (default with no traces)\n"
+			"  -q, --quiet      only print the total\n"
+			"traces are CSV (x,y,z[,step]) or compact binary (.bin)\n",
+			program);
+}
+
+
+int main (int argc, char** argv)
+{
+	static const struct option long_options[] = {
+		{"synthetic",	no_argument,	NULL, 's'},
+		{"quiet",		no_argument,	NULL, 'q'},
+		{"help",		no_argument,	NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	bool synthetic = false;
+	bool quiet = false;
+
+	int opt;
+	while ((opt = getopt_long (argc, argv, "sqh", long_options, NULL)) != -1) {
+		switch (opt) {
+			case 's':
+				synthetic = true;
+				break;
+			case 'q':
+				quiet = true;
+				break;
+			default:
+				diffcheck_Usage (argv[0]);
+				return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (optind >= argc) {
+		synthetic = true;
+	}
+
+	printf ("ALPHA_SHIFT %d, BIT_SHIFT_SCALE %d, N_SIZE %d, VAR_SCALING %d\n\n",
+			ALPHA_SHIFT, BIT_SHIFT_SCALE, N_SIZE, VAR_SCALING);
+
+	diff_result_t total;
+	diff_result_t result;
+	memset (&total, 0, sizeof(total));
+	trace_t trace;
+	trace_Init (&trace, TRACE_DEFAULT_RATE_HZ);
+	int runs = 0;
+
+	for (int i = optind; i < argc; i++, runs++) {
+		if (trace_Load (argv[i], &trace) != 0) {
+			return 2;
+		}
+		diffcheck_Run (&trace, &result);
+		if (!quiet) {
+			diffcheck_Print (argv[i], &result);
+		}
+		diffcheck_Accumulate (&total, &result);
+	}
+
+	for (int which = 0; synthetic && which < NUM_CASES; which++, runs++) {
+		diffcheck_Synthesize (which, &trace);
+		diffcheck_Run (&trace, &result);
+		if (!quiet) {
+			diffcheck_Print (case_names[which], &result);
+		}
+		diffcheck_Accumulate (&total, &result);
+	}
+	trace_Free (&trace);
+
+	if (runs > 1 || quiet) {
+		diffcheck_Print ("TOTAL (max|err| sample is within its own run)", &total);
+	}
+	return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * fontconv.c
+ *
+ * Converts fonts from Core/Src/ssd1306_fonts.c, which store each glyph
+ * row-major as left-aligned 16-bit rows, into page-major C source for
+ * SSD1306_PageFont_t: per glyph, one row of column bytes for each 8-pixel
+ * page, bit 0 at the top, the layout of the SSD1306 screenbuffer. Only
+ * the characters given are kept. The Makefile runs it to generate
+ * Core/Src/ssd1306_page_fonts.c with the characters the UI draws.
+ *
+ *   fontconv -c CHARACTERS [-o out.c] FONT...     FONT is e.g. 7x10
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "ssd1306_fonts.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <getopt.h>
+
+#define FIRST_CHAR		' '
+#define LAST_CHAR		'~'
+#define NUM_CHARS		(LAST_CHAR - FIRST_CHAR + 1)
+#define MAX_PAGES		4		// 32 rows in a uint32_t column
+
+typedef struct {
+	const char* name;
+	const SSD1306_Font_t* font;
+} fontconv_font_t;
+
+static const fontconv_font_t fonts[] = {
+	{"6x8",		&Font_6x8},
+	{"7x10",	&Font_7x10},
+	{"11x18",	&Font_11x18},
+	{"16x15",	&Font_16x15},
+	{"16x24",	&Font_16x24},
+	{"16x26",	&Font_16x26},
+};
+
+
+static const fontconv_font_t* fontconv_Find (const char* name)
+{
+	for (size_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+		if (strcmp (fonts[i].name, name) == 0) {
+			return &fonts[i];
+		}
+	}
+	return NULL;
+}
+
+
+/* The characters to keep, in character order and without repeats; 0 if one is not printable */
+static int fontconv_Subset (const char* characters, uint8_t* keep)
+{
+	memset (keep, 0, NUM_CHARS);
+	for (const char* c = characters; *c; c++) {
+		if (*c < FIRST_CHAR || *c > LAST_CHAR) {
+			fprintf (stderr, "character 0x%02x has no glyph\n", (unsigned char) *c);
+			return 0;
+		}
+		keep[*c - FIRST_CHAR] = 1;
+	}
+	return 1;
+}
+
+
+/* One glyph's pages, each a row of column bytes */
+static void fontconv_Glyph (const SSD1306_Font_t* font, char c, uint8_t* out)
+{
+	const uint16_t* rows = &font->data[(c - FIRST_CHAR) * font->height];
+	uint8_t pages = (font->height + 7) / 8;
+
+	memset (out, 0, pages * font->width);
+	for (uint8_t i = 0; i < font->height; i++) {
+		for (uint8_t j = 0; j < font->width; j++) {
+			if (rows[i] & (0x8000 >> j)) {
+				out[(i / 8) * font->width + j] |= 1 << (i % 8);
+			}
+		}
+	}
+}
+
+
+static void fontconv_Write (FILE* out, const fontconv_font_t* entry, const uint8_t* keep)
+{
+	const SSD1306_Font_t* font = entry->font;
+	uint8_t pages = (font->height + 7) / 8;
+	uint8_t glyph[MAX_PAGES * 16];
+	unsigned count = 0;
+
+	fprintf (out, "static const uint8_t PageFont%s_data[] = {\n", entry->name);
+	for (char c = FIRST_CHAR; c <= LAST_CHAR; c++) {
+		if (!keep[c - FIRST_CHAR]) {
+			continue;
+		}
+		fontconv_Glyph (font, c, glyph);
+		fprintf (out, "\t");
+		for (unsigned i = 0; i < pages * font->width; i++) {
+			fprintf (out, "0x%02X,%s", glyph[i], i + 1 < pages * font->width ? " " : "");
+		}
+		fprintf (out, "  // '%c'\n", c);
+		count++;
+	}
+	fprintf (out, "};\n\n");
+
+	fprintf (out, "static const uint8_t PageFont%s_index[] = {", entry->name);
+	unsigned glyph_number = 0;
+	for (unsigned i = 0; i < NUM_CHARS; i++) {
+		fprintf (out, "%s", i % 8 == 0 ? "\n\t" : " ");
+		if (keep[i]) {
+			fprintf (out, "%u,", glyph_number++);
+		} else {
+			fprintf (out, "SSD1306_NO_GLYPH,");
+		}
+	}
+	fprintf (out, "\n};\n\n");
+
+	fprintf (out, "const SSD1306_PageFont_t PageFont_%s = {%u, %u, PageFont%s_index, PageFont%s_data};\n\n",
+			entry->name, font->width, font->height, entry->name, entry->name);
+
+	fprintf (stderr, "%s: %u glyphs, %u bytes (%u as %u row-major glyphs)\n", entry->name, count,
+			count * pages * font->width + NUM_CHARS, NUM_CHARS * font->height * 2, NUM_CHARS);
+}
+
+
+int main (int argc, char** argv)
+{
+	const char* characters = NULL;
+	const char* path = NULL;
+	uint8_t keep[NUM_CHARS];
+	int option;
+
+	while ((option = getopt (argc, argv, "c:o:")) != -1) {
+		switch (option) {
+			case 'c':
+				characters = optarg;
+				break;
+			case 'o':
+				path = optarg;
+				break;
+			default:
+				characters = NULL;
+				optind = argc;
+				break;
+		}
+	}
+	if (characters == NULL || optind == argc) {
+		fprintf (stderr, "usage: %s -c CHARACTERS [-o out.c] FONT...\n", argv[0]);
+		return 2;
+	}
+	if (!fontconv_Subset (characters, keep)) {
+		return 1;
+	}
+
+	for (int i = optind; i < argc; i++) {
+		const fontconv_font_t* entry = fontconv_Find (argv[i]);
+		if (entry == NULL) {
+			fprintf (stderr, "no font %s\n", argv[i]);
+			return 1;
+		}
+		if ((entry->font->height + 7) / 8 > MAX_PAGES || entry->font->char_width != NULL) {
+			fprintf (stderr, "font %s is too tall or proportional\n", argv[i]);
+			return 1;
+		}
+	}
+
+	FILE* out = stdout;
+	if (path != NULL) {
+		out = fopen (path, "w");
+		if (out == NULL) {
+			perror (path);
+			return 1;
+		}
+	}
+
+	fprintf (out, "/*\n * ssd1306_page_fonts.c\n *\n");
+	fprintf (out, " * Generated by Tools/host/fontconv from ssd1306_fonts.c, do not edit.\n");
+	fprintf (out, " * Characters: \"%s\"\n */\n\n", characters);
+	fprintf (out, "#include \"ssd1306_fonts.h\"\n\n");
+	for (int i = optind; i < argc; i++) {
+		fontconv_Write (out, fontconv_Find (argv[i]), keep);
+	}
+
+	if (out != stdout) {
+		fclose (out);
+	}
+	return 0;
+}
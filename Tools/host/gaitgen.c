@@ -0,0 +1,514 @@
+/*
+ * gaitgen.c
+ *
+ * Synthetic accelerometer traces with ground-truth step labels.
+ *
+ * Produces raw LSM6DS readings (+-2 g, 0.061 mg/LSB, X_OFFSET etc. already
+ * removed, clipped to int16_t) as imu_ReadRawData would decode them, in any
+ * format trace_io.c writes. The trace is a random sequence of activity
+ * segments:
+ *  - walk     steps at a cadence and amplitude drawn per segment, with
+ *             step to step jitter, heel-strike transients and optional
+ *             arm swing; every heel strike is labelled
+ *  - still    gravity plus slow postural sway
+ *  - vehicle  engine vibration and low-pass road noise, no steps
+ *  - arm      arm swinging or gesturing without walking, no steps
+ * The body frame (x forward, y left, z up) is rotated into the sensor
+ * frame by the roll/pitch/yaw orientation, then sensor noise is added.
+ *
+ * Output is fully determined by the options and the seed.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "trace_io.h"
+#include "task_read_imu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <getopt.h>
+
+#define LSB_PER_G			16393.0		// 0.061 mg/LSB at +-2 g
+#define MIN_SEGMENT_S		10.0
+#define MAX_SEGMENT_S		300.0
+#define HEEL_STRIKE_HZ		12.0
+#define HEEL_STRIKE_TAU_S	0.04
+#define ROAD_CUTOFF_HZ		2.0
+
+typedef enum {
+	ACTIVITY_WALK,
+	ACTIVITY_STILL,
+	ACTIVITY_VEHICLE,
+	ACTIVITY_ARM,
+	NUM_ACTIVITIES
+} activity_t;
+
+typedef struct {
+	double duration_s;
+	uint16_t rate_hz;
+	double cadence_spm;			// steps per minute
+	double cadence_spread_spm;	// segment cadence drawn from cadence +- spread
+	double cadence_jitter;		// step to step period variation, fraction (1 sigma)
+	double amplitude_g;			// vertical walking amplitude
+	double arm_swing_g;			// arm swing added while walking
+	double noise_g;				// sensor noise, rms per axis
+	double vibration_g;			// vehicle vibration, rms
+	double fraction[NUM_ACTIVITIES];
+	double roll_deg;
+	double pitch_deg;
+	double yaw_deg;
+	bool random_orientation;	// new orientation for every segment
+	uint64_t seed;
+} gaitgen_options_t;
+
+typedef struct {
+	uint64_t state;
+} gaitgen_rng_t;
+
+typedef struct {
+	double r[3][3];
+} rotation_t;
+
+typedef struct {
+	const gaitgen_options_t* options;
+	gaitgen_rng_t rng;
+	rotation_t rotation;
+	trace_t* trace;
+	double dt;
+	double road[3];				// low-pass road noise state
+} gaitgen_t;
+
+
+/* splitmix64, small and good enough for signal generation */
+static uint64_t gaitgen_Next (gaitgen_rng_t* rng)
+{
+	uint64_t z = (rng->state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+
+/* Uniform in [0, 1) */
+static double gaitgen_Uniform (gaitgen_rng_t* rng)
+{
+	return (gaitgen_Next (rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+static double gaitgen_Range (gaitgen_rng_t* rng, double low, double high)
+{
+	return low + (high - low) * gaitgen_Uniform (rng);
+}
+
+
+/* Standard normal, Box-Muller */
+static double gaitgen_Gaussian (gaitgen_rng_t* rng)
+{
+	double u1 = 1.0 - gaitgen_Uniform (rng);
+	double u2 = gaitgen_Uniform (rng);
+	return sqrt (-2.0 * log (u1)) * cos (2.0 * M_PI * u2);
+}
+
+
+/* Body to sensor rotation, z-y-x (yaw, pitch, roll) */
+static void gaitgen_SetRotation (rotation_t* rotation, double roll_deg, double pitch_deg, double yaw_deg)
+{
+	double cr = cos (roll_deg * M_PI / 180.0), sr = sin (roll_deg * M_PI / 180.0);
+	double cp = cos (pitch_deg * M_PI / 180.0), sp = sin (pitch_deg * M_PI / 180.0);
+	double cy = cos (yaw_deg * M_PI / 180.0), sy = sin (yaw_deg * M_PI / 180.0);
+
+	double r[3][3] = {
+		{cy * cp,	cy * sp * sr - sy * cr,	cy * sp * cr + sy * sr},
+		{sy * cp,	sy * sp * sr + cy * cr,	sy * sp * cr - cy * sr},
+		{-sp,		cp * sr,				cp * cr},
+	};
+	memcpy (rotation->r, r, sizeof(r));
+}
+
+
+static int16_t gaitgen_ToRaw (double g, int32_t offset)
+{
+	double counts = round (g * LSB_PER_G) - offset;
+	if (counts > INT16_MAX) {
+		return INT16_MAX;
+	}
+	if (counts < INT16_MIN) {
+		return INT16_MIN;
+	}
+	return (int16_t) counts;
+}
+
+
+/* Add gravity, rotate into the sensor frame, add noise and store */
+static int gaitgen_Emit (gaitgen_t* gen, const double* body, uint8_t step)
+{
+	double frame[3] = {body[0], body[1], body[2] + 1.0};
+	double sensor[3];
+
+	for (int i = 0; i < 3; i++) {
+		sensor[i] = gen->rotation.r[i][0] * frame[0]
+				+ gen->rotation.r[i][1] * frame[1]
+				+ gen->rotation.r[i][2] * frame[2]
+				+ gen->options->noise_g * gaitgen_Gaussian (&gen->rng);
+	}
+
+	return trace_Append (gen->trace,
+			gaitgen_ToRaw (sensor[0], X_OFFSET),
+			gaitgen_ToRaw (sensor[1], Y_OFFSET),
+			gaitgen_ToRaw (sensor[2], Z_OFFSET), step);
+}
+
+
+static int gaitgen_Walk (gaitgen_t* gen, uint32_t samples)
+{
+	const gaitgen_options_t* options = gen->options;
+	double cadence = gaitgen_Range (&gen->rng, options->cadence_spm - options->cadence_spread_spm,
+			options->cadence_spm + options->cadence_spread_spm);
+	double amplitude = options->amplitude_g * gaitgen_Range (&gen->rng, 0.75, 1.25);
+	double mean_period = 60.0 / (cadence > 1.0 ? cadence : 1.0);
+
+	double period = mean_period;
+	double since_strike = 0.0;
+	uint32_t step_index = 0;
+	bool strike = true;
+
+	for (uint32_t i = 0; i < samples; i++) {
+		if (since_strike >= period) {
+			since_strike -= period;
+			step_index++;
+			strike = true;
+			period = mean_period * (1.0 + options->cadence_jitter * gaitgen_Gaussian (&gen->rng));
+			if (period < 0.5 * mean_period) {
+				period = 0.5 * mean_period;
+			}
+		}
+
+		double phase = since_strike / period;				// 0 at heel strike
+		double stride = ((step_index & 1) + phase) / 2.0;	// left + right step
+		double impact = exp (-since_strike / HEEL_STRIKE_TAU_S)
+				* cos (2.0 * M_PI * HEEL_STRIKE_HZ * since_strike);
+
+		double body[3];
+		body[0] = 0.5 * amplitude * sin (2.0 * M_PI * phase - 0.6)
+				+ options->arm_swing_g * sin (2.0 * M_PI * stride);
+		body[1] = 0.35 * amplitude * sin (2.0 * M_PI * stride);
+		body[2] = amplitude * (0.55 * cos (2.0 * M_PI * phase) + 0.25 * cos (4.0 * M_PI * phase - 0.8)
+				+ 0.6 * impact)
+				+ 0.25 * options->arm_swing_g * cos (4.0 * M_PI * stride);
+
+		if (gaitgen_Emit (gen, body, strike ? 1 : 0) != 0) {
+			return -1;
+		}
+		strike = false;
+		since_strike += gen->dt;
+	}
+	return 0;
+}
+
+
+static int gaitgen_Still (gaitgen_t* gen, uint32_t samples)
+{
+	double sway_hz = gaitgen_Range (&gen->rng, 0.1, 0.4);
+
+	for (uint32_t i = 0; i < samples; i++) {
+		double t = i * gen->dt;
+		double body[3] = {
+			0.01 * sin (2.0 * M_PI * sway_hz * t),
+			0.01 * cos (2.0 * M_PI * 0.7 * sway_hz * t),
+			0.0,
+		};
+		if (gaitgen_Emit (gen, body, 0) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+
+/* Engine harmonic (aliased at low sample rates) plus low-pass road noise */
+static int gaitgen_Vehicle (gaitgen_t* gen, uint32_t samples)
+{
+	double vibration = gen->options->vibration_g;
+	double engine_hz = gaitgen_Range (&gen->rng, 20.0, 45.0);
+	double alpha = 1.0 - exp (-2.0 * M_PI * ROAD_CUTOFF_HZ * gen->dt);
+	/* keep the filtered noise at roughly the requested rms */
+	double drive = vibration * sqrt ((2.0 - alpha) / alpha);
+
+	for (uint32_t i = 0; i < samples; i++) {
+		double t = i * gen->dt;
+		for (int axis = 0; axis < 3; axis++) {
+			double scale = axis == 2 ? 1.0 : 0.5;
+			gen->road[axis] += alpha * (scale * drive * gaitgen_Gaussian (&gen->rng) - gen->road[axis]);
+		}
+		double engine = 0.3 * vibration * sin (2.0 * M_PI * engine_hz * t);
+		double body[3] = {gen->road[0] + 0.5 * engine, gen->road[1], gen->road[2] + engine};
+		if (gaitgen_Emit (gen, body, 0) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+
+static int gaitgen_Arm (gaitgen_t* gen, uint32_t samples)
+{
+	double arm = gen->options->arm_swing_g > 0.0 ? gen->options->arm_swing_g : 0.3;
+	double swing_hz = gaitgen_Range (&gen->rng, 0.7, 1.5);
+
+	for (uint32_t i = 0; i < samples; i++) {
+		double t = i * gen->dt;
+		double body[3] = {
+			arm * sin (2.0 * M_PI * swing_hz * t),
+			0.2 * arm * sin (2.0 * M_PI * swing_hz * t + 1.0),
+			0.25 * arm * cos (4.0 * M_PI * swing_hz * t),
+		};
+		if (gaitgen_Emit (gen, body, 0) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+
+static activity_t gaitgen_PickActivity (gaitgen_t* gen)
+{
+	double total = 0.0;
+	for (int a = 0; a < NUM_ACTIVITIES; a++) {
+		total += gen->options->fraction[a];
+	}
+
+	double pick = gaitgen_Uniform (&gen->rng) * total;
+	for (int a = 0; a < NUM_ACTIVITIES; a++) {
+		if (pick < gen->options->fraction[a]) {
+			return (activity_t) a;
+		}
+		pick -= gen->options->fraction[a];
+	}
+	return ACTIVITY_WALK;
+}
+
+
+static int gaitgen_Generate (const gaitgen_options_t* options, trace_t* trace, uint32_t* counts)
+{
+	gaitgen_t gen;
+	memset (&gen, 0, sizeof(gen));
+	gen.options = options;
+	gen.rng.state = options->seed;
+	gen.trace = trace;
+	gen.dt = 1.0 / options->rate_hz;
+	gaitgen_SetRotation (&gen.rotation, options->roll_deg, options->pitch_deg, options->yaw_deg);
+
+	uint64_t total = (uint64_t) llround (options->duration_s * options->rate_hz);
+	if (total > UINT32_MAX) {
+		fprintf (stderr, "gaitgen: more than 2^32 samples, shorten the duration\n");
+		return -1;
+	}
+
+	while (trace->count < total) {
+		activity_t activity = gaitgen_PickActivity (&gen);
+		uint64_t samples = (uint64_t) (gaitgen_Range (&gen.rng, MIN_SEGMENT_S, MAX_SEGMENT_S) * options->rate_hz);
+		if (samples > total - trace->count) {
+			samples = total - trace->count;
+		}
+		if (options->random_orientation) {
+			gaitgen_SetRotation (&gen.rotation, gaitgen_Range (&gen.rng, -180.0, 180.0),
+					gaitgen_Range (&gen.rng, -90.0, 90.0), gaitgen_Range (&gen.rng, -180.0, 180.0));
+		}
+
+		int result;
+		switch (activity) {
+			case ACTIVITY_STILL:
+				result = gaitgen_Still (&gen, (uint32_t) samples);
+				break;
+			case ACTIVITY_VEHICLE:
+				result = gaitgen_Vehicle (&gen, (uint32_t) samples);
+				break;
+			case ACTIVITY_ARM:
+				result = gaitgen_Arm (&gen, (uint32_t) samples);
+				break;
+			default:
+				result = gaitgen_Walk (&gen, (uint32_t) samples);
+				break;
+		}
+		if (result != 0) {
+			fprintf (stderr, "gaitgen: out of memory\n");
+			return -1;
+		}
+		counts[activity] += (uint32_t) samples;
+	}
+	return 0;
+}
+
+
+/* Seconds, or a number followed by s, m, h or d */
+static double gaitgen_ParseDuration (const char* text)
+{
+	char* end;
+	double value = strtod (text, &end);
+	switch (*end) {
+		case 'm':
+			return value * 60.0;
+		case 'h':
+			return value * 3600.0;
+		case 'd':
+			return value * 86400.0;
+		default:
+			return value;
+	}
+}
+
+
+static void gaitgen_Usage (const char* program)
+{
+	fprintf (stderr,
+			"usage: %s [options] output.{csv,bin}\n"
+			"  -d, --duration T          length, seconds or with s/m/h/d suffix (default 10m)\n"
+			"  -r, --rate HZ             sample rate (default %d)\n"
+			"  -c, --cadence SPM         mean cadence, steps per minute (default 110)\n"
+			"      --cadence-spread SPM  per segment cadence range +- SPM (default 20)\n"
+			"      --cadence-jitter F    step period variation, 1 sigma fraction (default 0.03)\n"
+			"  -a, --amplitude G         vertical walking amplitude (default 0.35)\n"
+			"      --arm-swing G         arm swing while walking (default 0)\n"
+			"  -n, --noise G             sensor noise rms per axis (default 0.005)\n"
+			"      --vibration G         vehicle vibration rms (default 0.05)\n"
+			"      --still F             fraction of time standing still (default 0.2)\n"
+			"      --vehicle F           fraction of time in a vehicle (default 0)\n"
+			"      --arm F               fraction of time moving the arm without walking (default 0)\n"
+			"      --orientation R,P,Y   sensor roll,pitch,yaw in degrees (default 0,0,0)\n"
+			"      --random-orientation  new random orientation every segment\n"
+			"  -s, --seed N              random seed (default 1)\n",
+			program, TRACE_DEFAULT_RATE_HZ);
+}
+
+
+int main (int argc, char** argv)
+{
+	enum {
+		OPT_CADENCE_SPREAD = 256, OPT_CADENCE_JITTER, OPT_ARM_SWING, OPT_VIBRATION,
+		OPT_STILL, OPT_VEHICLE, OPT_ARM, OPT_ORIENTATION, OPT_RANDOM_ORIENTATION
+	};
+	static const struct option long_options[] = {
+		{"duration",			required_argument,	NULL, 'd'},
+		{"rate",				required_argument,	NULL, 'r'},
+		{"cadence",				required_argument,	NULL, 'c'},
+		{"cadence-spread",		required_argument,	NULL, OPT_CADENCE_SPREAD},
+		{"cadence-jitter",		required_argument,	NULL, OPT_CADENCE_JITTER},
+		{"amplitude",			required_argument,	NULL, 'a'},
+		{"arm-swing",			required_argument,	NULL, OPT_ARM_SWING},
+		{"noise",				required_argument,	NULL, 'n'},
+		{"vibration",			required_argument,	NULL, OPT_VIBRATION},
+		{"still",				required_argument,	NULL, OPT_STILL},
+		{"vehicle",				required_argument,	NULL, OPT_VEHICLE},
+		{"arm",					required_argument,	NULL, OPT_ARM},
+		{"orientation",			required_argument,	NULL, OPT_ORIENTATION},
+		{"random-orientation",	no_argument,		NULL, OPT_RANDOM_ORIENTATION},
+		{"seed",				required_argument,	NULL, 's'},
+		{"help",				no_argument,		NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	gaitgen_options_t options = {
+		.duration_s = 600.0,
+		.rate_hz = TRACE_DEFAULT_RATE_HZ,
+		.cadence_spm = 110.0,
+		.cadence_spread_spm = 20.0,
+		.cadence_jitter = 0.03,
+		.amplitude_g = 0.35,
+		.arm_swing_g = 0.0,
+		.noise_g = 0.005,
+		.vibration_g = 0.05,
+		.fraction = {
+			[ACTIVITY_STILL] = 0.2,
+			[ACTIVITY_VEHICLE] = 0.0,
+			[ACTIVITY_ARM] = 0.0,
+		},
+		.seed = 1,
+	};
+
+	int opt;
+	while ((opt = getopt_long (argc, argv, "d:r:c:a:n:s:h", long_options, NULL)) != -1) {
+		switch (opt) {
+			case 'd':
+				options.duration_s = gaitgen_ParseDuration (optarg);
+				break;
+			case 'r':
+				options.rate_hz = (uint16_t) strtoul (optarg, NULL, 10);
+				break;
+			case 'c':
+				options.cadence_spm = strtod (optarg, NULL);
+				break;
+			case OPT_CADENCE_SPREAD:
+				options.cadence_spread_spm = strtod (optarg, NULL);
+				break;
+			case OPT_CADENCE_JITTER:
+				options.cadence_jitter = strtod (optarg, NULL);
+				break;
+			case 'a':
+				options.amplitude_g = strtod (optarg, NULL);
+				break;
+			case OPT_ARM_SWING:
+				options.arm_swing_g = strtod (optarg, NULL);
+				break;
+			case 'n':
+				options.noise_g = strtod (optarg, NULL);
+				break;
+			case OPT_VIBRATION:
+				options.vibration_g = strtod (optarg, NULL);
+				break;
+			case OPT_STILL:
+				options.fraction[ACTIVITY_STILL] = strtod (optarg, NULL);
+				break;
+			case OPT_VEHICLE:
+				options.fraction[ACTIVITY_VEHICLE] = strtod (optarg, NULL);
+				break;
+			case OPT_ARM:
+				options.fraction[ACTIVITY_ARM] = strtod (optarg, NULL);
+				break;
+			case OPT_ORIENTATION:
+				if (sscanf (optarg, "%lf,%lf,%lf", &options.roll_deg, &options.pitch_deg, &options.yaw_deg) != 3) {
+					gaitgen_Usage (argv[0]);
+					return 2;
+				}
+				break;
+			case OPT_RANDOM_ORIENTATION:
+				options.random_orientation = true;
+				break;
+			case 's':
+				options.seed = strtoull (optarg, NULL, 0);
+				break;
+			default:
+				gaitgen_Usage (argv[0]);
+				return opt == 'h' ? 0 : 2;
+		}
+	}
+
+	/* walking takes whatever time the other activities leave */
+	double other = options.fraction[ACTIVITY_STILL] + options.fraction[ACTIVITY_VEHICLE]
+			+ options.fraction[ACTIVITY_ARM];
+	options.fraction[ACTIVITY_WALK] = other < 1.0 ? 1.0 - other : 0.0;
+
+	if (optind != argc - 1 || options.rate_hz == 0 || options.duration_s <= 0.0) {
+		gaitgen_Usage (argv[0]);
+		return 2;
+	}
+
+	trace_t trace;
+	uint32_t counts[NUM_ACTIVITIES] = {0};
+	trace_Init (&trace, options.rate_hz);
+	if (gaitgen_Generate (&options, &trace, counts) != 0 || trace_Save (argv[optind], &trace) != 0) {
+		trace_Free (&trace);
+		return 1;
+	}
+
+	fprintf (stderr, "gaitgen: %u samples (%.1f h), %u steps; walk %.0f%%, still %.0f%%, vehicle %.0f%%, arm %.0f%%\n",
+			trace.count, trace.count / (3600.0 * options.rate_hz), trace_StepCountGetter (&trace),
+			100.0 * counts[ACTIVITY_WALK] / trace.count, 100.0 * counts[ACTIVITY_STILL] / trace.count,
+			100.0 * counts[ACTIVITY_VEHICLE] / trace.count, 100.0 * counts[ACTIVITY_ARM] / trace.count);
+	trace_Free (&trace);
+	return 0;
+}
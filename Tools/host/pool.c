@@ -0,0 +1,163 @@
+/*
+ * pool.c
+ *
+ * Every worker owns a deque of job indices, dealt out round-robin.
+ * Owners take from the bottom of their own deque, idle workers steal
+ * from the top of someone else's, so uneven job costs (e.g. a config
+ * that still has to be compiled) balance out without a central queue.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "pool.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+	pthread_mutex_t lock;
+	uint32_t* jobs;
+	uint32_t top;		// next job to steal
+	uint32_t bottom;	// one past the next job for the owner
+} pool_deque_t;
+
+typedef struct pool pool_t;
+
+typedef struct {
+	pool_t* pool;
+	unsigned index;
+	pthread_t thread;
+} pool_worker_t;
+
+struct pool {
+	pool_deque_t* deques;
+	pool_worker_t* workers;
+	unsigned num_threads;
+	pool_job_t job;
+	void* context;
+};
+
+
+static bool pool_PopBottom (pool_deque_t* deque, uint32_t* job)
+{
+	bool found = false;
+	pthread_mutex_lock (&deque->lock);
+	if (deque->bottom > deque->top) {
+		*job = deque->jobs[--deque->bottom];
+		found = true;
+	}
+	pthread_mutex_unlock (&deque->lock);
+	return found;
+}
+
+
+static bool pool_StealTop (pool_deque_t* deque, uint32_t* job)
+{
+	bool found = false;
+	pthread_mutex_lock (&deque->lock);
+	if (deque->bottom > deque->top) {
+		*job = deque->jobs[deque->top++];
+		found = true;
+	}
+	pthread_mutex_unlock (&deque->lock);
+	return found;
+}
+
+
+static void* pool_Worker (void* argument)
+{
+	pool_worker_t* worker = argument;
+	pool_t* pool = worker->pool;
+	uint32_t job;
+
+	for (;;) {
+		if (pool_PopBottom (&pool->deques[worker->index], &job)) {
+			pool->job (job, pool->context);
+			continue;
+		}
+
+		/* own deque empty, try everyone else starting with the next worker */
+		bool stolen = false;
+		for (unsigned i = 1; i < pool->num_threads && !stolen; i++) {
+			unsigned victim = (worker->index + i) % pool->num_threads;
+			stolen = pool_StealTop (&pool->deques[victim], &job);
+		}
+		if (!stolen) {
+			break; // no job is ever added, so nothing left anywhere
+		}
+		pool->job (job, pool->context);
+	}
+	return NULL;
+}
+
+
+int pool_Run (uint32_t num_jobs, unsigned num_threads, pool_job_t job, void* context)
+{
+	if (num_threads == 0) {
+		num_threads = 1;
+	}
+
+	pool_t pool = {
+		.deques = calloc (num_threads, sizeof(pool_deque_t)),
+		.workers = calloc (num_threads, sizeof(pool_worker_t)),
+		.num_threads = num_threads,
+		.job = job,
+		.context = context,
+	};
+	uint32_t* jobs = malloc ((num_jobs + 1) * sizeof(uint32_t));
+	if (!pool.deques || !pool.workers || !jobs) {
+		free (pool.deques);
+		free (pool.workers);
+		free (jobs);
+		return -1;
+	}
+
+	/* deal jobs round-robin into contiguous per-worker slices */
+	uint32_t next = 0;
+	for (unsigned w = 0; w < num_threads; w++) {
+		pool_deque_t* deque = &pool.deques[w];
+		pthread_mutex_init (&deque->lock, NULL);
+		deque->jobs = &jobs[next];
+		for (uint32_t j = w; j < num_jobs; j += num_threads) {
+			jobs[next++] = j;
+		}
+		deque->top = 0;
+		deque->bottom = (uint32_t) (&jobs[next] - deque->jobs);
+	}
+
+	unsigned started = 0;
+	for (; started < num_threads; started++) {
+		pool.workers[started].pool = &pool;
+		pool.workers[started].index = started;
+		if (pthread_create (&pool.workers[started].thread, NULL, pool_Worker, &pool.workers[started]) != 0) {
+			break;
+		}
+	}
+	/* if a thread failed to start, the others steal its jobs */
+	for (unsigned w = 0; w < started; w++) {
+		pthread_join (pool.workers[w].thread, NULL);
+	}
+	if (started == 0) {
+		for (uint32_t j = 0; j < num_jobs; j++) {
+			job (j, context);
+		}
+	}
+
+	for (unsigned w = 0; w < num_threads; w++) {
+		pthread_mutex_destroy (&pool.deques[w].lock);
+	}
+	free (pool.deques);
+	free (pool.workers);
+	free (jobs);
+	return 0;
+}
+
+
+unsigned pool_DefaultThreads (void)
+{
+	long cores = sysconf (_SC_NPROCESSORS_ONLN);
+	return cores > 0 ? (unsigned) cores : 1;
+}
@@ -0,0 +1,22 @@
+/*
+ * pool.h
+ *
+ * Work-stealing thread pool for the host tools
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stdint.h>
+
+typedef void (*pool_job_t)(uint32_t job, void* context);
+
+/* Run job(0 .. num_jobs-1) across num_threads workers, returns when all are done */
+int pool_Run (uint32_t num_jobs, unsigned num_threads, pool_job_t job, void* context);
+
+unsigned pool_DefaultThreads (void);
+
+#endif /* POOL_H_ */
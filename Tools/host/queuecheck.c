@@ -0,0 +1,244 @@
+/*
+ * queuecheck.c
+ *
+ * Checks the display driver's transmit queue. The I2C calls below stand in
+ * for the HAL; a DMA transfer stays on the bus until the check completes
+ * it, so commands queue up and join entries that have not started. Every
+ * command byte the driver accepted must reach the bus once, in order, and
+ * every data transfer must be the buffer it was given.
+ *
+ * The first case fills commandBytes exactly to its end behind a command
+ * entry that is queued but not started, then writes more commands, which
+ * go to the start of commandBytes and must not join that entry. A long
+ * run of random writes and completions follows.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "ssd1306.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define DEFAULT_STEPS		200000
+#define SENT_SIZE			4096	// command bytes compared per round, the check waits for the bus first
+#define MAX_WRITE			12		// longest command write in the random run
+#define DATA_SIZE			16
+
+I2C_HandleTypeDef hi2c1;
+
+/* The transaction on the bus */
+static uint8_t on_bus = 0;
+static uint8_t bus_control;
+static uint8_t* bus_data;
+static uint16_t bus_size;
+
+/* Command bytes accepted by the driver, and those that reached the bus */
+static uint8_t accepted[SENT_SIZE];
+static uint16_t accepted_count = 0;
+static uint8_t sent[SENT_SIZE];
+static uint16_t sent_count = 0;
+
+/* Data transfers queued, and the next one expected on the bus */
+static uint8_t data_buffers[SSD1306_QUEUE_SIZE][DATA_SIZE];
+static uint8_t data_queued = 0;
+static uint8_t data_sent = 0;
+
+static unsigned failures = 0;
+
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write (I2C_HandleTypeDef* hi2c, uint16_t address, uint16_t mem_address,
+		uint16_t mem_size, uint8_t* data, uint16_t size, uint32_t timeout)
+{
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA (I2C_HandleTypeDef* hi2c, uint16_t address, uint16_t mem_address,
+		uint16_t mem_size, uint8_t* data, uint16_t size)
+{
+	if (on_bus) {
+		printf ("FAIL: a transfer started while one was on the bus\n");
+		failures++;
+		return HAL_BUSY;
+	}
+	on_bus = 1;
+	bus_control = mem_address;
+	bus_data = data;
+	bus_size = size;
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_I2C_Init (I2C_HandleTypeDef* hi2c)
+{
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_I2C_DeInit (I2C_HandleTypeDef* hi2c)
+{
+	return HAL_OK;
+}
+
+
+void HAL_Delay (uint32_t delay)
+{
+}
+
+
+/* No transfer is held long enough to time out */
+uint32_t timebase_Micros32Getter (void)
+{
+	return 0;
+}
+
+
+/* The completions below stand in for the interrupt, so nothing needs masking */
+void __disable_irq (void)
+{
+}
+
+
+uint32_t __get_PRIMASK (void)
+{
+	return 0;
+}
+
+
+void __set_PRIMASK (uint32_t primask)
+{
+}
+
+
+void app_Wake (void)
+{
+}
+
+
+void trace_Record (uint8_t type, uint8_t id, uint16_t arg)
+{
+}
+
+
+/* Take the transaction off the bus, as its DMA completing would */
+static uint8_t queuecheck_Complete (void)
+{
+	if (!on_bus) {
+		return 0;
+	}
+	on_bus = 0;
+	if (bus_control == 0x00) {
+		if (sent_count + bus_size > SENT_SIZE) {
+			printf ("FAIL: %u command bytes on the bus, more than were written\n", sent_count + bus_size);
+			failures++;
+		} else {
+			memcpy (&sent[sent_count], bus_data, bus_size);
+			sent_count += bus_size;
+		}
+	} else if (bus_data != data_buffers[data_sent % SSD1306_QUEUE_SIZE] || bus_size != DATA_SIZE) {
+		printf ("FAIL: data transfer %u is not the buffer queued\n", data_sent);
+		failures++;
+	} else {
+		data_sent++;
+	}
+	HAL_I2C_MemTxCpltCallback (&hi2c1);
+	return 1;
+}
+
+
+static void queuecheck_Commands (uint16_t count, uint8_t first)
+{
+	uint8_t bytes[SSD1306_COMMAND_BYTES];
+
+	for (uint16_t i = 0; i < count; i++) {
+		bytes[i] = first + i;
+	}
+	if (ssd1306_WriteCommands (bytes, count) == SSD1306_OK) {
+		memcpy (&accepted[accepted_count], bytes, count);
+		accepted_count += count;
+	}
+}
+
+
+static void queuecheck_Data (void)
+{
+	if (ssd1306_WriteData (data_buffers[data_queued % SSD1306_QUEUE_SIZE], DATA_SIZE) == SSD1306_OK) {
+		data_queued++;
+	}
+}
+
+
+/* Empty the bus and compare what reached it with what the driver accepted */
+static void queuecheck_Drain (const char* name)
+{
+	while (queuecheck_Complete ()) {
+	}
+	if (sent_count != accepted_count || memcmp (sent, accepted, sent_count) != 0 || data_sent != data_queued) {
+		printf ("FAIL: %s: %u command bytes accepted, %u sent%s, %u data transfers queued, %u sent\n", name,
+				accepted_count, sent_count, memcmp (sent, accepted, sent_count) != 0 ? " differently" : "",
+				data_queued, data_sent);
+		failures++;
+	}
+	accepted_count = 0;
+	sent_count = 0;
+	data_queued = 0;
+	data_sent = 0;
+}
+
+
+/*
+ * Commands ending exactly at the end of commandBytes, in an entry waiting
+ * behind data; the next commands start over at its beginning
+ */
+static void queuecheck_Wrap (void)
+{
+	queuecheck_Commands (10, 0x10);		// on the bus
+	queuecheck_Data ();
+	queuecheck_Commands (40, 0x40);		// waits behind the data
+	queuecheck_Complete ();				// frees the first 10 bytes, the data goes on the bus
+	queuecheck_Commands (SSD1306_COMMAND_BYTES - 50, 0x80);	// joins, up to the end of commandBytes
+	queuecheck_Commands (4, 0xC0);		// from the start of commandBytes
+	queuecheck_Drain ("commands ending at the end of the buffer");
+}
+
+
+/* Random command and data writes, with transfers completing in between */
+static void queuecheck_Random (unsigned steps)
+{
+	srand (1);
+	for (unsigned step = 0; step < steps; step++) {
+		int choice = rand () % 8;
+		if (choice < 4) {
+			queuecheck_Commands (1 + rand () % MAX_WRITE, rand ());
+		} else if (choice < 5) {
+			queuecheck_Data ();
+		} else {
+			queuecheck_Complete ();
+		}
+		if (accepted_count > SENT_SIZE - MAX_WRITE) {
+			queuecheck_Drain ("random writes");
+		}
+	}
+	queuecheck_Drain ("random writes");
+}
+
+
+int main (int argc, char** argv)
+{
+	unsigned steps = argc > 1 ? strtoul (argv[1], NULL, 0) : DEFAULT_STEPS;
+
+	if (argc > 2 || steps == 0) {
+		fprintf (stderr, "usage: %s [steps]\n", argv[0]);
+		return 2;
+	}
+
+	queuecheck_Wrap ();
+	queuecheck_Random (steps);
+
+	printf ("%s: %u failures\n", failures == 0 ? "PASS" : "FAIL", failures);
+	return failures == 0 ? 0 : 1;
+}
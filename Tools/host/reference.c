@@ -0,0 +1,87 @@
+/*
+ * reference.c
+ *
+ * The step pipeline of task_read_imu.c and filter.c with every shift,
+ * truncation and integer width replaced by double precision arithmetic.
+ *
+ * The formulas are deliberately the firmware's own, including the scaled
+ * variance (sum_of_sq - mean^2) >> VAR_SCALING which subtracts mean^2 once
+ * rather than N_SIZE times, so a comparison only measures rounding,
+ * truncation and overflow, not a change of algorithm.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "reference.h"
+#include "task_read_imu.h"
+
+#include <string.h>
+
+#define ALPHA			(1.0 / (double) (1 << ALPHA_SHIFT))
+#define MAGNITUDE_SCALE	(1.0 / (double) (1 << BIT_SHIFT_SCALE))
+#define VARIANCE_SCALE	(1.0 / (double) (1UL << VAR_SCALING))
+
+
+void reference_Init (reference_t* reference)
+{
+	memset (reference->filtered, 0, sizeof(reference->filtered));
+	reference_WindowInit (&reference->window);
+}
+
+
+/* y[n] = y[n-1] + alpha * (x[n] - y[n-1]) without the >> truncation */
+double reference_IIR (double filtered, double input)
+{
+	return filtered + ALPHA * (input - filtered);
+}
+
+
+double reference_Magnitude (double x, double y, double z)
+{
+	return (x * x + y * y + z * z) * MAGNITUDE_SCALE;
+}
+
+
+void reference_WindowInit (reference_window_t* window)
+{
+	memset (window, 0, sizeof(*window));
+}
+
+
+/* Sums are recomputed every sample so no rounding error can build up */
+void reference_WindowUpdate (reference_window_t* window, double magnitude, reference_sample_t* sample)
+{
+	window->buffer[window->index] = magnitude;
+	window->index = (window->index + 1) % N_SIZE;
+
+	double sum = 0.0;
+	double sum_of_sq = 0.0;
+	for (uint32_t i = 0; i < N_SIZE; i++) {
+		sum += window->buffer[i];
+		sum_of_sq += window->buffer[i] * window->buffer[i];
+	}
+
+	sample->magnitude = magnitude;
+	sample->mean = sum / N_SIZE;
+	sample->unscaled_difference = sum_of_sq - sample->mean * sample->mean;
+	sample->scaled_variance = sample->unscaled_difference * VARIANCE_SCALE;
+}
+
+
+void reference_Execute (reference_t* reference, int16_t raw_x, int16_t raw_y, int16_t raw_z,
+		reference_sample_t* sample)
+{
+	/* no int16_t wrap-around after the offsets */
+	sample->offset[0] = (double) raw_x + X_OFFSET;
+	sample->offset[1] = (double) raw_y + Y_OFFSET;
+	sample->offset[2] = (double) raw_z + Z_OFFSET;
+
+	for (int axis = 0; axis < 3; axis++) {
+		reference->filtered[axis] = reference_IIR (reference->filtered[axis], sample->offset[axis]);
+		sample->filtered[axis] = reference->filtered[axis];
+	}
+
+	double magnitude = reference_Magnitude (sample->filtered[0], sample->filtered[1], sample->filtered[2]);
+	reference_WindowUpdate (&reference->window, magnitude, sample);
+}
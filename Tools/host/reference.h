@@ -0,0 +1,48 @@
+/*
+ * reference.h
+ *
+ * Double precision model of the fixed-point step pipeline
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef REFERENCE_H_
+#define REFERENCE_H_
+
+#include "filter.h"
+
+#include <stdint.h>
+
+/* Running mean and variance of the last N_SIZE magnitudes */
+typedef struct {
+	double buffer[N_SIZE];
+	uint32_t index;
+} reference_window_t;
+
+typedef struct {
+	double filtered[3];
+	reference_window_t window;
+} reference_t;
+
+/* Every intermediate value of one pipeline step */
+typedef struct {
+	double offset[3];		// raw + X_OFFSET etc.
+	double filtered[3];		// IIR output
+	double magnitude;		// (x^2 + y^2 + z^2) / 2^BIT_SHIFT_SCALE
+	double mean;
+	double scaled_variance;
+	double unscaled_difference;	// sum_of_sq - mean^2, must never be negative
+} reference_sample_t;
+
+void reference_Init (reference_t* reference);
+void reference_Execute (reference_t* reference, int16_t raw_x, int16_t raw_y, int16_t raw_z,
+		reference_sample_t* sample);
+
+/* Single stages, so each can be fed from the firmware's own upstream values */
+double reference_IIR (double filtered, double input);
+double reference_Magnitude (double x, double y, double z);
+void reference_WindowInit (reference_window_t* window);
+void reference_WindowUpdate (reference_window_t* window, double magnitude, reference_sample_t* sample);
+
+#endif /* REFERENCE_H_ */
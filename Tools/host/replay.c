@@ -0,0 +1,420 @@
+/*
+ * replay.c
+ *
+ * Streams recorded raw IMU traces through the unmodified step pipeline
+ * (task_read_imu.c -> filter.c -> peak_detection.c -> state_machine.c)
+ * at full host speed and reports:
+ *  - detected steps against the ground-truth labels in the trace
+ *  - step timing error of matched detections
+ *  - time per sample, overall and per pipeline stage
+ *
+ * Each pass runs in a forked child so every trace starts from the
+ * power-on state of the module statics.
+ *
+ * Per-stage timing wraps the calls imu_Execute makes into filter.c
+ * (see WRAP_FLAGS in the Makefile); whatever follows filter_MagnitudeUpdate
+ * is peak detection. Batch mode reports the total only: imu_ProcessBlock
+ * runs a whole block between two probes, so the stages would blur.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "trace_io.h"
+#include "score.h"
+#include "stubs.h"
+#include "task_read_imu.h"
+#include "filter.h"
+#include "peak_detection.h"
+#include "state_machine.h"
+#include "imu_log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define DEFAULT_TOLERANCE_MS	400
+#define DEFAULT_REPEATS			3
+#define CALIBRATION_PROBES		1000000
+
+typedef enum {
+	STAGE_READ,			// LSM6DS register reads + offsets
+	STAGE_IIR,			// filter_IIR
+	STAGE_MAGNITUDE,	// imu_CalcAccMagnitude
+	STAGE_MEAN_VAR,		// filter_MagnitudeUpdate
+	STAGE_PEAK,			// peakDetection_Execute
+	NUM_STAGES
+} stage_t;
+
+static const char* const stage_names[NUM_STAGES] = {
+	[STAGE_READ]		= "read+offset",
+	[STAGE_IIR]			= "iir",
+	[STAGE_MAGNITUDE]	= "magnitude",
+	[STAGE_MEAN_VAR]	= "mean+variance",
+	[STAGE_PEAK]		= "peak detect",
+};
+
+typedef struct {
+	uint32_t samples;
+	score_t score;
+	double ns_per_sample;
+	double stage_ns[NUM_STAGES];
+} replay_result_t;
+
+typedef struct {
+	uint32_t tolerance_ms;
+	int repeats;
+	bool quiet;
+	bool batch;					// imu_ProcessBlock instead of imu_Execute
+	double max_count_error_pct;	// < 0 disables the gate
+	double max_ns_per_sample;	// < 0 disables the gate
+} replay_options_t;
+
+/* Stage probes, only active during the probed pass */
+static bool probes_enabled = false;
+static uint64_t probe_last_ns;
+static uint64_t probe_total_ns[NUM_STAGES];
+
+
+static uint64_t replay_NowNs (void)
+{
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+
+static inline void replay_Probe (stage_t finished_stage)
+{
+	uint64_t now = replay_NowNs ();
+	probe_total_ns[finished_stage] += now - probe_last_ns;
+	probe_last_ns = now;
+}
+
+
+void __real_filter_IIR (int16_t new_x, int16_t new_y, int16_t new_z, int16_t* imu_filtered);
+void __real_filter_MagnitudeUpdate (uint32_t new_mag);
+
+void __wrap_filter_IIR (int16_t new_x, int16_t new_y, int16_t new_z, int16_t* imu_filtered)
+{
+	if (!probes_enabled) {
+		__real_filter_IIR (new_x, new_y, new_z, imu_filtered);
+		return;
+	}
+	replay_Probe (STAGE_READ);
+	__real_filter_IIR (new_x, new_y, new_z, imu_filtered);
+	replay_Probe (STAGE_IIR);
+}
+
+void __wrap_filter_MagnitudeUpdate (uint32_t new_mag)
+{
+	if (!probes_enabled) {
+		__real_filter_MagnitudeUpdate (new_mag);
+		return;
+	}
+	replay_Probe (STAGE_MAGNITUDE);
+	__real_filter_MagnitudeUpdate (new_mag);
+	replay_Probe (STAGE_MEAN_VAR);
+}
+
+
+/* Average cost of one probe, subtracted from every stage */
+static double replay_ProbeOverheadNs (void)
+{
+	uint64_t start = replay_NowNs ();
+	for (int i = 0; i < CALIBRATION_PROBES; i++) {
+		replay_Probe (STAGE_READ);
+	}
+	uint64_t elapsed = replay_NowNs () - start;
+	memset (probe_total_ns, 0, sizeof(probe_total_ns));
+	return (double) elapsed / CALIBRATION_PROBES;
+}
+
+
+/* Push every sample through imu_Execute exactly as the 100 Hz task would */
+static void replay_RunPipeline (const trace_t* trace, bool probed, const replay_options_t* options,
+		replay_result_t* result)
+{
+	uint32_t* detections = malloc ((trace->count + 1) * sizeof(uint32_t));
+	uint32_t num_detections = 0;
+	double probe_overhead_ns = probed ? replay_ProbeOverheadNs () : 0.0;
+
+	memset (result, 0, sizeof(*result));
+	stateMachine_Init ();
+	imu_Init ();
+	probes_enabled = probed;
+
+	uint32_t steps = stateMachine_StepCountGetter ();
+	uint64_t start = replay_NowNs ();
+
+	if (options->batch) {
+		/* straight from the trace columns, no register stubs */
+		uint8_t block_steps[IMU_LOG_BLOCK_SAMPLES];
+		for (uint32_t first = 0; first < trace->count; first += IMU_LOG_BLOCK_SAMPLES) {
+			uint16_t count = (uint16_t) ((trace->count - first) < IMU_LOG_BLOCK_SAMPLES
+					? trace->count - first : IMU_LOG_BLOCK_SAMPLES);
+			imu_ProcessBlock (&trace->x[first], &trace->y[first], &trace->z[first], count, block_steps);
+			for (uint16_t i = 0; i < count; i++) {
+				if (block_steps[i]) {
+					detections[num_detections++] = first + i;
+				}
+			}
+		}
+	} else {
+		for (uint32_t i = 0; i < trace->count; i++) {
+			stubs_SetImuSample (trace->x[i], trace->y[i], trace->z[i]);
+			if (probed) {
+				probe_last_ns = replay_NowNs ();
+			}
+			imu_Execute ();
+			if (probed) {
+				replay_Probe (STAGE_PEAK);
+			}
+
+			uint32_t now_steps = stateMachine_StepCountGetter ();
+			if (now_steps != steps) {
+				detections[num_detections++] = i;
+				steps = now_steps;
+			}
+		}
+	}
+
+	uint64_t elapsed = replay_NowNs () - start;
+	probes_enabled = false;
+
+	result->samples = trace->count;
+	result->ns_per_sample = trace->count ? (double) elapsed / trace->count : 0.0;
+	for (int stage = 0; stage < NUM_STAGES && trace->count; stage++) {
+		double ns = (double) probe_total_ns[stage] / trace->count - probe_overhead_ns;
+		result->stage_ns[stage] = ns > 0.0 ? ns : 0.0;
+	}
+
+	score_Match (trace, detections, num_detections, options->tolerance_ms, &result->score);
+	free (detections);
+}
+
+
+/* Run one pass in a child process so module statics start from reset */
+static int replay_Fork (const trace_t* trace, bool probed, const replay_options_t* options,
+		replay_result_t* result)
+{
+	int fds[2];
+	if (pipe (fds) != 0) {
+		return -1;
+	}
+
+	pid_t pid = fork ();
+	if (pid < 0) {
+		return -1;
+	}
+
+	if (pid == 0) {
+		close (fds[0]);
+		replay_RunPipeline (trace, probed, options, result);
+		ssize_t written = write (fds[1], result, sizeof(*result));
+		_exit (written == (ssize_t) sizeof(*result) ? 0 : 1);
+	}
+
+	close (fds[1]);
+	ssize_t received = read (fds[0], result, sizeof(*result));
+	close (fds[0]);
+
+	int status;
+	waitpid (pid, &status, 0);
+	if (received != (ssize_t) sizeof(*result) || !WIFEXITED (status) || WEXITSTATUS (status) != 0) {
+		return -1;
+	}
+	return 0;
+}
+
+
+static int replay_Trace (const trace_t* trace, const replay_options_t* options, replay_result_t* result)
+{
+	if (replay_Fork (trace, false, options, result) != 0) {
+		return -1;
+	}
+
+	/* best-of-N for the unprobed throughput */
+	for (int i = 1; i < options->repeats; i++) {
+		replay_result_t repeat;
+		if (replay_Fork (trace, false, options, &repeat) != 0) {
+			return -1;
+		}
+		if (repeat.ns_per_sample < result->ns_per_sample) {
+			result->ns_per_sample = repeat.ns_per_sample;
+		}
+	}
+
+	if (options->batch) {
+		return 0;
+	}
+	replay_result_t probed;
+	if (replay_Fork (trace, true, options, &probed) != 0) {
+		return -1;
+	}
+	memcpy (result->stage_ns, probed.stage_ns, sizeof(result->stage_ns));
+	return 0;
+}
+
+
+static void replay_Print (const char* name, const replay_result_t* result, const replay_options_t* options)
+{
+	const score_t* score = &result->score;
+	uint32_t misses = score->labels - score->matched;
+	uint32_t false_steps = score->detected - score->matched;
+
+	printf ("%s\n", name);
+	printf ("  samples %u, labelled steps %u, detected %u (%+.2f%%)\n",
+			result->samples, score->labels, score->detected, score_CountErrorPct (score));
+	printf ("  matched %u, missed %u, false %u, F1 %.4f\n", score->matched, misses, false_steps,
+			score_F1 (score));
+	if (score->matched) {
+		printf ("  timing error: mean %+.1f ms, mean abs %.1f ms, max abs %u ms\n",
+				(double) score->sum_error_ms / score->matched,
+				(double) score->sum_abs_error_ms / score->matched,
+				score->max_abs_error_ms);
+	}
+	printf ("  %.1f ns/sample (%.0fx real time at 100 Hz)\n", result->ns_per_sample,
+			result->ns_per_sample > 0.0 ? 1e7 / result->ns_per_sample : 0.0);
+	if (options->batch) {
+		return;
+	}
+	printf ("  stages ns/sample:");
+	for (int stage = 0; stage < NUM_STAGES; stage++) {
+		printf (" %s %.1f%s", stage_names[stage], result->stage_ns[stage],
+				stage < NUM_STAGES - 1 ? "," : "\n");
+	}
+}
+
+
+/* Accumulate a trace into the corpus totals, weighting time by sample count */
+static void replay_Accumulate (replay_result_t* total, const replay_result_t* result)
+{
+	double samples = (double) total->samples + result->samples;
+	if (samples > 0.0) {
+		total->ns_per_sample = (total->ns_per_sample * total->samples
+				+ result->ns_per_sample * result->samples) / samples;
+		for (int stage = 0; stage < NUM_STAGES; stage++) {
+			total->stage_ns[stage] = (total->stage_ns[stage] * total->samples
+					+ result->stage_ns[stage] * result->samples) / samples;
+		}
+	}
+
+	total->samples += result->samples;
+	score_Accumulate (&total->score, &result->score);
+}
+
+
+static void replay_Usage (const char* program)
+{
+	fprintf (stderr,
+			"usage: %s [options] trace...\n"
+			"  -t, --tolerance MS         step match window (default %d)\n"
+			"  -n, --repeats N            throughput passes, best is kept (default %d)\n"
+			"  -q, --quiet                only print the corpus total\n"
+			"  -b, --batch                feed blocks to imu_ProcessBlock instead of imu_Execute\n"
+			"      --max-count-error PCT  fail if |count error| exceeds PCT\n"
+			"      --max-ns NS            fail if time per sample exceeds NS\n"
+			"traces are CSV (x,y,z[,step]), compact binary (.bin) or columnar log (.sct)\n",
+			program, DEFAULT_TOLERANCE_MS, DEFAULT_REPEATS);
+}
+
+
+int main (int argc, char** argv)
+{
+	enum { OPT_MAX_COUNT_ERROR = 256, OPT_MAX_NS };
+	static const struct option long_options[] = {
+		{"tolerance",		required_argument,	NULL, 't'},
+		{"repeats",			required_argument,	NULL, 'n'},
+		{"quiet",			no_argument,		NULL, 'q'},
+		{"batch",			no_argument,		NULL, 'b'},
+		{"max-count-error",	required_argument,	NULL, OPT_MAX_COUNT_ERROR},
+		{"max-ns",			required_argument,	NULL, OPT_MAX_NS},
+		{"help",			no_argument,		NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	replay_options_t options = {
+		.tolerance_ms = DEFAULT_TOLERANCE_MS,
+		.repeats = DEFAULT_REPEATS,
+		.quiet = false,
+		.batch = false,
+		.max_count_error_pct = -1.0,
+		.max_ns_per_sample = -1.0,
+	};
+
+	int opt;
+	while ((opt = getopt_long (argc, argv, "t:n:qbh", long_options, NULL)) != -1) {
+		switch (opt) {
+			case 't':
+				options.tolerance_ms = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			case 'n':
+				options.repeats = atoi (optarg) > 0 ? atoi (optarg) : 1;
+				break;
+			case 'q':
+				options.quiet = true;
+				break;
+			case 'b':
+				options.batch = true;
+				break;
+			case OPT_MAX_COUNT_ERROR:
+				options.max_count_error_pct = strtod (optarg, NULL);
+				break;
+			case OPT_MAX_NS:
+				options.max_ns_per_sample = strtod (optarg, NULL);
+				break;
+			default:
+				replay_Usage (argv[0]);
+				return opt == 'h' ? 0 : 2;
+		}
+	}
+
+	if (optind >= argc) {
+		replay_Usage (argv[0]);
+		return 2;
+	}
+
+	replay_result_t total;
+	memset (&total, 0, sizeof(total));
+	trace_t trace;
+	trace_Init (&trace, TRACE_DEFAULT_RATE_HZ);
+
+	for (int i = optind; i < argc; i++) {
+		replay_result_t result;
+		if (trace_Load (argv[i], &trace) != 0) {
+			return 2;
+		}
+		if (replay_Trace (&trace, &options, &result) != 0) {
+			fprintf (stderr, "replay: pipeline run failed for %s\n", argv[i]);
+			return 2;
+		}
+		if (!options.quiet) {
+			replay_Print (argv[i], &result, &options);
+		}
+		replay_Accumulate (&total, &result);
+	}
+	trace_Free (&trace);
+
+	if (argc - optind > 1 || options.quiet) {
+		replay_Print ("TOTAL", &total, &options);
+	}
+
+	int status = 0;
+	double count_error = score_CountErrorPct (&total.score);
+	if (options.max_count_error_pct >= 0.0
+			&& (count_error > options.max_count_error_pct || -count_error > options.max_count_error_pct)) {
+		printf ("FAIL: count error %+.2f%% exceeds %.2f%%\n", count_error, options.max_count_error_pct);
+		status = 1;
+	}
+	if (options.max_ns_per_sample >= 0.0 && total.ns_per_sample > options.max_ns_per_sample) {
+		printf ("FAIL: %.1f ns/sample exceeds %.1f\n", total.ns_per_sample, options.max_ns_per_sample);
+		status = 1;
+	}
+	return status;
+}
@@ -0,0 +1,83 @@
+/*
+ * score.c
+ *
+ * Greedy in-order matching of detected steps to labelled steps.
+ * A detection matches the oldest unmatched label within +/- tolerance,
+ * labels left behind are misses and unmatched detections are false steps.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "score.h"
+
+#include <string.h>
+
+
+void score_Match (const trace_t* trace, const uint32_t* detections, uint32_t num_detections,
+		uint32_t tolerance_ms, score_t* score)
+{
+	uint32_t tolerance = tolerance_ms * trace->rate_hz / 1000;
+	uint32_t label = 0;
+
+	memset (score, 0, sizeof(*score));
+	score->labels = trace_StepCountGetter (trace);
+	score->detected = num_detections;
+
+	for (uint32_t d = 0; d < num_detections; d++) {
+		uint32_t detection = detections[d];
+
+		/* labels too old for this detection are misses */
+		while (label < trace->count && (!trace->step[label] || label + tolerance < detection)) {
+			label++;
+		}
+		if (label >= trace->count || label > detection + tolerance) {
+			continue; // false step
+		}
+
+		int32_t error_ms = ((int32_t) detection - (int32_t) label) * 1000 / (int32_t) trace->rate_hz;
+		uint32_t abs_error_ms = (uint32_t) (error_ms < 0 ? -error_ms : error_ms);
+
+		score->matched++;
+		score->sum_error_ms += error_ms;
+		score->sum_abs_error_ms += abs_error_ms;
+		if (abs_error_ms > score->max_abs_error_ms) {
+			score->max_abs_error_ms = abs_error_ms;
+		}
+		label++;
+	}
+}
+
+
+void score_Accumulate (score_t* total, const score_t* score)
+{
+	total->labels += score->labels;
+	total->detected += score->detected;
+	total->matched += score->matched;
+	total->sum_error_ms += score->sum_error_ms;
+	total->sum_abs_error_ms += score->sum_abs_error_ms;
+	if (score->max_abs_error_ms > total->max_abs_error_ms) {
+		total->max_abs_error_ms = score->max_abs_error_ms;
+	}
+}
+
+
+/* Signed error of the total step count, as a percentage of the labels */
+double score_CountErrorPct (const score_t* score)
+{
+	if (score->labels == 0) {
+		return score->detected ? 100.0 : 0.0;
+	}
+	return 100.0 * ((double) score->detected - score->labels) / score->labels;
+}
+
+
+/* Harmonic mean of precision and recall of matched steps */
+double score_F1 (const score_t* score)
+{
+	uint32_t denominator = score->labels + score->detected;
+	if (denominator == 0) {
+		return 1.0;
+	}
+	return 2.0 * score->matched / denominator;
+}
@@ -0,0 +1,33 @@
+/*
+ * score.h
+ *
+ * Step detections scored against the ground-truth labels of a trace
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef SCORE_H_
+#define SCORE_H_
+
+#include "trace_io.h"
+
+#include <stdint.h>
+
+typedef struct {
+	uint32_t labels;
+	uint32_t detected;
+	uint32_t matched;
+	int64_t sum_error_ms;		// detection time - label time
+	int64_t sum_abs_error_ms;
+	uint32_t max_abs_error_ms;
+} score_t;
+
+void score_Match (const trace_t* trace, const uint32_t* detections, uint32_t num_detections,
+		uint32_t tolerance_ms, score_t* score);
+void score_Accumulate (score_t* total, const score_t* score);
+
+double score_CountErrorPct (const score_t* score);
+double score_F1 (const score_t* score);
+
+#endif /* SCORE_H_ */
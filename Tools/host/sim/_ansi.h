@@ -0,0 +1,16 @@
+/*
+ * _ansi.h
+ *
+ * The newlib header ssd1306.h includes, for glibc hosts
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef SIM_ANSI_H_
+#define SIM_ANSI_H_
+
+#define _BEGIN_STD_C
+#define _END_STD_C
+
+#endif /* SIM_ANSI_H_ */
@@ -0,0 +1,58 @@
+/*
+ * sim.h
+ *
+ * Virtual-time simulation of the board for stepsim: the clock, interrupts
+ * and the peripherals behind the simulated HAL, with an LSM6DS on SPI2 and
+ * an SSD1306 on I2C1
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include "stm32c0xx_hal.h"
+
+#include <stdint.h>
+
+#define SIM_CLOCK_HZ		12000000U	// SYSCLK, as configured by SystemClock_Config
+#define SIM_CYCLES_PER_US	(SIM_CLOCK_HZ / 1000000U)
+
+#define SIM_DISPLAY_WIDTH	128
+#define SIM_DISPLAY_PAGES	8
+
+typedef struct {
+	/* every whole ms of virtual time, before the firmware sees that tick */
+	void (*tick) (uint64_t time_us);
+	/* every HAL_GPIO_WritePin or TogglePin */
+	void (*output) (GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+	/* bytes sent on USART2 */
+	void (*uart) (const uint8_t* data, uint16_t size);
+} sim_hooks_t;
+
+typedef struct {
+	uint32_t interrupts;		// handlers run
+	uint32_t display_bytes;		// data bytes written to the SSD1306
+	uint32_t bus_conflicts;		// transfers started while the bus was busy, refused with HAL_BUSY
+	uint32_t spin_skips;		// times HAL_GetTick was polled in a loop and time moved on
+	uint32_t watchdog_resets;	// the IWDG expired, which ends the run
+} sim_stats_t;
+
+/* Run the firmware from reset until duration_us of virtual time has passed */
+void sim_Run (const sim_hooks_t* hooks, uint64_t duration_us);
+uint64_t sim_TimeGetter (void);
+void sim_StatsGetter (sim_stats_t* stats);
+
+/* Inputs, take effect at once */
+void sim_InputSet (GPIO_TypeDef* port, uint16_t pin, GPIO_PinState level);
+void sim_AnalogSet (uint32_t adc_channel, uint16_t value);
+void sim_ImuSet (int16_t x, int16_t y, int16_t z);
+void sim_UartReceive (uint8_t byte);
+void sim_I2cStallSet (uint8_t stalled);		// hold every I2C transfer from now on, as a stuck bus would
+
+/* SSD1306 display RAM, SIM_DISPLAY_PAGES rows of SIM_DISPLAY_WIDTH bytes, bit 0 at the top */
+const uint8_t* sim_DisplayRamGetter (void);
+uint8_t sim_DisplayBusyGetter (void);
+
+#endif /* SIM_H_ */
@@ -0,0 +1,928 @@
+/*
+ * sim_hal.c
+ *
+ * The board behind the simulated HAL. Virtual time only moves while the
+ * firmware waits: in __WFI, HAL_Delay and blocking bus transfers, which
+ * take as long as they would on the wire. Code in between takes no time
+ * at all, so a run goes as fast as the host allows and its result depends
+ * only on the inputs.
+ *
+ * Interrupts are pended by the events they come from (SysTick, the TIM3
+ * overflow, ADC and I2C DMA completions, USART2 transmissions) and taken as soon as PRIMASK
+ * allows, highest priority first, without nesting. With APP_USE_KERNEL,
+ * PendSV is taken after them, with sim_kernel.c switching threads.
+ *
+ * The IWDG counts from its first key write; when it expires the run ends
+ * there, as the firmware cannot be reset in place. sim_I2cStallSet holds
+ * I2C transfers forever, as a stuck bus would, to exercise it.
+ *
+ * SysTick runs at a fixed 1 ms, so the firmware must be built without
+ * APP_TICKLESS_IDLE; sim_Run can only be called once per process, as the
+ * firmware's statics are not reset.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "sim.h"
+#include "main.h"
+#include "adc.h"
+#include "i2c.h"
+#include "spi.h"
+#include "tim.h"
+#include "usart.h"
+#include "app.h"
+#include "imu_lsm6ds.h"
+#include "trace.h"
+#include "kernel.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NEVER					UINT64_MAX
+#define TICK_CYCLES				(SIM_CLOCK_HZ / 1000)
+#define TIM3_WRAP_CYCLES		(0x10000ULL * SIM_CYCLES_PER_US)
+#define I2C_BIT_CYCLES			116		// hi2c1 Timing 0x00402D41: SCLL 66 + SCLH 46 + sync, ~103 kHz
+#define I2C_BYTE_BITS			9
+#define SPI_FRAME_CYCLES		32		// 16 bits at SYSCLK / 2
+#define ADC_CONVERSION_CYCLES	14		// 1.5 sampling + 12.5 conversion, ADC clock = SYSCLK
+#define UART_BYTE_CYCLES		(SIM_CLOCK_HZ / (115200 / 10))
+#define LSI_HZ					32000
+#define IWDG_KEY_RELOAD			0xAAAAU
+#define IWDG_KEY_START			0xCCCCU
+#define ADC_MAX_CHANNELS		23
+#define SPIN_LIMIT				10000	// HAL_GetTick calls at one instant before time moves on
+
+#define SSD1306_ADDRESS			(0x3C << 1)
+#define SSD1306_CONTROL_DATA	0x40
+#define LSM6DS_ID				0x6A
+#define LSM6DS_READ				0x80
+#define LSM6DS_ODR_MASK			0xF0
+
+#define MIN(A, B)				((A) < (B) ? (A) : (B))
+
+/* Highest priority first */
+typedef enum {
+	IRQ_TIM3,
+	IRQ_DMA_ADC,
+	IRQ_DMA_I2C,
+	IRQ_SYSTICK,
+	IRQ_UART,
+} sim_irq_t;
+
+typedef enum {
+	SSD1306_HORIZONTAL,
+	SSD1306_VERTICAL,
+	SSD1306_PAGE,
+} ssd1306_mode_t;
+
+typedef struct {
+	uint8_t ram[SIM_DISPLAY_PAGES][SIM_DISPLAY_WIDTH];
+	uint8_t page;
+	uint8_t column;
+	ssd1306_mode_t mode;
+	uint8_t column_start;
+	uint8_t column_end;
+	uint8_t page_start;
+	uint8_t page_end;
+	uint8_t command[7];		// longest command with its arguments
+	uint8_t command_length;
+} ssd1306_model_t;
+
+void TIM3_IRQHandler (void);	// timebase.c
+#if APP_USE_KERNEL
+void PendSV_Handler (void);	// sim_kernel.c
+#endif
+
+uint32_t SystemCoreClock = SIM_CLOCK_HZ;
+__IO uint32_t uwTick = 0;
+
+SysTick_Type sim_systick;
+SCB_Type sim_scb;
+GPIO_TypeDef sim_gpio[6];
+DMA_Channel_TypeDef sim_dma1[3];
+ADC_TypeDef sim_adc1;
+TIM_TypeDef sim_tim2;
+TIM_TypeDef sim_tim3;
+TIM_TypeDef sim_tim16;
+I2C_TypeDef sim_i2c1;
+SPI_TypeDef sim_spi2;
+USART_TypeDef sim_usart2;
+IWDG_TypeDef sim_iwdg = { .RLR = 0xFFF, .WINR = 0xFFF };
+uint32_t sim_reset_flags = RCC_FLAG_PWRRST | RCC_FLAG_PINRST;
+
+/* The handles CubeMX defines in i2c.c, spi.c, tim.c and usart.c */
+I2C_HandleTypeDef hi2c1 = { .Instance = I2C1, .Init.Timing = 0x00402D41 };
+SPI_HandleTypeDef hspi2 = { .Instance = SPI2, .Init.DataSize = SPI_DATASIZE_16BIT };
+TIM_HandleTypeDef htim2 = { .Instance = TIM2, .Init.Period = 250 };
+TIM_HandleTypeDef htim16 = { .Instance = TIM16, .Init.Period = 65535 };
+UART_HandleTypeDef huart2 = { .Instance = USART2, .Init.BaudRate = 115200 };
+
+static const sim_hooks_t* hooks;
+static jmp_buf finished;
+static sim_stats_t stats;
+
+/* all times in SYSCLK cycles */
+static uint64_t now = 0;
+static uint64_t end = 0;
+static uint64_t next_tick = TICK_CYCLES;
+static uint64_t tim3_start = 0;
+static uint64_t tim3_wrap = NEVER;
+static uint64_t adc_done = NEVER;
+static uint64_t i2c_done = NEVER;		// DMA transfer
+static uint64_t uart_done = NEVER;		// interrupt transmission
+static const uint8_t* uart_data;
+static uint16_t uart_size;
+static uint64_t i2c_busy_until = 0;		// blocking transfer
+static uint8_t i2c_stalled = 0;
+static uint64_t iwdg_expiry = NEVER;
+
+static uint32_t primask = 0;
+static uint8_t in_handler = 0;
+static uint8_t pending = 0;				// bit per sim_irq_t
+static uint32_t pend_count = 0;
+static uint8_t tim3_irq_enabled = 0;
+static uint64_t spin_time = 0;
+static uint32_t spins = 0;
+
+static uint16_t analog[ADC_MAX_CHANNELS];
+static uint32_t adc_channels = 0;		// bit per configured channel, converted lowest first
+static uint16_t* adc_buffer;
+static uint32_t adc_length;
+
+static const uint8_t* i2c_data;
+static uint16_t i2c_size;
+static uint16_t i2c_control;
+
+static uint8_t imu_registers[0x80];
+static int16_t imu_sample[3];
+
+static ssd1306_model_t ssd1306 = {
+	.mode = SSD1306_PAGE,
+	.column_end = SIM_DISPLAY_WIDTH - 1,
+	.page_end = SIM_DISPLAY_PAGES - 1,
+};
+
+
+/* SSD1306 ------------------------------------------------------------------*/
+
+static uint8_t sim_Ssd1306Arguments (uint8_t command)
+{
+	switch (command) {
+		case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+		case 0xD5: case 0xD8: case 0xD9: case 0xDA: case 0xDB:
+			return 1;
+		case 0x21: case 0x22: case 0xA3:
+			return 2;
+		case 0x29: case 0x2A:
+			return 5;
+		case 0x26: case 0x27:
+			return 6;
+		default:
+			return 0;
+	}
+}
+
+
+/* Only the commands that move the RAM pointer matter to the picture */
+static void sim_Ssd1306Command (const uint8_t* command)
+{
+	uint8_t op = command[0];
+
+	if (op <= 0x0F) {
+		ssd1306.column = (ssd1306.column & 0x70) | op;
+	} else if (op <= 0x1F) {
+		ssd1306.column = (ssd1306.column & 0x0F) | ((op & 0x07) << 4);
+	} else if (op >= 0xB0 && op <= 0xB7) {
+		ssd1306.page = op & 0x07;
+	} else if (op == 0x20) {
+		ssd1306.mode = command[1] & 0x03;
+	} else if (op == 0x21) {
+		ssd1306.column_start = command[1] & 0x7F;
+		ssd1306.column_end = command[2] & 0x7F;
+		ssd1306.column = ssd1306.column_start;
+	} else if (op == 0x22) {
+		ssd1306.page_start = command[1] & 0x07;
+		ssd1306.page_end = command[2] & 0x07;
+		ssd1306.page = ssd1306.page_start;
+	}
+}
+
+
+static void sim_Ssd1306Data (uint8_t byte)
+{
+	ssd1306.ram[ssd1306.page][ssd1306.column] = byte;
+	stats.display_bytes++;
+
+	switch (ssd1306.mode) {
+		case SSD1306_HORIZONTAL:
+			if (ssd1306.column != ssd1306.column_end) {
+				ssd1306.column++;
+				break;
+			}
+			ssd1306.column = ssd1306.column_start;
+			ssd1306.page = ssd1306.page == ssd1306.page_end ? ssd1306.page_start : ssd1306.page + 1;
+			break;
+
+		case SSD1306_VERTICAL:
+			if (ssd1306.page != ssd1306.page_end) {
+				ssd1306.page++;
+				break;
+			}
+			ssd1306.page = ssd1306.page_start;
+			ssd1306.column = ssd1306.column == ssd1306.column_end ? ssd1306.column_start : ssd1306.column + 1;
+			break;
+
+		default:
+			ssd1306.column = (ssd1306.column + 1) & 0x7F;
+			break;
+	}
+}
+
+
+/* One I2C write: the memory address byte is the SSD1306 control byte */
+static void sim_Ssd1306Receive (uint16_t control, const uint8_t* data, uint16_t size)
+{
+	for (uint16_t i = 0; i < size; i++) {
+		if (control & SSD1306_CONTROL_DATA) {
+			sim_Ssd1306Data (data[i]);
+			continue;
+		}
+		ssd1306.command[ssd1306.command_length++] = data[i];
+		if (ssd1306.command_length > sim_Ssd1306Arguments (ssd1306.command[0])) {
+			sim_Ssd1306Command (ssd1306.command);
+			ssd1306.command_length = 0;
+		}
+	}
+}
+
+
+/* LSM6DS -------------------------------------------------------------------*/
+
+/* A 16-bit frame: register address (bit 7 set to read) in the high byte, data in the low byte */
+static uint16_t sim_Lsm6dsTransfer (uint16_t frame)
+{
+	uint8_t address = frame >> 8;
+	uint8_t reg = address & ~LSM6DS_READ;
+
+	if (!(address & LSM6DS_READ)) {
+		imu_registers[reg] = (uint8_t) frame;
+		return 0;
+	}
+
+	if (reg == WHO_AM_I) {
+		return LSM6DS_ID;
+	}
+	if (reg >= OUTX_L_XL && reg <= OUTZ_H_XL) {
+		/* powered down until CTRL1_XL sets a data rate */
+		if (!(imu_registers[CTRL1_XL] & LSM6DS_ODR_MASK)) {
+			return 0;
+		}
+		uint16_t value = (uint16_t) imu_sample[(reg - OUTX_L_XL) / 2];
+		return (reg - OUTX_L_XL) % 2 ? value >> 8 : value & 0xFF;
+	}
+	return imu_registers[reg];
+}
+
+
+/* Clock and interrupts -----------------------------------------------------*/
+
+static void sim_Pend (sim_irq_t irq)
+{
+	pending |= 1 << irq;
+	pend_count++;
+}
+
+
+/* What the firmware sees of the counters at the current time */
+static void sim_UpdateRegisters (void)
+{
+	SysTick->VAL = (uint32_t) (next_tick - now - 1);
+	if (tim3_wrap != NEVER) {
+		TIM3->CNT = ((now - tim3_start) / SIM_CYCLES_PER_US) & 0xFFFF;
+	}
+}
+
+
+static void sim_AdcComplete (void)
+{
+	uint32_t n = 0;
+
+	for (uint32_t channel = 0; channel < ADC_MAX_CHANNELS && n < adc_length; channel++) {
+		if (adc_channels & (1UL << channel)) {
+			adc_buffer[n++] = analog[channel];
+		}
+	}
+}
+
+
+static void sim_Events (void)
+{
+	if (now >= next_tick) {
+		next_tick += TICK_CYCLES;
+		if (hooks->tick != NULL) {
+			hooks->tick (now / SIM_CYCLES_PER_US);
+		}
+		sim_Pend (IRQ_SYSTICK);
+	}
+	if (now >= tim3_wrap) {
+		tim3_wrap += TIM3_WRAP_CYCLES;
+		TIM3->SR |= TIM_SR_UIF;
+		if ((TIM3->DIER & TIM_DIER_UIE) && tim3_irq_enabled) {
+			sim_Pend (IRQ_TIM3);
+		}
+	}
+	if (now >= adc_done) {
+		adc_done = NEVER;
+		sim_AdcComplete ();
+		sim_Pend (IRQ_DMA_ADC);
+	}
+	if (now >= i2c_done) {
+		/* the buffer is read at the end, so changing it mid-transfer shows on the display */
+		i2c_done = NEVER;
+		sim_Ssd1306Receive (i2c_control, i2c_data, i2c_size);
+		sim_Pend (IRQ_DMA_I2C);
+	}
+	if (now >= uart_done) {
+		uart_done = NEVER;
+		if (hooks->uart != NULL) {
+			hooks->uart (uart_data, uart_size);
+		}
+		sim_Pend (IRQ_UART);
+	}
+}
+
+
+/* Take pending interrupts if PRIMASK allows, as the NVIC would */
+static void sim_Deliver (void)
+{
+	if (primask || in_handler) {
+		return;
+	}
+
+	in_handler = 1;
+	while (pending) {
+		sim_irq_t irq = __builtin_ctz (pending);
+		pending &= ~(1 << irq);
+		stats.interrupts++;
+
+		switch (irq) {
+			case IRQ_TIM3:
+				TIM3_IRQHandler ();
+				break;
+			case IRQ_DMA_ADC:
+				TRACE_ISR_ENTER (TRACE_ISR_DMA_ADC);
+				HAL_ADC_ConvCpltCallback (&hadc1);
+				TRACE_ISR_EXIT (TRACE_ISR_DMA_ADC);
+				break;
+			case IRQ_DMA_I2C:
+				TRACE_ISR_ENTER (TRACE_ISR_DMA_I2C);
+				HAL_I2C_MemTxCpltCallback (&hi2c1);
+				TRACE_ISR_EXIT (TRACE_ISR_DMA_I2C);
+				break;
+			case IRQ_SYSTICK:
+				HAL_IncTick ();
+#if APP_USE_KERNEL
+				kernel_Tick ();
+#endif
+				break;
+			case IRQ_UART:
+				HAL_UART_TxCpltCallback (&huart2);
+				break;
+		}
+	}
+	in_handler = 0;
+
+#if APP_USE_KERNEL
+	/* lowest priority, so the switch comes last; the thread switched out resumes here */
+	while (!primask && (SCB->ICSR & SCB_ICSR_PENDSVSET_Msk)) {
+		SCB->ICSR &= ~SCB_ICSR_PENDSVSET_Msk;
+		PendSV_Handler ();
+	}
+#endif
+}
+
+
+static uint64_t sim_NextEvent (void)
+{
+	return MIN (MIN (MIN (next_tick, tim3_wrap), MIN (adc_done, i2c_done)), MIN (uart_done, iwdg_expiry));
+}
+
+
+/* Start or reload on a key written since time last moved, with PR and RLR as they are now */
+static void sim_Watchdog (void)
+{
+	if (IWDG->KR == IWDG_KEY_START || IWDG->KR == IWDG_KEY_RELOAD) {
+		uint64_t counts = (uint64_t) ((IWDG->RLR & 0xFFF) + 1) << (IWDG->PR & 0x7);
+		iwdg_expiry = now + counts * 4 * SIM_CLOCK_HZ / LSI_HZ;
+	}
+	IWDG->KR = 0;
+}
+
+
+/* Move virtual time on to target, running every event and interrupt on the way */
+static void sim_Advance (uint64_t target)
+{
+	/* timebase_Init starts TIM3 by setting CEN */
+	if (tim3_wrap == NEVER && (TIM3->CR1 & TIM_CR1_CEN)) {
+		tim3_start = now - (uint64_t) TIM3->CNT * SIM_CYCLES_PER_US;
+		tim3_wrap = tim3_start + TIM3_WRAP_CYCLES;
+	}
+
+	sim_Watchdog ();
+
+	while (now < target) {
+		now = MIN (MIN (target, end), sim_NextEvent ());
+		sim_Events ();
+		sim_UpdateRegisters ();
+		if (now >= iwdg_expiry) {
+			stats.watchdog_resets++;
+			longjmp (finished, 1);
+		}
+		if (now >= end) {
+			longjmp (finished, 1);
+		}
+		sim_Deliver ();
+	}
+}
+
+
+static uint8_t sim_I2cBusy (void)
+{
+	return i2c_done != NEVER || now < i2c_busy_until;
+}
+
+
+/* Address, control byte and data, 9 bits each, plus start and stop */
+static uint64_t sim_I2cCycles (uint16_t size)
+{
+	return ((uint64_t) (2 + size) * I2C_BYTE_BITS + 2) * I2C_BIT_CYCLES;
+}
+
+
+/* Control ------------------------------------------------------------------*/
+
+void sim_Run (const sim_hooks_t* run_hooks, uint64_t duration_us)
+{
+	hooks = run_hooks;
+	end = duration_us * SIM_CYCLES_PER_US;
+
+	if (setjmp (finished) == 0) {
+		/* what HAL_Init and the MX_ functions in main.c leave behind */
+		SysTick->LOAD = TICK_CYCLES - 1;
+		SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+		TIM2->ARR = htim2.Init.Period;
+		TIM16->ARR = htim16.Init.Period;
+		sim_UpdateRegisters ();
+		MX_ADC1_Init ();
+
+		app_main ();
+	}
+}
+
+
+uint64_t sim_TimeGetter (void)
+{
+	return now / SIM_CYCLES_PER_US;
+}
+
+
+void sim_StatsGetter (sim_stats_t* out)
+{
+	*out = stats;
+}
+
+
+void sim_I2cStallSet (uint8_t stalled)
+{
+	i2c_stalled = stalled;
+	if (!stalled && i2c_busy_until == NEVER) {
+		i2c_busy_until = now;
+	}
+}
+
+
+void sim_InputSet (GPIO_TypeDef* port, uint16_t pin, GPIO_PinState level)
+{
+	if (level == GPIO_PIN_SET) {
+		port->IDR |= pin;
+	} else {
+		port->IDR &= ~(uint32_t) pin;
+	}
+}
+
+
+void sim_AnalogSet (uint32_t adc_channel, uint16_t value)
+{
+	if (adc_channel < ADC_MAX_CHANNELS) {
+		analog[adc_channel] = value;
+	}
+}
+
+
+void sim_ImuSet (int16_t x, int16_t y, int16_t z)
+{
+	imu_sample[0] = x;
+	imu_sample[1] = y;
+	imu_sample[2] = z;
+}
+
+
+void sim_UartReceive (uint8_t byte)
+{
+	if (USART2->ISR & UART_FLAG_RXNE) {
+		USART2->ISR |= UART_FLAG_ORE;
+	}
+	USART2->RDR = byte;
+	USART2->ISR |= UART_FLAG_RXNE;
+}
+
+
+const uint8_t* sim_DisplayRamGetter (void)
+{
+	return &ssd1306.ram[0][0];
+}
+
+
+uint8_t sim_DisplayBusyGetter (void)
+{
+	return sim_I2cBusy ();
+}
+
+
+/* Core and HAL -------------------------------------------------------------*/
+
+void Error_Handler (void)
+{
+	fprintf (stderr, "sim: Error_Handler at %.3f ms\n", now / (double) TICK_CYCLES);
+	exit (3);
+}
+
+
+void __disable_irq (void)
+{
+	primask = 1;
+}
+
+
+void __enable_irq (void)
+{
+	primask = 0;
+	sim_Deliver ();
+}
+
+
+uint32_t __get_PRIMASK (void)
+{
+	return primask;
+}
+
+
+void __set_PRIMASK (uint32_t value)
+{
+	primask = value & 1;
+	sim_Deliver ();
+}
+
+
+/* Sleep until an interrupt is pending, taken or not */
+void __WFI (void)
+{
+	uint32_t start = pend_count;
+
+	while (!pending && pend_count == start) {
+		sim_Advance (sim_NextEvent ());
+	}
+}
+
+
+/* Polling the tick in a loop would never see it move, so time moves on after a while */
+uint32_t HAL_GetTick (void)
+{
+	if (now != spin_time) {
+		spin_time = now;
+		spins = 0;
+	} else if (++spins >= SPIN_LIMIT) {
+		spins = 0;
+		stats.spin_skips++;
+		sim_Advance (sim_NextEvent ());
+	}
+	return uwTick;
+}
+
+
+void HAL_IncTick (void)
+{
+	uwTick++;
+}
+
+
+void HAL_Delay (uint32_t delay)
+{
+	uint32_t start = HAL_GetTick ();
+	uint32_t wait = delay < HAL_MAX_DELAY ? delay + 1 : delay;
+
+	while (HAL_GetTick () - start < wait) {
+		if (primask || in_handler) {
+			fprintf (stderr, "sim: HAL_Delay with SysTick blocked never returns\n");
+			exit (3);
+		}
+		sim_Advance (next_tick);
+	}
+}
+
+
+void HAL_NVIC_SetPriority (IRQn_Type irq, uint32_t preempt_priority, uint32_t sub_priority)
+{
+	(void) irq;
+	(void) preempt_priority;
+	(void) sub_priority;
+}
+
+
+void NVIC_SetPriority (IRQn_Type irq, uint32_t priority)
+{
+	(void) irq;
+	(void) priority;
+}
+
+
+/* DMA, ADC and SysTick interrupts are always enabled, as MX_DMA_Init and HAL_Init leave them */
+void HAL_NVIC_EnableIRQ (IRQn_Type irq)
+{
+	if (irq == TIM3_IRQn) {
+		tim3_irq_enabled = 1;
+	}
+}
+
+
+void HAL_NVIC_DisableIRQ (IRQn_Type irq)
+{
+	if (irq == TIM3_IRQn) {
+		tim3_irq_enabled = 0;
+	}
+}
+
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig (RCC_PeriphCLKInitTypeDef* init)
+{
+	(void) init;
+	return HAL_OK;
+}
+
+
+uint32_t HAL_RCC_GetPCLK1Freq (void)
+{
+	return SIM_CLOCK_HZ;
+}
+
+
+void HAL_GPIO_Init (GPIO_TypeDef* port, const GPIO_InitTypeDef* init)
+{
+	(void) port;
+	(void) init;
+}
+
+
+void HAL_GPIO_DeInit (GPIO_TypeDef* port, uint32_t pin)
+{
+	(void) port;
+	(void) pin;
+}
+
+
+GPIO_PinState HAL_GPIO_ReadPin (const GPIO_TypeDef* port, uint16_t pin)
+{
+	return (port->IDR & pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+
+void HAL_GPIO_WritePin (GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state)
+{
+	if (state == GPIO_PIN_SET) {
+		port->ODR |= pin;
+	} else {
+		port->ODR &= ~(uint32_t) pin;
+	}
+	if (hooks->output != NULL) {
+		hooks->output (port, pin, state);
+	}
+}
+
+
+void HAL_GPIO_TogglePin (GPIO_TypeDef* port, uint16_t pin)
+{
+	HAL_GPIO_WritePin (port, pin, (port->ODR & pin) ? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+
+HAL_StatusTypeDef HAL_DMA_Init (DMA_HandleTypeDef* hdma)
+{
+	(void) hdma;
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_DMA_DeInit (DMA_HandleTypeDef* hdma)
+{
+	(void) hdma;
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_ADC_Init (ADC_HandleTypeDef* hadc)
+{
+	adc_channels = 0;
+	HAL_ADC_MspInit (hadc);
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_ADC_ConfigChannel (ADC_HandleTypeDef* hadc, ADC_ChannelConfTypeDef* config)
+{
+	(void) hadc;
+	if (config->Channel >= ADC_MAX_CHANNELS) {
+		return HAL_ERROR;
+	}
+	adc_channels |= 1UL << config->Channel;
+	return HAL_OK;
+}
+
+
+/* The fixed sequence converts every configured channel, one halfword each */
+HAL_StatusTypeDef HAL_ADC_Start_DMA (ADC_HandleTypeDef* hadc, uint32_t* data, uint32_t length)
+{
+	(void) hadc;
+	if (adc_done != NEVER) {
+		return HAL_BUSY;
+	}
+	adc_buffer = (uint16_t*) data;
+	adc_length = length;
+	adc_done = now + (uint64_t) length * ADC_CONVERSION_CYCLES;
+	return HAL_OK;
+}
+
+
+__attribute__((weak)) void HAL_ADC_MspInit (ADC_HandleTypeDef* hadc)
+{
+	(void) hadc;
+}
+
+
+__attribute__((weak)) void HAL_ADC_ConvCpltCallback (ADC_HandleTypeDef* hadc)
+{
+	(void) hadc;
+}
+
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start (TIM_HandleTypeDef* htim, uint32_t channel)
+{
+	(void) htim;
+	(void) channel;
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_I2C_Init (I2C_HandleTypeDef* hi2c)
+{
+	(void) hi2c;
+	return HAL_OK;
+}
+
+
+/* Stops a DMA transfer without completing it; a stalled bus stalls the next transfer again */
+HAL_StatusTypeDef HAL_I2C_DeInit (I2C_HandleTypeDef* hi2c)
+{
+	(void) hi2c;
+	i2c_done = NEVER;
+	pending &= ~(1 << IRQ_DMA_I2C);
+	if (i2c_busy_until == NEVER) {
+		i2c_busy_until = now;
+	}
+	return HAL_OK;
+}
+
+
+/* Blocking: returns once the bytes are on the wire, taking interrupts meanwhile */
+HAL_StatusTypeDef HAL_I2C_Mem_Write (I2C_HandleTypeDef* hi2c, uint16_t address, uint16_t mem_address,
+		uint16_t mem_size, uint8_t* data, uint16_t size, uint32_t timeout)
+{
+	(void) hi2c;
+	(void) mem_size;
+	(void) timeout;
+
+	if (sim_I2cBusy ()) {
+		stats.bus_conflicts++;
+		return HAL_BUSY;
+	}
+	if (address != SSD1306_ADDRESS) {
+		sim_Advance (now + sim_I2cCycles (0));
+		return HAL_ERROR;
+	}
+	if (i2c_stalled) {
+		sim_Advance (timeout == HAL_MAX_DELAY ? NEVER : now + (uint64_t) timeout * TICK_CYCLES);
+		return HAL_TIMEOUT;
+	}
+
+	i2c_busy_until = now + sim_I2cCycles (size);
+	sim_Advance (i2c_busy_until);
+	sim_Ssd1306Receive (mem_address, data, size);
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA (I2C_HandleTypeDef* hi2c, uint16_t address, uint16_t mem_address,
+		uint16_t mem_size, uint8_t* data, uint16_t size)
+{
+	(void) hi2c;
+	(void) mem_size;
+
+	if (sim_I2cBusy ()) {
+		stats.bus_conflicts++;
+		return HAL_BUSY;
+	}
+	if (address != SSD1306_ADDRESS) {
+		return HAL_ERROR;
+	}
+
+	if (i2c_stalled) {
+		/* holds the bus and never completes */
+		i2c_busy_until = NEVER;
+		return HAL_OK;
+	}
+
+	i2c_control = mem_address;
+	i2c_data = data;
+	i2c_size = size;
+	i2c_done = now + sim_I2cCycles (size);
+	return HAL_OK;
+}
+
+
+__attribute__((weak)) void HAL_I2C_MemTxCpltCallback (I2C_HandleTypeDef* hi2c)
+{
+	(void) hi2c;
+}
+
+
+/* 16-bit frames are read from and written to memory little endian, as on the target */
+HAL_StatusTypeDef HAL_SPI_TransmitReceive (SPI_HandleTypeDef* hspi, const uint8_t* tx_data, uint8_t* rx_data,
+		uint16_t size, uint32_t timeout)
+{
+	(void) hspi;
+	(void) timeout;
+
+	for (uint16_t i = 0; i < size; i++) {
+		uint16_t rx = sim_Lsm6dsTransfer (tx_data[2 * i] | (tx_data[2 * i + 1] << 8));
+		if (rx_data != NULL) {
+			rx_data[2 * i] = (uint8_t) rx;
+			rx_data[2 * i + 1] = rx >> 8;
+		}
+	}
+	sim_Advance (now + (uint64_t) size * SPI_FRAME_CYCLES);
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_SPI_Transmit (SPI_HandleTypeDef* hspi, const uint8_t* data, uint16_t size, uint32_t timeout)
+{
+	return HAL_SPI_TransmitReceive (hspi, data, NULL, size, timeout);
+}
+
+
+/*
+ * A read of RDR can't be seen from here, so the received byte counts as
+ * read once the firmware starts sending its answer
+ */
+HAL_StatusTypeDef HAL_UART_Transmit (UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size, uint32_t timeout)
+{
+	(void) timeout;
+
+	huart->Instance->ISR &= ~(UART_FLAG_RXNE | UART_FLAG_ORE);
+	if (hooks->uart != NULL) {
+		hooks->uart (data, size);
+	}
+	sim_Advance (now + (uint64_t) size * UART_BYTE_CYCLES);
+	return HAL_OK;
+}
+
+
+/* As HAL_UART_Transmit but in the background; the data is read once the last byte has gone, as with the I2C DMA */
+HAL_StatusTypeDef HAL_UART_Transmit_IT (UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size)
+{
+	if (uart_done != NEVER) {
+		return HAL_BUSY;
+	}
+	huart->Instance->ISR &= ~(UART_FLAG_RXNE | UART_FLAG_ORE);
+	uart_data = data;
+	uart_size = size;
+	uart_done = now + (uint64_t) size * UART_BYTE_CYCLES;
+	return HAL_OK;
+}
+
+
+__attribute__((weak)) void HAL_UART_TxCpltCallback (UART_HandleTypeDef* huart)
+{
+	(void) huart;
+}
@@ -0,0 +1,76 @@
+/*
+ * sim_kernel.c
+ *
+ * The kernel port for the simulated board (kernel_port.h). Each thread
+ * runs on a host stack of its own, switched with swapcontext; the
+ * firmware stacks given to kernel_CreateThread keep their fill pattern,
+ * so kernel_StackUsedGetter reads 0 here. sim_hal.c calls PendSV_Handler
+ * once the other pending interrupts have been taken.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "kernel_port.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ucontext.h>
+
+#define HOST_STACK_BYTES	(256 * 1024)	// the sim HAL and stepsim's hooks run on the thread stacks too
+
+typedef struct {
+	ucontext_t context;
+	kernel_entry_t entry;
+	kernel_entry_t exit;
+} sim_thread_t;
+
+static sim_thread_t sim_threads[KERNEL_MAX_THREADS];
+static uint8_t sim_thread_count = 0;
+static uint8_t host_stacks[KERNEL_MAX_THREADS][HOST_STACK_BYTES] __attribute__((aligned (16)));
+static ucontext_t boot_context;			// app_main, until the first switch
+static ucontext_t* running = &boot_context;
+
+
+/* makecontext passes int arguments only, so the thread is found by index */
+static void sim_ThreadStart (int index)
+{
+	sim_threads[index].entry ();
+	sim_threads[index].exit ();
+}
+
+
+/* The saved "stack pointer" is the thread's ucontext */
+uint32_t* kernel_PortInitStack (uint32_t* stack, uint16_t stack_words, kernel_entry_t entry, kernel_entry_t exit)
+{
+	(void) stack;
+	(void) stack_words;
+
+	sim_thread_t* thread = &sim_threads[sim_thread_count];
+	thread->entry = entry;
+	thread->exit = exit;
+	getcontext (&thread->context);
+	thread->context.uc_stack.ss_sp = host_stacks[sim_thread_count];
+	thread->context.uc_stack.ss_size = HOST_STACK_BYTES;
+	thread->context.uc_link = NULL;
+	makecontext (&thread->context, (void (*) (void)) sim_ThreadStart, 1, (int) sim_thread_count);
+	sim_thread_count++;
+	return (uint32_t*) &thread->context;
+}
+
+
+void kernel_PortStart (void)
+{
+}
+
+
+void PendSV_Handler (void)
+{
+	ucontext_t* from = running;
+	ucontext_t* to = (ucontext_t*) kernel_SwitchContext ((uint32_t*) from);
+
+	if (to != from) {
+		running = to;
+		swapcontext (from, to);
+	}
+}
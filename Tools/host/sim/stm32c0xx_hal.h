@@ -0,0 +1,479 @@
+/*
+ * stm32c0xx_hal.h
+ *
+ * Simulated HAL for stepsim: just enough of the STM32C0 HAL and CMSIS for
+ * the firmware modules to build unmodified on the host. Peripherals are
+ * plain structs; sim_hal.c keeps their registers in step with the virtual
+ * clock and models the devices on the buses.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef SIM_STM32C0XX_HAL_H_
+#define SIM_STM32C0XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __IO volatile
+#define __NVIC_PRIO_BITS	2
+
+typedef enum {
+	HAL_OK,
+	HAL_ERROR,
+	HAL_BUSY,
+	HAL_TIMEOUT,
+} HAL_StatusTypeDef;
+
+typedef enum {
+	DISABLE = 0,
+	ENABLE = !DISABLE,
+} FunctionalState;
+
+#define HAL_MAX_DELAY		0xFFFFFFFFU
+
+extern uint32_t SystemCoreClock;
+extern __IO uint32_t uwTick;
+
+uint32_t HAL_GetTick (void);
+void HAL_IncTick (void);
+void HAL_Delay (uint32_t delay);
+
+/* Cortex-M0+ core ----------------------------------------------------------*/
+
+typedef enum {
+	PendSV_IRQn = -2,
+	SysTick_IRQn = -1,
+	DMA1_Channel1_IRQn = 9,
+	DMA1_Channel2_3_IRQn = 10,
+	TIM3_IRQn = 16,
+	I2C1_IRQn = 23,
+	USART2_IRQn = 28,
+} IRQn_Type;
+
+typedef struct {
+	__IO uint32_t CTRL;
+	__IO uint32_t LOAD;
+	__IO uint32_t VAL;
+	__IO uint32_t CALIB;
+} SysTick_Type;
+
+#define SysTick_CTRL_ENABLE_Msk		(1U << 0)
+#define SysTick_CTRL_TICKINT_Msk	(1U << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk	(1U << 2)
+#define SysTick_CTRL_COUNTFLAG_Msk	(1U << 16)
+#define SysTick_LOAD_RELOAD_Msk		0xFFFFFFU
+
+extern SysTick_Type sim_systick;
+#define SysTick				(&sim_systick)
+
+/* Only PENDSVSET, for the kernel's context switches */
+typedef struct {
+	__IO uint32_t ICSR;
+} SCB_Type;
+
+#define SCB_ICSR_PENDSVSET_Msk		(1U << 28)
+
+extern SCB_Type sim_scb;
+#define SCB					(&sim_scb)
+
+void __disable_irq (void);
+void __enable_irq (void);
+uint32_t __get_PRIMASK (void);
+void __set_PRIMASK (uint32_t primask);
+void __WFI (void);
+
+static inline void __DSB (void) {}
+static inline void __DMB (void) {}
+static inline void __ISB (void) {}
+#define __NOP()				((void) 0)
+
+void HAL_NVIC_SetPriority (IRQn_Type irq, uint32_t preempt_priority, uint32_t sub_priority);
+void HAL_NVIC_EnableIRQ (IRQn_Type irq);
+void HAL_NVIC_DisableIRQ (IRQn_Type irq);
+void NVIC_SetPriority (IRQn_Type irq, uint32_t priority);
+
+/* RCC ----------------------------------------------------------------------*/
+
+#define __HAL_RCC_GPIOA_CLK_ENABLE()	((void) 0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()	((void) 0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE()	((void) 0)
+#define __HAL_RCC_GPIOD_CLK_ENABLE()	((void) 0)
+#define __HAL_RCC_GPIOF_CLK_ENABLE()	((void) 0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()		((void) 0)
+#define __HAL_RCC_ADC_CLK_ENABLE()		((void) 0)
+#define __HAL_RCC_ADC_CLK_DISABLE()		((void) 0)
+#define __HAL_RCC_TIM3_CLK_ENABLE()		((void) 0)
+#define __HAL_RCC_DBGMCU_CLK_ENABLE()	((void) 0)
+#define __HAL_DBGMCU_FREEZE_IWDG()		((void) 0)
+
+/* Reset flags, as RCC_CSR2 leaves them after a power-on reset */
+#define RCC_FLAG_PINRST				(1U << 0)
+#define RCC_FLAG_PWRRST				(1U << 1)
+#define RCC_FLAG_SFTRST				(1U << 2)
+#define RCC_FLAG_IWDGRST			(1U << 3)
+
+extern uint32_t sim_reset_flags;
+
+#define __HAL_RCC_GET_FLAG(FLAG)		((sim_reset_flags & (FLAG)) != 0)
+#define __HAL_RCC_CLEAR_RESET_FLAGS()	(sim_reset_flags = 0)
+
+typedef struct {
+	uint32_t PeriphClockSelection;
+	uint32_t Usart1ClockSelection;
+	uint32_t I2c1ClockSelection;
+	uint32_t AdcClockSelection;
+} RCC_PeriphCLKInitTypeDef;
+
+#define RCC_PERIPHCLK_ADC			0x00000080U
+#define RCC_ADCCLKSOURCE_SYSCLK		0x00000000U
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig (RCC_PeriphCLKInitTypeDef* init);
+uint32_t HAL_RCC_GetPCLK1Freq (void);
+
+/* IWDG ---------------------------------------------------------------------*/
+
+typedef struct {
+	__IO uint32_t KR;		// the last key written, taken by the simulation when time next moves
+	__IO uint32_t PR;
+	__IO uint32_t RLR;
+	__IO uint32_t SR;
+	__IO uint32_t WINR;
+} IWDG_TypeDef;
+
+extern IWDG_TypeDef sim_iwdg;
+#define IWDG (&sim_iwdg)
+
+/* GPIO ---------------------------------------------------------------------*/
+
+typedef struct {
+	__IO uint32_t IDR;		// input levels, set by the simulation
+	__IO uint32_t ODR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef sim_gpio[6];
+#define GPIOA				(&sim_gpio[0])
+#define GPIOB				(&sim_gpio[1])
+#define GPIOC				(&sim_gpio[2])
+#define GPIOD				(&sim_gpio[3])
+#define GPIOF				(&sim_gpio[5])
+
+typedef enum {
+	GPIO_PIN_RESET = 0,
+	GPIO_PIN_SET,
+} GPIO_PinState;
+
+#define GPIO_PIN_0			((uint16_t) 0x0001)
+#define GPIO_PIN_1			((uint16_t) 0x0002)
+#define GPIO_PIN_2			((uint16_t) 0x0004)
+#define GPIO_PIN_3			((uint16_t) 0x0008)
+#define GPIO_PIN_4			((uint16_t) 0x0010)
+#define GPIO_PIN_5			((uint16_t) 0x0020)
+#define GPIO_PIN_6			((uint16_t) 0x0040)
+#define GPIO_PIN_7			((uint16_t) 0x0080)
+#define GPIO_PIN_8			((uint16_t) 0x0100)
+#define GPIO_PIN_9			((uint16_t) 0x0200)
+#define GPIO_PIN_10			((uint16_t) 0x0400)
+#define GPIO_PIN_11			((uint16_t) 0x0800)
+#define GPIO_PIN_12			((uint16_t) 0x1000)
+#define GPIO_PIN_13			((uint16_t) 0x2000)
+#define GPIO_PIN_14			((uint16_t) 0x4000)
+#define GPIO_PIN_15			((uint16_t) 0x8000)
+
+typedef struct {
+	uint32_t Pin;
+	uint32_t Mode;
+	uint32_t Pull;
+	uint32_t Speed;
+	uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+#define GPIO_MODE_INPUT		0x00000000U
+#define GPIO_MODE_OUTPUT_PP	0x00000001U
+#define GPIO_MODE_ANALOG	0x00000003U
+#define GPIO_NOPULL			0x00000000U
+
+void HAL_GPIO_Init (GPIO_TypeDef* port, const GPIO_InitTypeDef* init);
+void HAL_GPIO_DeInit (GPIO_TypeDef* port, uint32_t pin);
+GPIO_PinState HAL_GPIO_ReadPin (const GPIO_TypeDef* port, uint16_t pin);
+void HAL_GPIO_WritePin (GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+void HAL_GPIO_TogglePin (GPIO_TypeDef* port, uint16_t pin);
+
+/* DMA ----------------------------------------------------------------------*/
+
+typedef struct {
+	__IO uint32_t CCR;
+	__IO uint32_t CNDTR;
+	__IO uint32_t CPAR;
+	__IO uint32_t CMAR;
+} DMA_Channel_TypeDef;
+
+extern DMA_Channel_TypeDef sim_dma1[3];
+#define DMA1_Channel1		(&sim_dma1[0])
+#define DMA1_Channel2		(&sim_dma1[1])
+#define DMA1_Channel3		(&sim_dma1[2])
+
+typedef struct {
+	uint32_t Request;
+	uint32_t Direction;
+	uint32_t PeriphInc;
+	uint32_t MemInc;
+	uint32_t PeriphDataAlignment;
+	uint32_t MemDataAlignment;
+	uint32_t Mode;
+	uint32_t Priority;
+} DMA_InitTypeDef;
+
+typedef struct {
+	DMA_Channel_TypeDef* Instance;
+	DMA_InitTypeDef Init;
+	void* Parent;
+} DMA_HandleTypeDef;
+
+#define DMA_REQUEST_ADC1			5U
+#define DMA_REQUEST_I2C1_TX			11U
+#define DMA_PERIPH_TO_MEMORY		0x00000000U
+#define DMA_MEMORY_TO_PERIPH		0x00000010U
+#define DMA_PINC_DISABLE			0x00000000U
+#define DMA_MINC_ENABLE				0x00000080U
+#define DMA_PDATAALIGN_BYTE			0x00000000U
+#define DMA_PDATAALIGN_HALFWORD		0x00000100U
+#define DMA_MDATAALIGN_BYTE			0x00000000U
+#define DMA_MDATAALIGN_HALFWORD		0x00000400U
+#define DMA_NORMAL					0x00000000U
+#define DMA_PRIORITY_LOW			0x00000000U
+
+#define __HAL_LINKDMA(HANDLE, FIELD, DMA)	\
+	do { \
+		(HANDLE)->FIELD = &(DMA); \
+		(DMA).Parent = (HANDLE); \
+	} while (0)
+
+HAL_StatusTypeDef HAL_DMA_Init (DMA_HandleTypeDef* hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit (DMA_HandleTypeDef* hdma);
+
+/* ADC ----------------------------------------------------------------------*/
+
+typedef struct {
+	__IO uint32_t ISR;
+	__IO uint32_t CR;
+	__IO uint32_t DR;
+} ADC_TypeDef;
+
+extern ADC_TypeDef sim_adc1;
+#define ADC1				(&sim_adc1)
+
+typedef struct {
+	uint32_t ClockPrescaler;
+	uint32_t Resolution;
+	uint32_t DataAlign;
+	uint32_t ScanConvMode;
+	uint32_t EOCSelection;
+	FunctionalState LowPowerAutoWait;
+	FunctionalState LowPowerAutoPowerOff;
+	FunctionalState ContinuousConvMode;
+	uint32_t NbrOfConversion;
+	FunctionalState DiscontinuousConvMode;
+	uint32_t ExternalTrigConv;
+	uint32_t ExternalTrigConvEdge;
+	FunctionalState DMAContinuousRequests;
+	uint32_t Overrun;
+	uint32_t SamplingTimeCommon1;
+	uint32_t SamplingTimeCommon2;
+	FunctionalState OversamplingMode;
+	uint32_t TriggerFrequencyMode;
+} ADC_InitTypeDef;
+
+typedef struct {
+	ADC_TypeDef* Instance;
+	ADC_InitTypeDef Init;
+	DMA_HandleTypeDef* DMA_Handle;
+} ADC_HandleTypeDef;
+
+typedef struct {
+	uint32_t Channel;
+	uint32_t Rank;
+	uint32_t SamplingTime;
+} ADC_ChannelConfTypeDef;
+
+#define ADC_CLOCK_SYNC_PCLK_DIV1		0x40000000U
+#define ADC_RESOLUTION_12B				0x00000000U
+#define ADC_DATAALIGN_RIGHT				0x00000000U
+#define ADC_SCAN_SEQ_FIXED				0x10000000U
+#define ADC_EOC_SINGLE_CONV				0x00000004U
+#define ADC_SOFTWARE_START				0x00000000U
+#define ADC_EXTERNALTRIGCONVEDGE_NONE	0x00000000U
+#define ADC_OVR_DATA_PRESERVED			0x00000000U
+#define ADC_SAMPLETIME_1CYCLE_5			0x00000000U
+#define ADC_TRIGGER_FREQ_HIGH			0x00000000U
+#define ADC_RANK_CHANNEL_NUMBER			0x00000001U
+#define ADC_CHANNEL_1					1U
+#define ADC_CHANNEL_11					11U
+#define ADC_CHANNEL_12					12U
+
+HAL_StatusTypeDef HAL_ADC_Init (ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_ConfigChannel (ADC_HandleTypeDef* hadc, ADC_ChannelConfTypeDef* config);
+HAL_StatusTypeDef HAL_ADC_Start_DMA (ADC_HandleTypeDef* hadc, uint32_t* data, uint32_t length);
+void HAL_ADC_MspInit (ADC_HandleTypeDef* hadc);
+void HAL_ADC_MspDeInit (ADC_HandleTypeDef* hadc);
+void HAL_ADC_ConvCpltCallback (ADC_HandleTypeDef* hadc);
+
+/* TIM ----------------------------------------------------------------------*/
+
+typedef struct {
+	__IO uint32_t CR1;
+	__IO uint32_t CR2;
+	__IO uint32_t SMCR;
+	__IO uint32_t DIER;
+	__IO uint32_t SR;
+	__IO uint32_t EGR;
+	__IO uint32_t CCMR1;
+	__IO uint32_t CCMR2;
+	__IO uint32_t CCER;
+	__IO uint32_t CNT;
+	__IO uint32_t PSC;
+	__IO uint32_t ARR;
+	__IO uint32_t RCR;
+	__IO uint32_t CCR1;
+	__IO uint32_t CCR2;
+	__IO uint32_t CCR3;
+	__IO uint32_t CCR4;
+} TIM_TypeDef;
+
+extern TIM_TypeDef sim_tim2;
+extern TIM_TypeDef sim_tim3;
+extern TIM_TypeDef sim_tim16;
+#define TIM2				(&sim_tim2)
+#define TIM3				(&sim_tim3)
+#define TIM16				(&sim_tim16)
+
+#define TIM_CR1_CEN			(1U << 0)
+#define TIM_DIER_UIE		(1U << 0)
+#define TIM_SR_UIF			(1U << 0)
+#define TIM_EGR_UG			(1U << 0)
+
+typedef struct {
+	uint32_t Prescaler;
+	uint32_t CounterMode;
+	uint32_t Period;
+	uint32_t ClockDivision;
+	uint32_t RepetitionCounter;
+	uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+	TIM_TypeDef* Instance;
+	TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+#define TIM_CHANNEL_1		0x00000000U
+#define TIM_CHANNEL_2		0x00000004U
+#define TIM_CHANNEL_3		0x00000008U
+#define TIM_CHANNEL_4		0x0000000CU
+
+#define __HAL_TIM_GET_AUTORELOAD(HANDLE)	((HANDLE)->Instance->ARR)
+#define __HAL_TIM_SET_COMPARE(HANDLE, CHANNEL, COMPARE) \
+	(*(&(HANDLE)->Instance->CCR1 + ((CHANNEL) >> 2U)) = (COMPARE))
+#define __HAL_TIM_GET_COMPARE(HANDLE, CHANNEL) \
+	(*(&(HANDLE)->Instance->CCR1 + ((CHANNEL) >> 2U)))
+
+HAL_StatusTypeDef HAL_TIM_PWM_Start (TIM_HandleTypeDef* htim, uint32_t channel);
+
+/* I2C ----------------------------------------------------------------------*/
+
+typedef struct {
+	__IO uint32_t ISR;
+} I2C_TypeDef;
+
+extern I2C_TypeDef sim_i2c1;
+#define I2C1				(&sim_i2c1)
+
+typedef struct {
+	uint32_t Timing;
+	uint32_t OwnAddress1;
+	uint32_t AddressingMode;
+} I2C_InitTypeDef;
+
+typedef struct {
+	I2C_TypeDef* Instance;
+	I2C_InitTypeDef Init;
+	DMA_HandleTypeDef* hdmatx;
+} I2C_HandleTypeDef;
+
+#define I2C_MEMADD_SIZE_8BIT	1U
+
+HAL_StatusTypeDef HAL_I2C_Init (I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit (I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2C_Mem_Write (I2C_HandleTypeDef* hi2c, uint16_t address, uint16_t mem_address,
+		uint16_t mem_size, uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA (I2C_HandleTypeDef* hi2c, uint16_t address, uint16_t mem_address,
+		uint16_t mem_size, uint8_t* data, uint16_t size);
+void HAL_I2C_MemTxCpltCallback (I2C_HandleTypeDef* hi2c);
+void HAL_I2C_ErrorCallback (I2C_HandleTypeDef* hi2c);
+
+/* SPI ----------------------------------------------------------------------*/
+
+typedef struct {
+	__IO uint32_t SR;
+} SPI_TypeDef;
+
+extern SPI_TypeDef sim_spi2;
+#define SPI2				(&sim_spi2)
+
+typedef struct {
+	uint32_t Mode;
+	uint32_t DataSize;
+	uint32_t BaudRatePrescaler;
+} SPI_InitTypeDef;
+
+typedef struct {
+	SPI_TypeDef* Instance;
+	SPI_InitTypeDef Init;
+} SPI_HandleTypeDef;
+
+#define SPI_DATASIZE_16BIT			0x00000F00U
+#define SPI_BAUDRATEPRESCALER_2		0x00000000U
+
+/* 16-bit frames, as hspi2 is configured: size counts frames */
+HAL_StatusTypeDef HAL_SPI_Transmit (SPI_HandleTypeDef* hspi, const uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive (SPI_HandleTypeDef* hspi, const uint8_t* tx_data, uint8_t* rx_data,
+		uint16_t size, uint32_t timeout);
+
+/* UART ---------------------------------------------------------------------*/
+
+typedef struct {
+	__IO uint32_t CR1;
+	__IO uint32_t ISR;
+	__IO uint32_t ICR;
+	__IO uint32_t RDR;
+	__IO uint32_t TDR;
+} USART_TypeDef;
+
+extern USART_TypeDef sim_usart2;
+#define USART2				(&sim_usart2)
+
+typedef struct {
+	uint32_t BaudRate;
+	uint32_t WordLength;
+	uint32_t StopBits;
+	uint32_t Parity;
+} UART_InitTypeDef;
+
+typedef struct {
+	USART_TypeDef* Instance;
+	UART_InitTypeDef Init;
+} UART_HandleTypeDef;
+
+#define UART_FLAG_ORE		(1U << 3)
+#define UART_FLAG_RXNE		(1U << 5)
+#define UART_CLEAR_OREF		(1U << 3)
+
+#define __HAL_UART_GET_FLAG(HANDLE, FLAG)	(((HANDLE)->Instance->ISR & (FLAG)) == (FLAG))
+#define __HAL_UART_CLEAR_OREFLAG(HANDLE)	((HANDLE)->Instance->ICR = UART_CLEAR_OREF)
+
+HAL_StatusTypeDef HAL_UART_Transmit (UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size, uint32_t timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_IT (UART_HandleTypeDef* huart, const uint8_t* data, uint16_t size);
+void HAL_UART_TxCpltCallback (UART_HandleTypeDef* huart);
+
+#endif /* SIM_STM32C0XX_HAL_H_ */
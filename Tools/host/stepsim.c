@@ -0,0 +1,667 @@
+/*
+ * stepsim.c
+ *
+ * Runs the whole firmware (app_main and every task) on the host against
+ * the simulated board in sim/, in virtual time, so hours or weeks of
+ * operation take seconds or minutes and give the same result every run.
+ *
+ * Inputs: an IMU trace fed to the LSM6DS model at its sample rate, and a
+ * script of timed button presses, joystick and pot positions.
+ * Outputs: the step count, the LED, buzzer and display changes as a CSV
+ * of events, PBM snapshots of the display, the USART2 output (trace
+ * dumps) and a summary with the scheduler's statistics.
+ *
+ * Script lines are "<time> <command> [arguments]", with times in seconds
+ * or with a ms/s/m/h/d suffix, and # comments:
+ *   press UP|DOWN|LEFT|RIGHT|CLICK [duration]   default 100ms
+ *   joystick X Y                                raw ADC counts, rest 2100 2200
+ *   pot VALUE                                   raw ADC counts
+ *   snapshot FILE.pbm                           display RAM, lit pixels black
+ *   dump                                        a byte on USART2: trace dump
+ *   i2c-stall on|off                            hold every I2C transfer, as a stuck bus
+ *
+ * Firmware code runs in no virtual time at all (see sim/sim_hal.c), so
+ * execution times in the summary are bus and wait time only: timing
+ * regressions show up as deadline misses and longer blocking transfers,
+ * not as slower code.
+ *
+ * stepsim-kernel is the same with APP_USE_KERNEL: the IMU in a thread of
+ * its own and the task table in another, switched by sim/sim_kernel.c.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "sim.h"
+#include "trace_io.h"
+#include "main.h"
+#include "scheduler.h"
+#include "supervisor.h"
+#include "app.h"
+#include "kernel.h"
+#include "state_machine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <time.h>
+
+#define DEFAULT_DURATION_US		60000000ULL
+#define DEFAULT_PRESS_US		100000ULL
+#define US_PER_S				1000000ULL
+#define MAX_LINE				256
+
+/* adc.c reads the pot from channel 1 and the joystick X and Y from channels 12 and 11 */
+#define POT_CHANNEL				1
+#define JOYSTICK_X_CHANNEL		12
+#define JOYSTICK_Y_CHANNEL		11
+#define REST_POT				2048
+#define REST_X					2100
+#define REST_Y					2200
+
+typedef enum {
+	ACTION_PRESS,
+	ACTION_RELEASE,
+	ACTION_JOYSTICK,
+	ACTION_POT,
+	ACTION_SNAPSHOT,
+	ACTION_DUMP,
+	ACTION_I2C_STALL,
+} action_type_t;
+
+typedef struct {
+	uint64_t time_us;
+	uint32_t line;			// keeps actions at the same time in script order
+	action_type_t type;
+	uint16_t value[2];
+	char* path;
+} action_t;
+
+typedef struct {
+	const char* name;
+	GPIO_TypeDef* port;
+	uint16_t pin;
+	GPIO_PinState pressed;
+} button_t;
+
+typedef struct {
+	const char* name;
+	GPIO_TypeDef* port;
+	uint16_t pin;
+} output_t;
+
+typedef struct {
+	uint64_t duration_us;
+	bool duration_set;
+	bool loop;
+	const char* trace_path;
+	const char* events_path;
+	const char* frame_path;
+	const char* uart_path;
+	const char* script_path;
+	long max_misses;
+} stepsim_options_t;
+
+/* Levels as buttons.c expects them: LEFT idles high, the others low */
+static const button_t buttons[] = {
+	{"UP",		SW1_GPIO_Port,				SW1_Pin,			GPIO_PIN_SET},
+	{"DOWN",	SW2_GPIO_Port,				SW2_Pin,			GPIO_PIN_SET},
+	{"LEFT",	SW4_GPIO_Port,				SW4_Pin,			GPIO_PIN_RESET},
+	{"RIGHT",	SW3_GPIO_Port,				SW3_Pin,			GPIO_PIN_SET},
+	{"CLICK",	JOYSTICK_CLICK_GPIO_Port,	JOYSTICK_CLICK_Pin,	GPIO_PIN_SET},
+};
+
+#define NUM_BUTTONS (sizeof(buttons) / sizeof(buttons[0]))
+
+static const output_t outputs[] = {
+	{"ds1",		RGB_DS1_GPIO_Port,		RGB_DS1_Pin},
+	{"ds2",		RGB_DS2_GPIO_Port,		RGB_DS2_Pin},
+	{"ds3",		RGB_DS3_GPIO_Port,		RGB_DS3_Pin},
+	{"ds4",		RGB_DS4_GPIO_Port,		RGB_DS4_Pin},
+	{"red",		RGB_RED_GPIO_Port,		RGB_RED_Pin},
+	{"green",	RGB_GREEN_GPIO_Port,	RGB_GREEN_Pin},
+	{"blue",	RGB_BLUE_GPIO_Port,		RGB_BLUE_Pin},
+	{"ld1",		LD1_GPIO_Port,			LD1_Pin},
+	{"ld2",		NUCLEO_LD2_GPIO_Port,	NUCLEO_LD2_Pin},
+};
+
+#define NUM_OUTPUTS (sizeof(outputs) / sizeof(outputs[0]))
+
+static action_t* actions = NULL;
+static uint32_t action_count = 0;
+static uint32_t next_action = 0;
+
+static trace_t trace;
+static bool trace_loop = false;
+static uint64_t sample_index = UINT64_MAX;
+static uint32_t true_steps = 0;		// trace labels presented so far
+
+static FILE* events = NULL;
+static FILE* uart = NULL;
+
+static int8_t output_levels[NUM_OUTPUTS];
+static uint32_t last_steps = 0;
+static uint32_t last_buzzer = 0;
+static uint32_t last_ds3_duty = 0;
+static uint32_t frame_bytes = 0;
+static bool frame_pending = false;
+static uint32_t frame_hash = 0;
+static uint32_t frame_count = 0;
+
+
+/* Seconds, or with a us/ms/s/m/h/d suffix; returns -1 if text is not a time */
+static int stepsim_ParseTime (const char* text, uint64_t* time_us)
+{
+	char* end;
+	double value = strtod (text, &end);
+	double scale;
+
+	if (end == text || value < 0.0) {
+		return -1;
+	}
+	if (strcmp (end, "us") == 0) {
+		scale = 1.0;
+	} else if (strcmp (end, "ms") == 0) {
+		scale = 1e3;
+	} else if (strcmp (end, "s") == 0 || *end == '\0') {
+		scale = 1e6;
+	} else if (strcmp (end, "m") == 0) {
+		scale = 60e6;
+	} else if (strcmp (end, "h") == 0) {
+		scale = 3600e6;
+	} else if (strcmp (end, "d") == 0) {
+		scale = 86400e6;
+	} else {
+		return -1;
+	}
+	*time_us = (uint64_t) (value * scale + 0.5);
+	return 0;
+}
+
+
+static action_t* stepsim_AddAction (uint64_t time_us, uint32_t line, action_type_t type)
+{
+	actions = realloc (actions, (action_count + 1) * sizeof(action_t));
+	if (actions == NULL) {
+		perror ("stepsim");
+		exit (2);
+	}
+	action_t* action = &actions[action_count++];
+	memset (action, 0, sizeof(*action));
+	action->time_us = time_us;
+	action->line = line;
+	action->type = type;
+	return action;
+}
+
+
+static int stepsim_CompareActions (const void* a, const void* b)
+{
+	const action_t* first = a;
+	const action_t* second = b;
+
+	if (first->time_us != second->time_us) {
+		return first->time_us < second->time_us ? -1 : 1;
+	}
+	return (first->line > second->line) - (first->line < second->line);
+}
+
+
+static int stepsim_FindButton (const char* name)
+{
+	for (uint32_t i = 0; i < NUM_BUTTONS; i++) {
+		if (strcasecmp (name, buttons[i].name) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+/* Returns 0 on success; reports the first bad line */
+static int stepsim_LoadScript (const char* path)
+{
+	FILE* file = fopen (path, "r");
+	if (file == NULL) {
+		perror (path);
+		return -1;
+	}
+
+	char line[MAX_LINE];
+	uint32_t number = 0;
+	int status = 0;
+
+	while (status == 0 && fgets (line, sizeof(line), file) != NULL) {
+		number++;
+		char* comment = strchr (line, '#');
+		if (comment != NULL) {
+			*comment = '\0';
+		}
+
+		char* words[4] = {NULL};
+		int count = 0;
+		for (char* word = strtok (line, " \t\r\n"); word != NULL && count < 4; word = strtok (NULL, " \t\r\n")) {
+			words[count++] = word;
+		}
+		if (count == 0) {
+			continue;
+		}
+
+		uint64_t time_us;
+		status = -1;
+		if (count < 2 || stepsim_ParseTime (words[0], &time_us) != 0) {
+			/* falls through to the error below */
+		} else if (strcmp (words[1], "press") == 0 && count >= 3) {
+			uint64_t duration_us = DEFAULT_PRESS_US;
+			int button = stepsim_FindButton (words[2]);
+			if (button >= 0 && (count < 4 || stepsim_ParseTime (words[3], &duration_us) == 0)) {
+				stepsim_AddAction (time_us, number, ACTION_PRESS)->value[0] = button;
+				stepsim_AddAction (time_us + duration_us, number, ACTION_RELEASE)->value[0] = button;
+				status = 0;
+			}
+		} else if (strcmp (words[1], "joystick") == 0 && count == 4) {
+			action_t* action = stepsim_AddAction (time_us, number, ACTION_JOYSTICK);
+			action->value[0] = (uint16_t) strtoul (words[2], NULL, 10);
+			action->value[1] = (uint16_t) strtoul (words[3], NULL, 10);
+			status = 0;
+		} else if (strcmp (words[1], "pot") == 0 && count == 3) {
+			stepsim_AddAction (time_us, number, ACTION_POT)->value[0] = (uint16_t) strtoul (words[2], NULL, 10);
+			status = 0;
+		} else if (strcmp (words[1], "snapshot") == 0 && count == 3) {
+			stepsim_AddAction (time_us, number, ACTION_SNAPSHOT)->path = strdup (words[2]);
+			status = 0;
+		} else if (strcmp (words[1], "dump") == 0 && count == 2) {
+			stepsim_AddAction (time_us, number, ACTION_DUMP);
+			status = 0;
+		} else if (strcmp (words[1], "i2c-stall") == 0 && count == 3
+				&& (strcmp (words[2], "on") == 0 || strcmp (words[2], "off") == 0)) {
+			stepsim_AddAction (time_us, number, ACTION_I2C_STALL)->value[0] = strcmp (words[2], "on") == 0;
+			status = 0;
+		}
+
+		if (status != 0) {
+			fprintf (stderr, "%s:%u: expected \"<time> press|joystick|pot|snapshot|dump|i2c-stall ...\"\n", path, number);
+		}
+	}
+	fclose (file);
+
+	qsort (actions, action_count, sizeof(action_t), stepsim_CompareActions);
+	return status;
+}
+
+
+static void stepsim_Log (uint64_t time_us, const char* signal, const char* value)
+{
+	if (events != NULL) {
+		fprintf (events, "%.3f,%s,%s\n", time_us / 1e3, signal, value);
+	}
+}
+
+
+static void stepsim_LogNumber (uint64_t time_us, const char* signal, uint32_t value)
+{
+	char text[16];
+	snprintf (text, sizeof(text), "%u", value);
+	stepsim_Log (time_us, signal, text);
+}
+
+
+/* Display RAM as a binary PBM, lit pixels black */
+static int stepsim_WritePbm (const char* path)
+{
+	FILE* file = fopen (path, "wb");
+	if (file == NULL) {
+		perror (path);
+		return -1;
+	}
+
+	const uint8_t* ram = sim_DisplayRamGetter ();
+	fprintf (file, "P4\n%d %d\n", SIM_DISPLAY_WIDTH, SIM_DISPLAY_PAGES * 8);
+	for (int y = 0; y < SIM_DISPLAY_PAGES * 8; y++) {
+		for (int x = 0; x < SIM_DISPLAY_WIDTH; x += 8) {
+			uint8_t packed = 0;
+			for (int bit = 0; bit < 8; bit++) {
+				uint8_t lit = (ram[(y / 8) * SIM_DISPLAY_WIDTH + x + bit] >> (y % 8)) & 1;
+				packed |= lit << (7 - bit);
+			}
+			fputc (packed, file);
+		}
+	}
+	fclose (file);
+	return 0;
+}
+
+
+/* FNV-1a over the display RAM */
+static uint32_t stepsim_FrameHash (void)
+{
+	const uint8_t* ram = sim_DisplayRamGetter ();
+	uint32_t hash = 2166136261U;
+
+	for (int i = 0; i < SIM_DISPLAY_PAGES * SIM_DISPLAY_WIDTH; i++) {
+		hash = (hash ^ ram[i]) * 16777619U;
+	}
+	return hash;
+}
+
+
+static void stepsim_RunActions (uint64_t time_us)
+{
+	while (next_action < action_count && actions[next_action].time_us <= time_us) {
+		const action_t* action = &actions[next_action++];
+		const button_t* button = &buttons[action->value[0]];
+
+		switch (action->type) {
+			case ACTION_PRESS:
+				sim_InputSet (button->port, button->pin, button->pressed);
+				break;
+			case ACTION_RELEASE:
+				sim_InputSet (button->port, button->pin, !button->pressed);
+				break;
+			case ACTION_JOYSTICK:
+				sim_AnalogSet (JOYSTICK_X_CHANNEL, action->value[0]);
+				sim_AnalogSet (JOYSTICK_Y_CHANNEL, action->value[1]);
+				break;
+			case ACTION_POT:
+				sim_AnalogSet (POT_CHANNEL, action->value[0]);
+				break;
+			case ACTION_SNAPSHOT:
+				stepsim_WritePbm (action->path);
+				break;
+			case ACTION_DUMP:
+				sim_UartReceive ('d');
+				break;
+			case ACTION_I2C_STALL:
+				sim_I2cStallSet (action->value[0]);
+				break;
+		}
+	}
+}
+
+
+/* Present the trace sample due at time_us; past the end it loops or holds the last sample */
+static void stepsim_FeedImu (uint64_t time_us)
+{
+	if (trace.count == 0) {
+		return;
+	}
+
+	uint64_t index = time_us * trace.rate_hz / US_PER_S;
+	while (sample_index != index) {
+		sample_index = sample_index == UINT64_MAX ? 0 : sample_index + 1;
+		if (trace_loop || sample_index < trace.count) {
+			true_steps += trace.step[sample_index % trace.count];
+		}
+	}
+
+	uint32_t sample = trace_loop ? index % trace.count : (index < trace.count ? index : trace.count - 1);
+	sim_ImuSet (trace.x[sample], trace.y[sample], trace.z[sample]);
+}
+
+
+/* Record what changed since the last tick */
+static void stepsim_Observe (uint64_t time_us)
+{
+	uint32_t steps = stateMachine_StepCountGetter ();
+	if (steps != last_steps) {
+		last_steps = steps;
+		stepsim_LogNumber (time_us, "steps", steps);
+	}
+
+	if (TIM16->CCR1 != last_buzzer) {
+		last_buzzer = TIM16->CCR1;
+		stepsim_LogNumber (time_us, "buzzer", last_buzzer);
+	}
+	if (TIM2->CCR3 != last_ds3_duty) {
+		last_ds3_duty = TIM2->CCR3;
+		stepsim_LogNumber (time_us, "ds3_pwm", last_ds3_duty);
+	}
+
+	/* a frame counts once the display has had no data for a whole tick */
+	sim_stats_t stats;
+	sim_StatsGetter (&stats);
+	if (sim_DisplayBusyGetter () || stats.display_bytes != frame_bytes) {
+		frame_bytes = stats.display_bytes;
+		frame_pending = true;
+	} else if (frame_pending) {
+		frame_pending = false;
+		uint32_t hash = stepsim_FrameHash ();
+		if (hash != frame_hash) {
+			char text[16];
+			frame_hash = hash;
+			frame_count++;
+			snprintf (text, sizeof(text), "%08x", hash);
+			stepsim_Log (time_us, "frame", text);
+		}
+	}
+}
+
+
+static void stepsim_Tick (uint64_t time_us)
+{
+	stepsim_RunActions (time_us);
+	stepsim_FeedImu (time_us);
+	stepsim_Observe (time_us);
+}
+
+
+static void stepsim_Output (GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state)
+{
+	for (uint32_t i = 0; i < NUM_OUTPUTS; i++) {
+		if (outputs[i].port == port && (outputs[i].pin & pin) && output_levels[i] != (int8_t) state) {
+			output_levels[i] = state;
+			stepsim_LogNumber (sim_TimeGetter (), outputs[i].name, state);
+		}
+	}
+}
+
+
+static void stepsim_Uart (const uint8_t* data, uint16_t size)
+{
+	if (uart != NULL) {
+		fwrite (data, 1, size, uart);
+	}
+}
+
+
+static void stepsim_PrintSummary (double host_s)
+{
+	sim_stats_t stats;
+	sim_StatsGetter (&stats);
+	double virtual_s = sim_TimeGetter () / (double) US_PER_S;
+
+	printf ("simulated %.3f s in %.3f s of host time (%.0fx)\n",
+			virtual_s, host_s, host_s > 0.0 ? virtual_s / host_s : 0.0);
+	printf ("steps      %u counted", stateMachine_StepCountGetter ());
+	if (trace.count > 0) {
+		printf (", %u in the trace", true_steps);
+	}
+	printf ("\ndisplay    %u frames, %u bytes, %u bus conflicts\n",
+			frame_count, stats.display_bytes, stats.bus_conflicts);
+	printf ("interrupts %u, spin skips %u\n", stats.interrupts, stats.spin_skips);
+#if APP_USE_KERNEL
+	/* switch cycles are always 0 here, as firmware code takes no virtual time */
+	kernel_switch_stats_t switches;
+	kernel_SwitchStatsGetter (&switches);
+	printf ("kernel     %u switches\n", switches.count);
+#endif
+	if (stats.watchdog_resets > 0) {
+		printf ("watchdog   expired at %.3f s, the run ends there\n", virtual_s);
+	}
+	supervisor_report_t report;
+	supervisor_ReportGetter (&report);
+	for (uint8_t i = 0; i < scheduler_TaskCountGetter (); i++) {
+		if (report.released & (1U << i)) {
+			printf ("supervisor released %s\n", scheduler_TaskGetter (i)->name);
+		}
+	}
+	printf ("\n");
+
+	printf ("%-10s %10s %8s %8s %8s %10s %10s\n", "task", "runs", "misses", "skipped", "caught", "mean us",
+			"max us");
+	for (uint8_t i = 0; i < scheduler_TaskCountGetter (); i++) {
+		scheduler_stats_t task;
+		scheduler_StatsGetter (i, &task);
+		printf ("%-10s %10u %8u %8u %8u %10.1f %10.1f\n", scheduler_TaskGetter (i)->name,
+				task.run_count, task.deadline_misses, task.skipped_periods, task.catch_up_runs,
+				task.mean_cycles / (double) SIM_CYCLES_PER_US, task.max_cycles / (double) SIM_CYCLES_PER_US);
+	}
+}
+
+
+static void stepsim_Usage (const char* program)
+{
+	fprintf (stderr,
+			"usage: %s [options] [script]\n"
+			"  -t, --trace FILE       IMU trace for the LSM6DS (default: lying still)\n"
+			"  -l, --loop             repeat the trace until the end of the run\n"
+			"  -d, --duration T       virtual time, seconds or with a ms/s/m/h/d suffix\n"
+			"                         (default: the trace, or 1m)\n"
+			"  -e, --events FILE      CSV of time_ms,signal,value for every output change\n"
+			"  -f, --frame FILE       final display contents as PBM\n"
+			"  -u, --uart FILE        everything sent on USART2\n"
+			"      --max-misses N     fail if the tasks missed more than N deadlines in total\n"
+			"traces are CSV (x,y,z[,step]), compact binary (.bin) or columnar log (.sct)\n",
+			program);
+}
+
+
+int main (int argc, char** argv)
+{
+	enum { OPT_MAX_MISSES = 256 };
+	static const struct option long_options[] = {
+		{"trace",		required_argument,	NULL, 't'},
+		{"loop",		no_argument,		NULL, 'l'},
+		{"duration",	required_argument,	NULL, 'd'},
+		{"events",		required_argument,	NULL, 'e'},
+		{"frame",		required_argument,	NULL, 'f'},
+		{"uart",		required_argument,	NULL, 'u'},
+		{"max-misses",	required_argument,	NULL, OPT_MAX_MISSES},
+		{"help",		no_argument,		NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	stepsim_options_t options = {
+		.duration_us = DEFAULT_DURATION_US,
+		.max_misses = -1,
+	};
+
+	int opt;
+	while ((opt = getopt_long (argc, argv, "t:ld:e:f:u:h", long_options, NULL)) != -1) {
+		switch (opt) {
+			case 't':
+				options.trace_path = optarg;
+				break;
+			case 'l':
+				options.loop = true;
+				break;
+			case 'd':
+				if (stepsim_ParseTime (optarg, &options.duration_us) != 0) {
+					fprintf (stderr, "stepsim: bad duration \"%s\"\n", optarg);
+					return 2;
+				}
+				options.duration_set = true;
+				break;
+			case 'e':
+				options.events_path = optarg;
+				break;
+			case 'f':
+				options.frame_path = optarg;
+				break;
+			case 'u':
+				options.uart_path = optarg;
+				break;
+			case OPT_MAX_MISSES:
+				options.max_misses = strtol (optarg, NULL, 10);
+				break;
+			default:
+				stepsim_Usage (argv[0]);
+				return opt == 'h' ? 0 : 2;
+		}
+	}
+	if (argc - optind > 1) {
+		stepsim_Usage (argv[0]);
+		return 2;
+	}
+	options.script_path = optind < argc ? argv[optind] : NULL;
+
+	trace_Init (&trace, TRACE_DEFAULT_RATE_HZ);
+	if (options.trace_path != NULL) {
+		if (trace_Load (options.trace_path, &trace) != 0) {
+			return 2;
+		}
+		if (!options.duration_set && !options.loop) {
+			options.duration_us = (uint64_t) trace.count * US_PER_S / trace.rate_hz;
+		}
+	}
+	trace_loop = options.loop;
+
+	if (options.script_path != NULL && stepsim_LoadScript (options.script_path) != 0) {
+		return 2;
+	}
+	if (options.events_path != NULL) {
+		events = fopen (options.events_path, "w");
+		if (events == NULL) {
+			perror (options.events_path);
+			return 2;
+		}
+		fprintf (events, "time_ms,signal,value\n");
+	}
+	if (options.uart_path != NULL) {
+		uart = fopen (options.uart_path, "wb");
+		if (uart == NULL) {
+			perror (options.uart_path);
+			return 2;
+		}
+	}
+
+	/* released buttons and a centred joystick until the script says otherwise */
+	for (uint32_t i = 0; i < NUM_BUTTONS; i++) {
+		sim_InputSet (buttons[i].port, buttons[i].pin, !buttons[i].pressed);
+	}
+	sim_AnalogSet (POT_CHANNEL, REST_POT);
+	sim_AnalogSet (JOYSTICK_X_CHANNEL, REST_X);
+	sim_AnalogSet (JOYSTICK_Y_CHANNEL, REST_Y);
+	memset (output_levels, -1, sizeof(output_levels));
+
+	static const sim_hooks_t hooks = {
+		.tick = stepsim_Tick,
+		.output = stepsim_Output,
+		.uart = stepsim_Uart,
+	};
+
+	struct timespec start;
+	struct timespec stop;
+	clock_gettime (CLOCK_MONOTONIC, &start);
+	sim_Run (&hooks, options.duration_us);
+	clock_gettime (CLOCK_MONOTONIC, &stop);
+
+	stepsim_PrintSummary ((stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9);
+
+	if (events != NULL) {
+		fclose (events);
+	}
+	if (uart != NULL) {
+		fclose (uart);
+	}
+	if (options.frame_path != NULL && stepsim_WritePbm (options.frame_path) != 0) {
+		return 2;
+	}
+	trace_Free (&trace);
+
+	sim_stats_t stats;
+	sim_StatsGetter (&stats);
+	if (stats.watchdog_resets > 0) {
+		printf ("FAIL: watchdog reset\n");
+		return 1;
+	}
+
+	uint32_t misses = scheduler_DeadlineMissesGetter ();
+	if (options.max_misses >= 0 && misses > (uint32_t) options.max_misses) {
+		printf ("FAIL: %u deadline misses exceed %ld\n", misses, options.max_misses);
+		return 1;
+	}
+	return 0;
+}
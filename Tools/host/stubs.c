@@ -0,0 +1,100 @@
+/*
+ * stubs.c
+ *
+ * Replaces the SPI accelerometer, rotary pot, buzzer and scheduler so that
+ * filter.c, peak_detection.c, state_machine.c and task_read_imu.c
+ * build and run unmodified on the host
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "stubs.h"
+#include "imu_lsm6ds.h"
+#include "rotary_pot.h"
+#include "task_buzzer.h"
+#include "scheduler.h"
+#include "trace.h"
+
+#define STUB_GOAL 1000
+
+static uint8_t imu_registers[OUTZ_H_XL - OUTX_L_XL + 1];
+static uint32_t buzzer_on_count = 0;
+
+
+void stubs_SetImuSample (int16_t x, int16_t y, int16_t z)
+{
+	imu_registers[OUTX_L_XL - OUTX_L_XL] = (uint8_t) x;
+	imu_registers[OUTX_H_XL - OUTX_L_XL] = (uint8_t) ((uint16_t) x >> 8);
+	imu_registers[OUTY_L_XL - OUTX_L_XL] = (uint8_t) y;
+	imu_registers[OUTY_H_XL - OUTX_L_XL] = (uint8_t) ((uint16_t) y >> 8);
+	imu_registers[OUTZ_L_XL - OUTX_L_XL] = (uint8_t) z;
+	imu_registers[OUTZ_H_XL - OUTX_L_XL] = (uint8_t) ((uint16_t) z >> 8);
+}
+
+
+uint32_t stubs_BuzzerOnCountGetter (void)
+{
+	return buzzer_on_count;
+}
+
+
+void imu_lsm6ds_write_byte (imu_register_t register_address, uint8_t value)
+{
+	(void) register_address;
+	(void) value;
+}
+
+
+uint8_t imu_lsm6ds_read_byte (imu_register_t register_address)
+{
+	if (register_address < OUTX_L_XL || register_address > OUTZ_H_XL) {
+		return 0;
+	}
+	return imu_registers[register_address - OUTX_L_XL];
+}
+
+
+uint32_t rotaryPot_ReadGoal (void)
+{
+	return STUB_GOAL;
+}
+
+
+void buzzer_TurnOn (void)
+{
+	buzzer_on_count++;
+}
+
+
+void buzzer_TurnOff (void)
+{
+}
+
+
+/* Replay has no time budget: coroutine tasks always run to the end */
+uint8_t scheduler_BudgetExpired (void)
+{
+	return 0;
+}
+
+
+void scheduler_Resume (uint32_t timeout_us)
+{
+	(void) timeout_us;
+}
+
+
+uint32_t scheduler_TimeGetter (void)
+{
+	return 0;
+}
+
+
+/* No recorder on the host */
+void trace_Record (uint8_t type, uint8_t id, uint16_t arg)
+{
+	(void) type;
+	(void) id;
+	(void) arg;
+}
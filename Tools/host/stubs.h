@@ -0,0 +1,20 @@
+/*
+ * stubs.h
+ *
+ * Host stand-ins for the hardware the step pipeline talks to
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef STUBS_H_
+#define STUBS_H_
+
+#include <stdint.h>
+
+/* Sample returned by the next OUT*_XL register reads of the LSM6DS stub */
+void stubs_SetImuSample (int16_t x, int16_t y, int16_t z);
+
+uint32_t stubs_BuzzerOnCountGetter (void);
+
+#endif /* STUBS_H_ */
@@ -0,0 +1,464 @@
+/*
+ * sweep.c
+ *
+ * Parameter sweep of the step detector over a corpus of recorded walks.
+ *
+ * Every point of the grid is compiled as its own specialisation of the
+ * firmware (sweep_kernel.c with -D overrides), cached as a shared object
+ * and evaluated on a work-stealing thread pool across all cores.
+ * Prints the Pareto front of accuracy (F1 of matched steps) against
+ * per-sample cost, and optionally writes every result to CSV.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "trace_io.h"
+#include "score.h"
+#include "pool.h"
+#include "sweep_kernel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <getopt.h>
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifndef SWEEP_HOST_DIR
+#define SWEEP_HOST_DIR "."
+#endif
+#ifndef SWEEP_CORE_DIR
+#define SWEEP_CORE_DIR "../../Core"
+#endif
+
+#define DEFAULT_CACHE_DIR		"build/sweep_cache"
+#define DEFAULT_TOLERANCE_MS	400
+#define MAX_VALUES				32
+#define MAX_COMMAND				2048
+#define MAX_PATH				512
+
+typedef enum {
+	PARAM_VAR_THRESHOLD,
+	PARAM_DELTA_MEAN_THRESHOLD,
+	PARAM_COOLDOWN_SAMPLES,
+	PARAM_ALPHA_SHIFT,
+	PARAM_N_SIZE,
+	NUM_PARAMS
+} param_id_t;
+
+typedef struct {
+	const char* name;
+	int32_t firmware_value;
+	int32_t values[MAX_VALUES];
+	uint32_t count;
+} sweep_param_t;
+
+/* Default grid, centred on the hand-tuned firmware values */
+static sweep_param_t params[NUM_PARAMS] = {
+	[PARAM_VAR_THRESHOLD]			= {"VAR_THRESHOLD", 50000, {30000, 40000, 50000, 60000, 70000}, 5},
+	[PARAM_DELTA_MEAN_THRESHOLD]	= {"DELTA_MEAN_THRESHOLD", 2700, {1700, 2200, 2700, 3200, 3700}, 5},
+	[PARAM_COOLDOWN_SAMPLES]		= {"COOLDOWN_SAMPLES", 30, {20, 25, 30, 35, 40}, 5},
+	[PARAM_ALPHA_SHIFT]				= {"ALPHA_SHIFT", 3, {2, 3, 4}, 3},
+	[PARAM_N_SIZE]					= {"N_SIZE", 64, {32, 48, 64, 80}, 4},
+};
+
+typedef struct {
+	bool ok;
+	bool pareto;
+	score_t score;
+	double ns_per_sample;
+} sweep_result_t;
+
+typedef struct {
+	const trace_t* traces;
+	int num_traces;
+	uint32_t max_samples;
+	uint32_t tolerance_ms;
+	const char* cache_dir;
+	const char* cc;
+	bool rebuild;
+	sweep_result_t* results;
+	uint32_t num_configs;
+	atomic_uint done;
+} sweep_context_t;
+
+
+/* Decode a flat config index into one value per parameter */
+static void sweep_ConfigValues (uint32_t config, int32_t* values)
+{
+	for (int p = NUM_PARAMS - 1; p >= 0; p--) {
+		values[p] = params[p].values[config % params[p].count];
+		config /= params[p].count;
+	}
+}
+
+
+static uint32_t sweep_NumConfigs (void)
+{
+	uint32_t configs = 1;
+	for (int p = 0; p < NUM_PARAMS; p++) {
+		configs *= params[p].count;
+	}
+	return configs;
+}
+
+
+/* Compile the specialisation unless it is already in the cache */
+static int sweep_Build (const sweep_context_t* context, const int32_t* values, char* path, size_t path_size)
+{
+	int length = snprintf (path, path_size, "%s/cfg", context->cache_dir);
+	for (int p = 0; p < NUM_PARAMS; p++) {
+		length += snprintf (path + length, path_size - (size_t) length, "_%d", values[p]);
+	}
+	snprintf (path + length, path_size - (size_t) length, ".so");
+
+	if (!context->rebuild && access (path, R_OK) == 0) {
+		return 0;
+	}
+
+	char command[MAX_COMMAND];
+	length = snprintf (command, sizeof(command),
+			"%s -O2 -std=gnu11 -shared -fPIC -fvisibility=hidden -I%s -I%s/Inc -I%s/Src",
+			context->cc, SWEEP_HOST_DIR, SWEEP_CORE_DIR, SWEEP_CORE_DIR);
+	for (int p = 0; p < NUM_PARAMS; p++) {
+		length += snprintf (command + length, sizeof(command) - (size_t) length,
+				" -D%s=%d", params[p].name, values[p]);
+	}
+	/* build to a temporary name so a cached object is never half written */
+	snprintf (command + length, sizeof(command) - (size_t) length,
+			" %s/sweep_kernel.c -o %s.tmp && mv %s.tmp %s",
+			SWEEP_HOST_DIR, path, path, path);
+
+	return system (command) == 0 ? 0 : -1;
+}
+
+
+static void sweep_Job (uint32_t config, void* argument)
+{
+	sweep_context_t* context = argument;
+	sweep_result_t* result = &context->results[config];
+	int32_t values[NUM_PARAMS];
+	char path[MAX_PATH];
+
+	memset (result, 0, sizeof(*result));
+	sweep_ConfigValues (config, values);
+
+	void* library = NULL;
+	uint32_t* detections = malloc ((context->max_samples + 1) * sizeof(uint32_t));
+	if (detections && sweep_Build (context, values, path, sizeof(path)) == 0) {
+		library = dlopen (path, RTLD_NOW | RTLD_LOCAL);
+	}
+
+	sweepKernel_Run_t run = library ? (sweepKernel_Run_t) dlsym (library, SWEEP_KERNEL_SYMBOL) : NULL;
+	if (run) {
+		uint64_t total_ns = 0;
+		uint64_t total_samples = 0;
+
+		for (int t = 0; t < context->num_traces; t++) {
+			const trace_t* trace = &context->traces[t];
+			uint64_t elapsed_ns = 0;
+			score_t score;
+
+			uint32_t num_detections = run (trace, detections, &elapsed_ns);
+			score_Match (trace, detections, num_detections, context->tolerance_ms, &score);
+			score_Accumulate (&result->score, &score);
+			total_ns += elapsed_ns;
+			total_samples += trace->count;
+		}
+		result->ns_per_sample = total_samples ? (double) total_ns / (double) total_samples : 0.0;
+		result->ok = true;
+	}
+
+	if (library) {
+		dlclose (library);
+	}
+	free (detections);
+
+	unsigned done = atomic_fetch_add (&context->done, 1) + 1;
+	if (done % 64 == 0 || done == context->num_configs) {
+		fprintf (stderr, "\rsweep: %u/%u configurations", done, context->num_configs);
+		if (done == context->num_configs) {
+			fputc ('\n', stderr);
+		}
+	}
+}
+
+
+/* Mark every result not beaten on both F1 and cost by a cheaper one */
+static uint32_t sweep_MarkPareto (sweep_result_t* results, uint32_t num_configs, uint32_t* order)
+{
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < num_configs; i++) {
+		if (results[i].ok) {
+			order[count++] = i;
+		}
+	}
+
+	/* insertion sort by cost, grids are a few thousand points at most */
+	for (uint32_t i = 1; i < count; i++) {
+		uint32_t key = order[i];
+		uint32_t j = i;
+		while (j > 0 && results[order[j - 1]].ns_per_sample > results[key].ns_per_sample) {
+			order[j] = order[j - 1];
+			j--;
+		}
+		order[j] = key;
+	}
+
+	double best_f1 = -1.0;
+	uint32_t front = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		sweep_result_t* result = &results[order[i]];
+		double f1 = score_F1 (&result->score);
+		if (f1 > best_f1) {
+			result->pareto = true;
+			best_f1 = f1;
+			order[front++] = order[i];
+		}
+	}
+	return front;
+}
+
+
+static void sweep_PrintHeader (void)
+{
+	for (int p = 0; p < NUM_PARAMS; p++) {
+		printf ("%*s ", (int) strlen (params[p].name), params[p].name);
+	}
+	printf ("%8s %8s %10s %10s\n", "F1", "count%", "abs_err_ms", "ns/sample");
+}
+
+
+static void sweep_PrintResult (uint32_t config, const sweep_result_t* result)
+{
+	int32_t values[NUM_PARAMS];
+	sweep_ConfigValues (config, values);
+
+	for (int p = 0; p < NUM_PARAMS; p++) {
+		printf ("%*d ", (int) strlen (params[p].name), values[p]);
+	}
+	double abs_error = result->score.matched
+			? (double) result->score.sum_abs_error_ms / result->score.matched : 0.0;
+	printf ("%8.4f %+8.2f %10.1f %10.2f\n", score_F1 (&result->score),
+			score_CountErrorPct (&result->score), abs_error, result->ns_per_sample);
+}
+
+
+static int sweep_WriteCsv (const char* path, const sweep_result_t* results, uint32_t num_configs)
+{
+	FILE* file = fopen (path, "w");
+	if (!file) {
+		fprintf (stderr, "sweep: cannot write %s\n", path);
+		return -1;
+	}
+
+	for (int p = 0; p < NUM_PARAMS; p++) {
+		fprintf (file, "%s,", params[p].name);
+	}
+	fprintf (file, "labels,detected,matched,f1,count_error_pct,mean_abs_error_ms,ns_per_sample,pareto\n");
+
+	for (uint32_t i = 0; i < num_configs; i++) {
+		const sweep_result_t* result = &results[i];
+		int32_t values[NUM_PARAMS];
+		if (!result->ok) {
+			continue;
+		}
+		sweep_ConfigValues (i, values);
+		for (int p = 0; p < NUM_PARAMS; p++) {
+			fprintf (file, "%d,", values[p]);
+		}
+		fprintf (file, "%u,%u,%u,%.6f,%.4f,%.2f,%.3f,%d\n",
+				result->score.labels, result->score.detected, result->score.matched,
+				score_F1 (&result->score), score_CountErrorPct (&result->score),
+				result->score.matched ? (double) result->score.sum_abs_error_ms / result->score.matched : 0.0,
+				result->ns_per_sample, result->pareto ? 1 : 0);
+	}
+	return fclose (file) == 0 ? 0 : -1;
+}
+
+
+/* NAME=v1,v2,... or NAME=start:stop:step */
+static int sweep_ParseParam (const char* spec)
+{
+	const char* equals = strchr (spec, '=');
+	if (!equals) {
+		return -1;
+	}
+
+	sweep_param_t* param = NULL;
+	for (int p = 0; p < NUM_PARAMS; p++) {
+		if (strlen (params[p].name) == (size_t) (equals - spec)
+				&& strncmp (spec, params[p].name, (size_t) (equals - spec)) == 0) {
+			param = &params[p];
+		}
+	}
+	if (!param) {
+		return -1;
+	}
+
+	const char* list = equals + 1;
+	long start, stop, step;
+	param->count = 0;
+	if (sscanf (list, "%ld:%ld:%ld", &start, &stop, &step) == 3 && step > 0) {
+		for (long value = start; value <= stop && param->count < MAX_VALUES; value += step) {
+			param->values[param->count++] = (int32_t) value;
+		}
+	} else {
+		char* end;
+		while (*list && param->count < MAX_VALUES) {
+			param->values[param->count++] = (int32_t) strtol (list, &end, 10);
+			if (end == list) {
+				return -1;
+			}
+			list = (*end == ',') ? end + 1 : end;
+		}
+	}
+	return param->count ? 0 : -1;
+}
+
+
+static void sweep_Usage (const char* program)
+{
+	fprintf (stderr,
+			"usage: %s [options] trace...\n"
+			"  -p, --param NAME=LIST   values to sweep, LIST is v1,v2,... or start:stop:step\n"
+			"  -j, --jobs N            worker threads (default: all cores)\n"
+			"  -t, --tolerance MS      step match window (default %d)\n"
+			"  -o, --output FILE       write every result as CSV\n"
+			"  -c, --cache DIR         compiled configurations (default %s)\n"
+			"      --rebuild           recompile cached configurations\n"
+			"parameters:",
+			program, DEFAULT_TOLERANCE_MS, DEFAULT_CACHE_DIR);
+	for (int p = 0; p < NUM_PARAMS; p++) {
+		fprintf (stderr, " %s", params[p].name);
+	}
+	fputc ('\n', stderr);
+}
+
+
+int main (int argc, char** argv)
+{
+	enum { OPT_REBUILD = 256 };
+	static const struct option long_options[] = {
+		{"param",		required_argument,	NULL, 'p'},
+		{"jobs",		required_argument,	NULL, 'j'},
+		{"tolerance",	required_argument,	NULL, 't'},
+		{"output",		required_argument,	NULL, 'o'},
+		{"cache",		required_argument,	NULL, 'c'},
+		{"rebuild",		no_argument,		NULL, OPT_REBUILD},
+		{"help",		no_argument,		NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	sweep_context_t context = {
+		.tolerance_ms = DEFAULT_TOLERANCE_MS,
+		.cache_dir = DEFAULT_CACHE_DIR,
+		.cc = getenv ("CC") ? getenv ("CC") : "cc",
+	};
+	unsigned threads = pool_DefaultThreads ();
+	const char* output = NULL;
+
+	int opt;
+	while ((opt = getopt_long (argc, argv, "p:j:t:o:c:h", long_options, NULL)) != -1) {
+		switch (opt) {
+			case 'p':
+				if (sweep_ParseParam (optarg) != 0) {
+					fprintf (stderr, "sweep: bad parameter \"%s\"\n", optarg);
+					return 2;
+				}
+				break;
+			case 'j':
+				threads = (unsigned) strtoul (optarg, NULL, 10);
+				break;
+			case 't':
+				context.tolerance_ms = (uint32_t) strtoul (optarg, NULL, 10);
+				break;
+			case 'o':
+				output = optarg;
+				break;
+			case 'c':
+				context.cache_dir = optarg;
+				break;
+			case OPT_REBUILD:
+				context.rebuild = true;
+				break;
+			default:
+				sweep_Usage (argv[0]);
+				return opt == 'h' ? 0 : 2;
+		}
+	}
+
+	if (optind >= argc) {
+		sweep_Usage (argv[0]);
+		return 2;
+	}
+
+	context.num_traces = argc - optind;
+	trace_t* traces = calloc ((size_t) context.num_traces, sizeof(trace_t));
+	for (int t = 0; t < context.num_traces; t++) {
+		trace_Init (&traces[t], TRACE_DEFAULT_RATE_HZ);
+		if (trace_Load (argv[optind + t], &traces[t]) != 0) {
+			return 2;
+		}
+		if (traces[t].count > context.max_samples) {
+			context.max_samples = traces[t].count;
+		}
+	}
+	context.traces = traces;
+
+	mkdir (context.cache_dir, 0755);
+	context.num_configs = sweep_NumConfigs ();
+	context.results = calloc (context.num_configs, sizeof(sweep_result_t));
+	uint32_t* order = calloc (context.num_configs, sizeof(uint32_t));
+	atomic_init (&context.done, 0);
+
+	fprintf (stderr, "sweep: %u configurations x %d traces on %u threads\n",
+			context.num_configs, context.num_traces, threads);
+	pool_Run (context.num_configs, threads, sweep_Job, &context);
+
+	uint32_t failed = 0;
+	for (uint32_t i = 0; i < context.num_configs; i++) {
+		failed += context.results[i].ok ? 0 : 1;
+	}
+	if (failed) {
+		fprintf (stderr, "sweep: %u configurations failed to build or load\n", failed);
+	}
+
+	uint32_t front = sweep_MarkPareto (context.results, context.num_configs, order);
+	printf ("Pareto front (F1 vs. ns/sample), %u of %u configurations\n", front, context.num_configs);
+	sweep_PrintHeader ();
+	for (uint32_t i = 0; i < front; i++) {
+		sweep_PrintResult (order[i], &context.results[order[i]]);
+	}
+
+	/* firmware defaults for comparison, when they are on the grid */
+	for (uint32_t i = 0; i < context.num_configs; i++) {
+		int32_t values[NUM_PARAMS];
+		bool is_firmware = context.results[i].ok;
+		sweep_ConfigValues (i, values);
+		for (int p = 0; p < NUM_PARAMS; p++) {
+			is_firmware = is_firmware && values[p] == params[p].firmware_value;
+		}
+		if (is_firmware) {
+			printf ("Current firmware\n");
+			sweep_PrintResult (i, &context.results[i]);
+		}
+	}
+
+	int status = 0;
+	if (output && sweep_WriteCsv (output, context.results, context.num_configs) != 0) {
+		status = 2;
+	}
+
+	for (int t = 0; t < context.num_traces; t++) {
+		trace_Free (&traces[t]);
+	}
+	free (traces);
+	free (context.results);
+	free (order);
+	return status;
+}
@@ -0,0 +1,52 @@
+/*
+ * sweep_kernel.c
+ *
+ * One detector configuration, compiled by sweep into its own shared
+ * object with the tuning constants given as -D flags. The firmware
+ * modules are included directly so the constants are folded and the
+ * per-sample calls inlined, as a specialisation rather than a runtime
+ * parameter. Each object has private copies of the module statics.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "task_read_imu.c"
+#include "filter.c"
+#include "peak_detection.c"
+#include "state_machine.c"
+#include "ring_buffer.c"
+#include "stubs.c"
+
+#include "sweep_kernel.h"
+
+#include <time.h>
+
+
+__attribute__((visibility("default")))
+uint32_t sweepKernel_Run (const trace_t* trace, uint32_t* detections, uint64_t* elapsed_ns)
+{
+	uint32_t num_detections = 0;
+	struct timespec start, end;
+
+	stateMachine_Init ();
+	imu_Init ();
+	uint32_t steps = stateMachine_StepCountGetter ();
+
+	clock_gettime (CLOCK_MONOTONIC, &start);
+	for (uint32_t i = 0; i < trace->count; i++) {
+		stubs_SetImuSample (trace->x[i], trace->y[i], trace->z[i]);
+		imu_Execute ();
+
+		uint32_t now_steps = stateMachine_StepCountGetter ();
+		if (now_steps != steps) {
+			detections[num_detections++] = i;
+			steps = now_steps;
+		}
+	}
+	clock_gettime (CLOCK_MONOTONIC, &end);
+
+	*elapsed_ns = (uint64_t) (end.tv_sec - start.tv_sec) * 1000000000ull
+			+ (uint64_t) end.tv_nsec - (uint64_t) start.tv_nsec;
+	return num_detections;
+}
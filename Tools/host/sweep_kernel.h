@@ -0,0 +1,26 @@
+/*
+ * sweep_kernel.h
+ *
+ * Entry point of one compiled detector configuration
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef SWEEP_KERNEL_H_
+#define SWEEP_KERNEL_H_
+
+#include "trace_io.h"
+
+#include <stdint.h>
+
+#define SWEEP_KERNEL_SYMBOL "sweepKernel_Run"
+
+/*
+ * Reset the pipeline, run every sample of the trace through imu_Execute
+ * and write the sample index of each detected step to detections
+ * (trace->count entries). Returns the number of detections.
+ */
+typedef uint32_t (*sweepKernel_Run_t)(const trace_t* trace, uint32_t* detections, uint64_t* elapsed_ns);
+
+#endif /* SWEEP_KERNEL_H_ */
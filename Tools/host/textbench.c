@@ -0,0 +1,276 @@
+/*
+ * textbench.c
+ *
+ * Times ssd1306_WriteString from the firmware driver for each font, at
+ * every row offset within a page, and prints a hash of the screenbuffer
+ * that results. The Makefile builds it twice: textbench with the column
+ * blitter and textbench-pixel with per-pixel drawing (SSD1306_BLIT_TEXT=0).
+ * The two must print the same hashes; the times compare the two. The
+ * page-major UI font (PageFont_7x10) is timed next and must match 7x10.
+ * Last, the display's lines are built with format.c and with snprintf,
+ * timed, and checked to be the same text.
+ *
+ * The screenbuffer is read back through the driver's own flush, with the
+ * I2C calls below standing in for the HAL.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "ssd1306.h"
+#include "ssd1306_fonts.h"
+#include "format.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#define DEFAULT_REPEATS		20000
+#define FNV_OFFSET			2166136261U
+#define FNV_PRIME			16777619U
+#define LINE_SIZE			32
+
+I2C_HandleTypeDef hi2c1;
+
+static uint32_t frame_hash;
+
+typedef struct {
+	const char* name;
+	const SSD1306_Font_t* font;
+} bench_font_t;
+
+static const bench_font_t fonts[] = {
+	{"6x8",		&Font_6x8},
+	{"7x10",	&Font_7x10},
+	{"11x18",	&Font_11x18},
+	{"16x15",	&Font_16x15},
+	{"16x24",	&Font_16x24},
+	{"16x26",	&Font_16x26},
+};
+
+
+/* The driver's bus calls; flushed pages are hashed in the order they arrive */
+HAL_StatusTypeDef HAL_I2C_Mem_Write (I2C_HandleTypeDef* hi2c, uint16_t address, uint16_t mem_address,
+		uint16_t mem_size, uint8_t* data, uint16_t size, uint32_t timeout)
+{
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA (I2C_HandleTypeDef* hi2c, uint16_t address, uint16_t mem_address,
+		uint16_t mem_size, uint8_t* data, uint16_t size)
+{
+	for (uint16_t i = 0; i < size; i++) {
+		frame_hash = (frame_hash ^ data[i]) * FNV_PRIME;
+	}
+	HAL_I2C_MemTxCpltCallback (hi2c);
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_I2C_Init (I2C_HandleTypeDef* hi2c)
+{
+	return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_I2C_DeInit (I2C_HandleTypeDef* hi2c)
+{
+	return HAL_OK;
+}
+
+
+void HAL_Delay (uint32_t delay)
+{
+}
+
+
+/* Every transfer completes at once, so none times out */
+uint32_t timebase_Micros32Getter (void)
+{
+	return 0;
+}
+
+
+/* Nothing interrupts the bench */
+void __disable_irq (void)
+{
+}
+
+
+uint32_t __get_PRIMASK (void)
+{
+	return 0;
+}
+
+
+void __set_PRIMASK (uint32_t primask)
+{
+}
+
+
+void app_Wake (void)
+{
+}
+
+
+void trace_Record (uint8_t type, uint8_t id, uint16_t arg)
+{
+}
+
+
+/* A value for each line kind, spread over the digit counts */
+static const uint32_t format_values[] = {0, 7, 95, 1234, 12345, 999999, 4294967295U};
+
+typedef enum {
+	LINE_STEPS,
+	LINE_DISTANCE,
+	LINE_PROGRESS,
+	NUM_LINES
+} line_kind_t;
+
+static const char* const line_names[NUM_LINES] = {"steps", "dist", "goal"};
+
+
+static void textbench_FormatLine (line_kind_t kind, uint32_t value, char* out)
+{
+	char* end;
+
+	switch (kind) {
+		case LINE_STEPS:
+			format_Unsigned (format_String (out, "Steps: "), value, 1);
+			break;
+		case LINE_DISTANCE:
+			end = format_Fixed (format_String (out, "Dist: "), value, 2);
+			format_String (end, " km");
+			break;
+		default:
+			end = format_String (format_Unsigned (out, value, 1), " steps / ");
+			format_Unsigned (end, 10000, 1);
+			break;
+	}
+}
+
+
+static void textbench_PrintfLine (line_kind_t kind, uint32_t value, char* out)
+{
+	switch (kind) {
+		case LINE_STEPS:
+			snprintf (out, LINE_SIZE, "Steps: %lu", (unsigned long) value);
+			break;
+		case LINE_DISTANCE:
+			snprintf (out, LINE_SIZE, "Dist: %lu.%02lu km", (unsigned long) value / 100,
+					(unsigned long) value % 100);
+			break;
+		default:
+			snprintf (out, LINE_SIZE, "%lu steps / %lu", (unsigned long) value, 10000UL);
+			break;
+	}
+}
+
+
+/* Hash of the whole screenbuffer */
+static uint32_t textbench_Hash (void)
+{
+	frame_hash = FNV_OFFSET;
+	ssd1306_InvalidateScreen ();
+	ssd1306_UpdateScreen ();
+	while (!ssd1306_ProcessEvents ()) {
+	}
+	return frame_hash;
+}
+
+
+static double textbench_Now (void)
+{
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+int main (int argc, char** argv)
+{
+	unsigned repeats = argc > 1 ? strtoul (argv[1], NULL, 0) : DEFAULT_REPEATS;
+	const char* line = "Steps: 12345";
+
+	if (argc > 2 || repeats == 0) {
+		fprintf (stderr, "usage: %s [repeats]\n", argv[0]);
+		return 2;
+	}
+
+	printf ("%s drawing, \"%s\", %u repeats\n", SSD1306_BLIT_TEXT ? "column" : "pixel", line, repeats);
+	printf ("font    y  ns/string  ns/char  hash\n");
+
+	for (size_t f = 0; f < sizeof(fonts) / sizeof(fonts[0]); f++) {
+		const SSD1306_Font_t* font = fonts[f].font;
+		/* as many characters as fit on a line */
+		char text[16];
+		size_t length = SSD1306_WIDTH / font->width;
+		snprintf (text, length < sizeof(text) ? length + 1 : sizeof(text), "%s", line);
+
+		for (uint8_t y = 0; y < 8 && y + font->height <= SSD1306_HEIGHT; y++) {
+			ssd1306_Fill (Black);
+			double start = textbench_Now ();
+			/* alternate colours so each string overwrites the previous one's background */
+			for (unsigned r = 0; r < repeats; r++) {
+				ssd1306_SetCursor (0, y);
+				ssd1306_WriteString (text, *font, (r & 1) ? Black : White);
+			}
+			double elapsed = textbench_Now () - start;
+
+			double per_string = elapsed * 1e9 / repeats;
+			printf ("%-6s %2u  %9.0f  %7.1f  %08x\n", fonts[f].name, y, per_string,
+					per_string / strlen (text), textbench_Hash ());
+		}
+	}
+	for (uint8_t y = 0; y < 8; y++) {
+		ssd1306_Fill (Black);
+		double start = textbench_Now ();
+		for (unsigned r = 0; r < repeats; r++) {
+			ssd1306_SetCursor (0, y);
+			ssd1306_WritePageString (line, &PageFont_7x10, (r & 1) ? Black : White);
+		}
+		double elapsed = textbench_Now () - start;
+
+		double per_string = elapsed * 1e9 / repeats;
+		printf ("%-6s %2u  %9.0f  %7.1f  %08x\n", "p7x10", y, per_string,
+				per_string / strlen (line), textbench_Hash ());
+	}
+
+	printf ("\nline   ns format  ns snprintf\n");
+	int mismatches = 0;
+	for (line_kind_t kind = 0; kind < NUM_LINES; kind++) {
+		size_t count = sizeof(format_values) / sizeof(format_values[0]);
+		char formatted[LINE_SIZE];
+		char printed[LINE_SIZE];
+		double elapsed[2];
+
+		for (int use_printf = 0; use_printf < 2; use_printf++) {
+			double start = textbench_Now ();
+			for (unsigned r = 0; r < repeats; r++) {
+				for (size_t i = 0; i < count; i++) {
+					if (use_printf) {
+						textbench_PrintfLine (kind, format_values[i], printed);
+					} else {
+						textbench_FormatLine (kind, format_values[i], formatted);
+					}
+				}
+			}
+			elapsed[use_printf] = (textbench_Now () - start) * 1e9 / (repeats * count);
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			textbench_FormatLine (kind, format_values[i], formatted);
+			textbench_PrintfLine (kind, format_values[i], printed);
+			if (strcmp (formatted, printed) != 0) {
+				printf ("mismatch: \"%s\", snprintf \"%s\"\n", formatted, printed);
+				mismatches++;
+			}
+		}
+		printf ("%-6s %9.1f  %11.1f\n", line_names[kind], elapsed[0], elapsed[1]);
+	}
+	return mismatches != 0;
+}
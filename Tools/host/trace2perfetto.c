@@ -0,0 +1,311 @@
+/*
+ * trace2perfetto.c
+ *
+ * Converts a trace dump from the firmware (trace_Dump, see Core/Inc/trace.h)
+ * into Chrome trace event JSON, which ui.perfetto.dev and chrome://tracing
+ * open directly. Tasks, interrupts, each DMA channel, detected steps and
+ * watchdog resets get a track of their own, so interference between them
+ * shows up side by side. Timestamps restart after a watchdog reset; the
+ * events after it are placed straight after the last one before it.
+ *
+ * The dump may be preceded by anything else read from the serial port; the
+ * first "SCTE" marks its start.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "trace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define MAX_TASKS		32
+#define PID				1
+
+enum {
+	TRACK_TASKS = 1,
+	TRACK_INTERRUPTS,
+	TRACK_DMA_ADC,
+	TRACK_DMA_DISPLAY,
+	TRACK_STEPS,
+	TRACK_RESETS,
+	NUM_TRACKS
+};
+
+static const char* const track_names[NUM_TRACKS] = {
+	[TRACK_TASKS] = "tasks",
+	[TRACK_INTERRUPTS] = "interrupts",
+	[TRACK_DMA_ADC] = "DMA ADC",
+	[TRACK_DMA_DISPLAY] = "DMA display",
+	[TRACK_STEPS] = "steps",
+	[TRACK_RESETS] = "watchdog",
+};
+
+static const char* const isr_names[] = {
+	[TRACE_ISR_SYSTICK] = "SysTick",
+	[TRACE_ISR_DMA_ADC] = "DMA1_Channel1",
+	[TRACE_ISR_DMA_I2C] = "DMA1_Channel2_3",
+	[TRACE_ISR_I2C1] = "I2C1",
+};
+
+typedef struct {
+	uint32_t clock_hz;
+	uint32_t count;
+	uint32_t lost;
+	uint16_t task_count;
+	const char* task_names[MAX_TASKS];
+	const uint8_t* events;
+} dump_t;
+
+
+static uint16_t trace2perfetto_Get16 (const uint8_t* in)
+{
+	return in[0] | (in[1] << 8);
+}
+
+
+static uint32_t trace2perfetto_Get32 (const uint8_t* in)
+{
+	return trace2perfetto_Get16 (in) | ((uint32_t) trace2perfetto_Get16 (in + 2) << 16);
+}
+
+
+static uint8_t* trace2perfetto_ReadFile (const char* path, size_t* size)
+{
+	FILE* file = fopen (path, "rb");
+	if (file == NULL) {
+		perror (path);
+		return NULL;
+	}
+
+	size_t capacity = 1 << 16;
+	uint8_t* data = malloc (capacity);
+	*size = 0;
+	size_t n;
+	while (data != NULL && (n = fread (data + *size, 1, capacity - *size, file)) > 0) {
+		*size += n;
+		if (*size == capacity) {
+			capacity *= 2;
+			data = realloc (data, capacity);
+		}
+	}
+	fclose (file);
+	return data;
+}
+
+
+/* Find the dump in data and check it fits; returns 0 on success */
+static int trace2perfetto_Parse (uint8_t* data, size_t size, dump_t* dump)
+{
+	uint8_t* start = NULL;
+	for (size_t i = 0; i + TRACE_HEADER_SIZE <= size; i++) {
+		if (memcmp (&data[i], TRACE_MAGIC, 4) == 0) {
+			start = &data[i];
+			break;
+		}
+	}
+	if (start == NULL) {
+		fprintf (stderr, "no \"%s\" header found\n", TRACE_MAGIC);
+		return -1;
+	}
+
+	size_t remaining = size - (start - data);
+	uint16_t version = trace2perfetto_Get16 (&start[4]);
+	uint16_t event_size = trace2perfetto_Get16 (&start[6]);
+	if (version != TRACE_VERSION || event_size != TRACE_EVENT_SIZE) {
+		fprintf (stderr, "unsupported dump: version %u, event size %u\n", version, event_size);
+		return -1;
+	}
+	dump->clock_hz = trace2perfetto_Get32 (&start[8]);
+	dump->count = trace2perfetto_Get32 (&start[12]);
+	dump->lost = trace2perfetto_Get32 (&start[16]);
+	uint16_t names_bytes = trace2perfetto_Get16 (&start[20]);
+
+	if (dump->clock_hz == 0 || remaining < TRACE_HEADER_SIZE + (size_t) names_bytes) {
+		fprintf (stderr, "truncated or corrupt header\n");
+		return -1;
+	}
+
+	/* the names block is NUL terminated names back to back */
+	char* names = (char*) &start[TRACE_HEADER_SIZE];
+	if (names_bytes > 0) {
+		names[names_bytes - 1] = '\0';
+	}
+	dump->task_count = 0;
+	for (uint16_t offset = 0; offset < names_bytes && dump->task_count < MAX_TASKS; ) {
+		dump->task_names[dump->task_count++] = &names[offset];
+		offset += strnlen (&names[offset], names_bytes - offset) + 1;
+	}
+
+	size_t available = (remaining - TRACE_HEADER_SIZE - names_bytes) / TRACE_EVENT_SIZE;
+	if (available < dump->count) {
+		fprintf (stderr, "warning: dump truncated, %zu of %u events\n", available, dump->count);
+		dump->count = available;
+	}
+	dump->events = &start[TRACE_HEADER_SIZE + names_bytes];
+	return 0;
+}
+
+
+static void trace2perfetto_Event (FILE* out, int* first, const char* name, const char* phase,
+		int track, double ts_us, const char* args)
+{
+	fprintf (out, "%s\n{\"name\":\"%s\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d%s%s}",
+			*first ? "" : ",", name, phase, ts_us, PID, track, args[0] ? "," : "", args);
+	*first = 0;
+}
+
+
+static void trace2perfetto_Convert (const dump_t* dump, FILE* out)
+{
+	int first = 1;
+	int depth[NUM_TRACKS] = {0};
+	uint64_t elapsed = 0;	// in clock_hz units
+	uint32_t previous = 0;
+	char name[32];
+	char args[64];
+
+	fprintf (out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	for (int track = TRACK_TASKS; track < NUM_TRACKS; track++) {
+		snprintf (args, sizeof(args), "\"args\":{\"name\":\"%s\"}", track_names[track]);
+		trace2perfetto_Event (out, &first, "thread_name", "M", track, 0.0, args);
+	}
+
+	for (uint32_t i = 0; i < dump->count; i++) {
+		const uint8_t* event = &dump->events[i * TRACE_EVENT_SIZE];
+		uint32_t stamp = trace2perfetto_Get32 (event);
+		uint8_t type = event[4];
+		uint8_t id = event[5];
+		uint16_t arg = trace2perfetto_Get16 (&event[6]);
+
+		/*
+		 * unwrap: consecutive events are much less than 2^31 counts apart, either way, as an
+		 * interrupt can record between an event's stamp and its slot; the clock restarts after a reset
+		 */
+		if (i > 0 && type != TRACE_RESET) {
+			elapsed += (int64_t) (int32_t) (stamp - previous);
+		}
+		previous = stamp;
+		double ts_us = elapsed * 1e6 / dump->clock_hz;
+
+		int track;
+		const char* phase;
+		args[0] = '\0';
+
+		switch (type) {
+			case TRACE_TASK_START:
+			case TRACE_TASK_STOP:
+				track = TRACK_TASKS;
+				phase = type == TRACE_TASK_START ? "B" : "E";
+				if (id < dump->task_count) {
+					snprintf (name, sizeof(name), "%s", dump->task_names[id]);
+				} else {
+					snprintf (name, sizeof(name), "task %u", id);
+				}
+				break;
+
+			case TRACE_ISR_ENTER:
+			case TRACE_ISR_EXIT:
+				track = TRACK_INTERRUPTS;
+				phase = type == TRACE_ISR_ENTER ? "B" : "E";
+				if (id < sizeof(isr_names) / sizeof(isr_names[0])) {
+					snprintf (name, sizeof(name), "%s", isr_names[id]);
+				} else {
+					snprintf (name, sizeof(name), "isr %u", id);
+				}
+				break;
+
+			case TRACE_DMA_START:
+			case TRACE_DMA_COMPLETE:
+				track = id == TRACE_DMA_ADC ? TRACK_DMA_ADC : TRACK_DMA_DISPLAY;
+				phase = type == TRACE_DMA_START ? "B" : "E";
+				snprintf (name, sizeof(name), "%s", id == TRACE_DMA_ADC ? "ADC" : "page");
+				if (type == TRACE_DMA_START) {
+					snprintf (args, sizeof(args), "\"args\":{\"size\":%u}", arg);
+				}
+				break;
+
+			case TRACE_STEP:
+				track = TRACK_STEPS;
+				phase = "i";
+				snprintf (name, sizeof(name), "step");
+				snprintf (args, sizeof(args), "\"s\":\"t\",\"args\":{\"steps\":%u}", arg);
+				break;
+
+			case TRACE_RESET:
+				/* what was running never finished */
+				for (int open = TRACK_TASKS; open < NUM_TRACKS; open++) {
+					for (; depth[open] > 0; depth[open]--) {
+						trace2perfetto_Event (out, &first, "reset", "E", open, ts_us, "");
+					}
+				}
+				track = TRACK_RESETS;
+				phase = "i";
+				snprintf (name, sizeof(name), "watchdog reset");
+				snprintf (args, sizeof(args), "\"s\":\"g\",\"args\":{\"task\":\"%s\",\"resets\":%u}",
+						id < dump->task_count ? dump->task_names[id] : "none", arg);
+				break;
+
+			default:
+				fprintf (stderr, "warning: unknown event type %u at %u\n", type, i);
+				continue;
+		}
+
+		/* the oldest events may have lost their start to the ring wrapping */
+		if (phase[0] == 'E') {
+			if (depth[track] == 0) {
+				continue;
+			}
+			depth[track]--;
+		} else if (phase[0] == 'B') {
+			depth[track]++;
+		}
+		trace2perfetto_Event (out, &first, name, phase, track, ts_us, args);
+	}
+	fprintf (out, "\n]}\n");
+
+	fprintf (stderr, "%u events over %.3f ms, %u older events lost\n",
+			dump->count, elapsed * 1e3 / dump->clock_hz, dump->lost);
+}
+
+
+int main (int argc, char** argv)
+{
+	if (argc < 2 || argc > 3) {
+		fprintf (stderr, "usage: %s dump.bin [out.json]\n", argv[0]);
+		return 2;
+	}
+
+	size_t size;
+	uint8_t* data = trace2perfetto_ReadFile (argv[1], &size);
+	if (data == NULL) {
+		return 1;
+	}
+
+	dump_t dump;
+	if (trace2perfetto_Parse (data, size, &dump) != 0) {
+		free (data);
+		return 1;
+	}
+
+	FILE* out = stdout;
+	if (argc == 3) {
+		out = fopen (argv[2], "w");
+		if (out == NULL) {
+			perror (argv[2]);
+			free (data);
+			return 1;
+		}
+	}
+
+	trace2perfetto_Convert (&dump, out);
+
+	if (out != stdout) {
+		fclose (out);
+	}
+	free (data);
+	return 0;
+}
@@ -0,0 +1,445 @@
+/*
+ * trace_io.c
+ *
+ * Loads and saves raw IMU traces in two formats:
+ *
+ * CSV, one sample per line, '#' lines are comments:
+ *   # rate_hz=100
+ *   x,y,z,step
+ *   -120,340,16200,0
+ * The step column is optional and marks a ground-truth step.
+ *
+ * Compact binary (.bin), little endian:
+ *   "SCTB" | u16 version | u16 rate_hz | u32 count
+ *   count x { i16 x | i16 y | i16 z | u8 flags }   flags bit 0 = step
+ *
+ * Columnar delta-encoded log (.sct), see imu_log.h. Written with the
+ * firmware's own encoder plus a block index, read through trace_map.c
+ * with blocks decoded straight into the trace columns.
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "trace_io.h"
+#include "trace_map.h"
+#include "imu_log.h"
+#include "task_read_imu.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define BIN_MAGIC		"SCTB"
+#define BIN_VERSION		1
+#define BIN_HEADER_SIZE	12
+#define BIN_RECORD_SIZE	7
+#define BIN_FLAG_STEP	0x01
+
+#define INITIAL_CAPACITY 4096
+
+
+void trace_Init (trace_t* trace, uint16_t rate_hz)
+{
+	memset (trace, 0, sizeof(*trace));
+	trace->rate_hz = rate_hz;
+}
+
+
+void trace_Free (trace_t* trace)
+{
+	free (trace->x);
+	free (trace->y);
+	free (trace->z);
+	free (trace->step);
+	trace_Init (trace, trace->rate_hz);
+}
+
+
+static int trace_Reserve (trace_t* trace, uint32_t capacity)
+{
+	if (capacity <= trace->capacity) {
+		return 0;
+	}
+
+	int16_t* x = realloc (trace->x, capacity * sizeof(int16_t));
+	if (x) trace->x = x;
+	int16_t* y = realloc (trace->y, capacity * sizeof(int16_t));
+	if (y) trace->y = y;
+	int16_t* z = realloc (trace->z, capacity * sizeof(int16_t));
+	if (z) trace->z = z;
+	uint8_t* step = realloc (trace->step, capacity);
+	if (step) trace->step = step;
+
+	if (!x || !y || !z || !step) {
+		return -1;
+	}
+	trace->capacity = capacity;
+	return 0;
+}
+
+
+int trace_Append (trace_t* trace, int16_t x, int16_t y, int16_t z, uint8_t step)
+{
+	if (trace->count == trace->capacity) {
+		uint32_t capacity = trace->capacity ? trace->capacity * 2 : INITIAL_CAPACITY;
+		if (trace_Reserve (trace, capacity) != 0) {
+			return -1;
+		}
+	}
+
+	trace->x[trace->count] = x;
+	trace->y[trace->count] = y;
+	trace->z[trace->count] = z;
+	trace->step[trace->count] = step;
+	trace->count++;
+	return 0;
+}
+
+
+uint32_t trace_StepCountGetter (const trace_t* trace)
+{
+	uint32_t steps = 0;
+	for (uint32_t i = 0; i < trace->count; i++) {
+		steps += trace->step[i] ? 1 : 0;
+	}
+	return steps;
+}
+
+
+/* Read a whole file into memory, NUL terminated */
+static char* trace_ReadFile (const char* path, size_t* size)
+{
+	FILE* file = fopen (path, "rb");
+	if (!file) {
+		return NULL;
+	}
+
+	fseek (file, 0, SEEK_END);
+	long length = ftell (file);
+	fseek (file, 0, SEEK_SET);
+
+	char* data = (length >= 0) ? malloc ((size_t) length + 1) : NULL;
+	if (data && fread (data, 1, (size_t) length, file) != (size_t) length) {
+		free (data);
+		data = NULL;
+	}
+	fclose (file);
+
+	if (data) {
+		data[length] = '\0';
+		*size = (size_t) length;
+	}
+	return data;
+}
+
+
+static uint16_t trace_ReadU16 (const uint8_t* p)
+{
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+
+static uint32_t trace_ReadU32 (const uint8_t* p)
+{
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+
+static int trace_LoadBinary (const uint8_t* data, size_t size, trace_t* trace)
+{
+	if (size < BIN_HEADER_SIZE || trace_ReadU16 (&data[4]) != BIN_VERSION) {
+		return -1;
+	}
+
+	uint32_t count = trace_ReadU32 (&data[8]);
+	if ((size - BIN_HEADER_SIZE) / BIN_RECORD_SIZE < count) {
+		return -1;
+	}
+
+	trace->rate_hz = trace_ReadU16 (&data[6]);
+	if (trace_Reserve (trace, count) != 0) {
+		return -1;
+	}
+
+	const uint8_t* record = &data[BIN_HEADER_SIZE];
+	for (uint32_t i = 0; i < count; i++, record += BIN_RECORD_SIZE) {
+		trace->x[i] = (int16_t) trace_ReadU16 (&record[0]);
+		trace->y[i] = (int16_t) trace_ReadU16 (&record[2]);
+		trace->z[i] = (int16_t) trace_ReadU16 (&record[4]);
+		trace->step[i] = record[6] & BIN_FLAG_STEP;
+	}
+	trace->count = count;
+	return 0;
+}
+
+
+static int trace_LoadCsv (char* text, trace_t* trace)
+{
+	char* line = text;
+
+	while (*line) {
+		char* next = strchr (line, '\n');
+		if (next) {
+			*next++ = '\0';
+		} else {
+			next = line + strlen (line);
+		}
+
+		if (line[0] == '#') {
+			const char* rate = strstr (line, "rate_hz=");
+			if (rate) {
+				trace->rate_hz = (uint16_t) strtoul (rate + strlen ("rate_hz="), NULL, 10);
+			}
+		} else if (line[0] == '-' || isdigit ((unsigned char) line[0])) {
+			long values[4] = {0};
+			char* cursor = line;
+			int fields = 0;
+
+			while (fields < 4) {
+				char* end;
+				values[fields] = strtol (cursor, &end, 10);
+				if (end == cursor) {
+					break;
+				}
+				fields++;
+				cursor = end;
+				if (*cursor != ',') {
+					break;
+				}
+				cursor++;
+			}
+
+			if (fields < 3) {
+				fprintf (stderr, "trace: malformed line \"%s\"\n", line);
+				return -1;
+			}
+			if (trace_Append (trace, (int16_t) values[0], (int16_t) values[1],
+					(int16_t) values[2], values[3] ? 1 : 0) != 0) {
+				return -1;
+			}
+		}
+		/* anything else is a column header */
+
+		line = next;
+	}
+	return 0;
+}
+
+
+static int trace_LoadLog (const trace_map_t* map, const char* path, trace_t* trace)
+{
+	if (map->offset[0] != X_OFFSET || map->offset[1] != Y_OFFSET || map->offset[2] != Z_OFFSET) {
+		fprintf (stderr, "trace: %s was recorded with offsets %d,%d,%d, firmware uses %d,%d,%d\n",
+				path, map->offset[0], map->offset[1], map->offset[2], X_OFFSET, Y_OFFSET, Z_OFFSET);
+	}
+
+	trace->rate_hz = map->rate_hz;
+	if (trace_Reserve (trace, map->num_samples + map->block_samples) != 0) {
+		return -1;
+	}
+
+	for (uint32_t block = 0; block < map->num_blocks; block++) {
+		uint32_t first = map->blocks[block].first_sample;
+		if (first != trace->count || first > map->num_samples) {
+			return -1;
+		}
+		int count = traceMap_DecodeBlock (map, block, &trace->x[first], &trace->y[first],
+				&trace->z[first], &trace->step[first]);
+		if (count < 0) {
+			return -1;
+		}
+		trace->count += (uint32_t) count;
+	}
+	return trace->count == map->num_samples ? 0 : -1;
+}
+
+
+int trace_Load (const char* path, trace_t* trace)
+{
+	trace_map_t map;
+	if (traceMap_Open (path, &map) == 0) {
+		trace_Free (trace);
+		trace_Init (trace, TRACE_DEFAULT_RATE_HZ);
+		int result = trace_LoadLog (&map, path, trace);
+		traceMap_Close (&map);
+		if (result != 0) {
+			fprintf (stderr, "trace: %s is not a valid trace\n", path);
+			trace_Free (trace);
+		}
+		return result;
+	}
+
+	size_t size = 0;
+	char* data = trace_ReadFile (path, &size);
+	if (!data) {
+		fprintf (stderr, "trace: cannot read %s\n", path);
+		return -1;
+	}
+
+	trace_Free (trace);
+	trace_Init (trace, TRACE_DEFAULT_RATE_HZ);
+
+	int result;
+	if (size >= 4 && memcmp (data, BIN_MAGIC, 4) == 0) {
+		result = trace_LoadBinary ((const uint8_t*) data, size, trace);
+	} else {
+		result = trace_LoadCsv (data, trace);
+	}
+	free (data);
+
+	if (result != 0) {
+		fprintf (stderr, "trace: %s is not a valid trace\n", path);
+		trace_Free (trace);
+	}
+	return result;
+}
+
+
+static int trace_HasExtension (const char* path, const char* extension)
+{
+	size_t path_len = strlen (path);
+	size_t ext_len = strlen (extension);
+	return path_len >= ext_len && strcmp (&path[path_len - ext_len], extension) == 0;
+}
+
+
+static void trace_PutU16 (uint8_t* p, uint16_t value)
+{
+	p[0] = (uint8_t) value;
+	p[1] = (uint8_t) (value >> 8);
+}
+
+
+static void trace_PutU32 (uint8_t* p, uint32_t value)
+{
+	trace_PutU16 (&p[0], (uint16_t) value);
+	trace_PutU16 (&p[2], (uint16_t) (value >> 16));
+}
+
+
+static int trace_SaveBinary (FILE* file, const trace_t* trace)
+{
+	uint8_t header[BIN_HEADER_SIZE];
+	memcpy (header, BIN_MAGIC, 4);
+	trace_PutU16 (&header[4], BIN_VERSION);
+	trace_PutU16 (&header[6], trace->rate_hz);
+	trace_PutU32 (&header[8], trace->count);
+	if (fwrite (header, 1, sizeof(header), file) != sizeof(header)) {
+		return -1;
+	}
+
+	uint8_t record[BIN_RECORD_SIZE];
+	for (uint32_t i = 0; i < trace->count; i++) {
+		trace_PutU16 (&record[0], (uint16_t) trace->x[i]);
+		trace_PutU16 (&record[2], (uint16_t) trace->y[i]);
+		trace_PutU16 (&record[4], (uint16_t) trace->z[i]);
+		record[6] = trace->step[i] ? BIN_FLAG_STEP : 0;
+		if (fwrite (record, 1, sizeof(record), file) != sizeof(record)) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+
+static int trace_SaveCsv (FILE* file, const trace_t* trace)
+{
+	fprintf (file, "# rate_hz=%u\nx,y,z,step\n", trace->rate_hz);
+	for (uint32_t i = 0; i < trace->count; i++) {
+		fprintf (file, "%d,%d,%d,%u\n", trace->x[i], trace->y[i], trace->z[i], trace->step[i]);
+	}
+	return ferror (file) ? -1 : 0;
+}
+
+
+typedef struct {
+	FILE* file;
+	uint32_t position;
+	trace_map_block_t* blocks;
+	uint32_t num_blocks;
+	int error;
+} trace_log_writer_t;
+
+
+/* imu_log.c output, every write after the header is one block */
+static void trace_LogWrite (const uint8_t* data, uint16_t length, void* context)
+{
+	trace_log_writer_t* writer = context;
+
+	if (writer->position != 0) {
+		imu_log_block_t block;
+		imuLog_ParseBlockHeader (data, &block);
+		writer->blocks[writer->num_blocks].first_sample = block.first_sample;
+		writer->blocks[writer->num_blocks].offset = writer->position;
+		writer->num_blocks++;
+	}
+	if (fwrite (data, 1, length, writer->file) != length) {
+		writer->error = -1;
+	}
+	writer->position += length;
+}
+
+
+static int trace_SaveLog (FILE* file, const trace_t* trace)
+{
+	static imu_log_t imu_log;
+	trace_log_writer_t writer = {
+		.file = file,
+		.blocks = malloc (((trace->count / IMU_LOG_BLOCK_SAMPLES) + 1) * sizeof(trace_map_block_t)),
+	};
+	if (!writer.blocks) {
+		return -1;
+	}
+
+	imuLog_Init (&imu_log, trace->rate_hz, trace_LogWrite, &writer);
+	for (uint32_t i = 0; i < trace->count; i++) {
+		imuLog_Append (&imu_log, trace->x[i], trace->y[i], trace->z[i], trace->step[i]);
+	}
+	imuLog_Flush (&imu_log);
+
+	uint8_t entry[IMU_LOG_INDEX_ENTRY_SIZE];
+	for (uint32_t i = 0; i < writer.num_blocks && writer.error == 0; i++) {
+		trace_PutU32 (&entry[0], writer.blocks[i].first_sample);
+		trace_PutU32 (&entry[4], writer.blocks[i].offset);
+		if (fwrite (entry, 1, sizeof(entry), file) != sizeof(entry)) {
+			writer.error = -1;
+		}
+	}
+
+	uint8_t footer[IMU_LOG_INDEX_FOOTER_SIZE];
+	trace_PutU32 (&footer[0], writer.num_blocks);
+	trace_PutU32 (&footer[4], trace->count);
+	memcpy (&footer[8], IMU_LOG_INDEX_MAGIC, 4);
+	if (fwrite (footer, 1, sizeof(footer), file) != sizeof(footer)) {
+		writer.error = -1;
+	}
+
+	free (writer.blocks);
+	return writer.error;
+}
+
+
+int trace_Save (const char* path, const trace_t* trace)
+{
+	FILE* file = fopen (path, "wb");
+	if (!file) {
+		fprintf (stderr, "trace: cannot write %s\n", path);
+		return -1;
+	}
+
+	int result;
+	if (trace_HasExtension (path, ".bin")) {
+		result = trace_SaveBinary (file, trace);
+	} else if (trace_HasExtension (path, ".sct")) {
+		result = trace_SaveLog (file, trace);
+	} else {
+		result = trace_SaveCsv (file, trace);
+	}
+
+	if (fclose (file) != 0) {
+		result = -1;
+	}
+	return result;
+}
@@ -0,0 +1,40 @@
+/*
+ * trace_io.h
+ *
+ * Recorded IMU traces for the host tools
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef TRACE_IO_H_
+#define TRACE_IO_H_
+
+#include <stdint.h>
+
+#define TRACE_DEFAULT_RATE_HZ	100
+
+/*
+ * Raw LSM6DS accelerometer samples (before X_OFFSET etc. are applied),
+ * stored column-wise, with an optional ground-truth step label per sample
+ */
+typedef struct {
+	int16_t* x;
+	int16_t* y;
+	int16_t* z;
+	uint8_t* step;		// 1 = a real step happened on this sample
+	uint32_t count;
+	uint32_t capacity;
+	uint16_t rate_hz;
+} trace_t;
+
+void trace_Init (trace_t* trace, uint16_t rate_hz);
+void trace_Free (trace_t* trace);
+int trace_Append (trace_t* trace, int16_t x, int16_t y, int16_t z, uint8_t step);
+uint32_t trace_StepCountGetter (const trace_t* trace);
+
+/* Format is chosen from the file contents on load and the extension (.bin, .sct, else CSV) on save */
+int trace_Load (const char* path, trace_t* trace);
+int trace_Save (const char* path, const trace_t* trace);
+
+#endif /* TRACE_IO_H_ */
@@ -0,0 +1,214 @@
+/*
+ * trace_map.c
+ *
+ * Maps an imu_log.c trace read-only and decodes blocks on demand.
+ *
+ * The block index is read from the footer when the log was closed on a
+ * host; logs streamed off the MCU have none, so it is rebuilt by hopping
+ * from block header to block header (no sample data is touched).
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#include "trace_map.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+static uint16_t traceMap_GetU16 (const uint8_t* p)
+{
+	return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+
+static uint32_t traceMap_GetU32 (const uint8_t* p)
+{
+	return (uint32_t) traceMap_GetU16 (&p[0]) | ((uint32_t) traceMap_GetU16 (&p[2]) << 16);
+}
+
+
+static int traceMap_ReadIndex (trace_map_t* map)
+{
+	if (map->size < IMU_LOG_HEADER_SIZE + IMU_LOG_INDEX_FOOTER_SIZE) {
+		return -1;
+	}
+
+	const uint8_t* footer = map->data + map->size - IMU_LOG_INDEX_FOOTER_SIZE;
+	if (memcmp (&footer[8], IMU_LOG_INDEX_MAGIC, 4) != 0) {
+		return -1;
+	}
+
+	uint32_t num_blocks = traceMap_GetU32 (&footer[0]);
+	size_t index_size = (size_t) num_blocks * IMU_LOG_INDEX_ENTRY_SIZE;
+	if (index_size > map->size - IMU_LOG_HEADER_SIZE - IMU_LOG_INDEX_FOOTER_SIZE) {
+		return -1;
+	}
+
+	map->blocks = malloc ((num_blocks + 1) * sizeof(trace_map_block_t));
+	if (!map->blocks) {
+		return -1;
+	}
+
+	const uint8_t* entry = footer - index_size;
+	for (uint32_t i = 0; i < num_blocks; i++, entry += IMU_LOG_INDEX_ENTRY_SIZE) {
+		map->blocks[i].first_sample = traceMap_GetU32 (&entry[0]);
+		map->blocks[i].offset = traceMap_GetU32 (&entry[4]);
+		if (map->blocks[i].offset > (size_t) (footer - map->data) - IMU_LOG_BLOCK_HEADER_SIZE) {
+			return -1;
+		}
+	}
+	map->num_blocks = num_blocks;
+	map->num_samples = traceMap_GetU32 (&footer[4]);
+	return 0;
+}
+
+
+static int traceMap_ScanIndex (trace_map_t* map)
+{
+	uint32_t capacity = 64;
+	size_t position = IMU_LOG_HEADER_SIZE;
+
+	map->blocks = malloc (capacity * sizeof(trace_map_block_t));
+	map->num_blocks = 0;
+	map->num_samples = 0;
+
+	while (map->blocks && position + IMU_LOG_BLOCK_HEADER_SIZE <= map->size) {
+		imu_log_block_t block;
+		imuLog_ParseBlockHeader (map->data + position, &block);
+		uint32_t size = imuLog_BlockSize (&block);
+		if (block.count == 0 || position + size > map->size) {
+			break;	// torn last block of an interrupted log
+		}
+
+		if (map->num_blocks == capacity) {
+			capacity *= 2;
+			trace_map_block_t* blocks = realloc (map->blocks, capacity * sizeof(trace_map_block_t));
+			if (!blocks) {
+				return -1;
+			}
+			map->blocks = blocks;
+		}
+		map->blocks[map->num_blocks].first_sample = block.first_sample;
+		map->blocks[map->num_blocks].offset = (uint32_t) position;
+		map->num_blocks++;
+		map->num_samples = block.first_sample + block.count;
+		position += size;
+	}
+	return map->blocks ? 0 : -1;
+}
+
+
+int traceMap_Open (const char* path, trace_map_t* map)
+{
+	memset (map, 0, sizeof(*map));
+
+	int fd = open (path, O_RDONLY);
+	if (fd < 0) {
+		return -1;
+	}
+
+	struct stat info;
+	if (fstat (fd, &info) != 0 || (size_t) info.st_size < IMU_LOG_HEADER_SIZE) {
+		close (fd);
+		return -1;
+	}
+
+	void* data = mmap (NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (data == MAP_FAILED) {
+		return -1;
+	}
+	map->data = data;
+	map->size = (size_t) info.st_size;
+
+	if (memcmp (map->data, IMU_LOG_MAGIC, 4) != 0
+			|| traceMap_GetU16 (&map->data[4]) != IMU_LOG_VERSION) {
+		traceMap_Close (map);
+		return -1;
+	}
+	map->rate_hz = traceMap_GetU16 (&map->data[6]);
+	map->offset[0] = (int16_t) traceMap_GetU16 (&map->data[8]);
+	map->offset[1] = (int16_t) traceMap_GetU16 (&map->data[10]);
+	map->offset[2] = (int16_t) traceMap_GetU16 (&map->data[12]);
+	map->block_samples = traceMap_GetU16 (&map->data[14]);
+
+	if (traceMap_ReadIndex (map) != 0) {
+		free (map->blocks);
+		if (traceMap_ScanIndex (map) != 0) {
+			traceMap_Close (map);
+			return -1;
+		}
+	}
+
+	/* the whole file is read front to back */
+	madvise ((void*) map->data, map->size, MADV_SEQUENTIAL);
+	return 0;
+}
+
+
+void traceMap_Close (trace_map_t* map)
+{
+	if (map->data) {
+		munmap ((void*) map->data, map->size);
+	}
+	free (map->blocks);
+	memset (map, 0, sizeof(*map));
+}
+
+
+uint32_t traceMap_FindBlock (const trace_map_t* map, uint32_t sample)
+{
+	uint32_t low = 0;
+	uint32_t high = map->num_blocks;
+
+	while (high - low > 1) {
+		uint32_t middle = low + (high - low) / 2;
+		if (map->blocks[middle].first_sample <= sample) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+
+int traceMap_DecodeBlock (const trace_map_t* map, uint32_t index,
+		int16_t* x, int16_t* y, int16_t* z, uint8_t* step)
+{
+	if (index >= map->num_blocks) {
+		return -1;
+	}
+
+	const uint8_t* data = map->data + map->blocks[index].offset;
+	imu_log_block_t block;
+	imuLog_ParseBlockHeader (data, &block);
+	if (block.count > map->block_samples
+			|| map->blocks[index].offset + imuLog_BlockSize (&block) > map->size) {
+		return -1;
+	}
+
+	const uint8_t* column = data + IMU_LOG_BLOCK_HEADER_SIZE;
+	int16_t* outputs[3] = {x, y, z};
+	for (int axis = 0; axis < 3; axis++) {
+		uint16_t bytes = block.column_bytes[axis];
+		if (imuLog_DecodeColumn (column, bytes, block.first[axis], outputs[axis], block.count) != bytes) {
+			return -1;
+		}
+		column += bytes;
+	}
+
+	if (step) {
+		for (uint16_t i = 0; i < block.count; i++) {
+			step[i] = (block.flags & IMU_LOG_FLAG_MARKS) ? (column[i >> 3] >> (i & 7)) & 1 : 0;
+		}
+	}
+	return block.count;
+}
@@ -0,0 +1,49 @@
+/*
+ * trace_map.h
+ *
+ * Memory-mapped reader for imu_log.c (.sct) traces
+ *
+ * Created on: Oct 19, 2026
+ * Author: T. Linton, J. Legg
+ */
+
+#ifndef TRACE_MAP_H_
+#define TRACE_MAP_H_
+
+#include "imu_log.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+	uint32_t first_sample;
+	uint32_t offset;		// file offset of the block header
+} trace_map_block_t;
+
+typedef struct {
+	const uint8_t* data;
+	size_t size;
+	uint16_t rate_hz;
+	int16_t offset[3];		// X_OFFSET etc. of the recording firmware
+	uint16_t block_samples;
+	uint32_t num_blocks;
+	uint32_t num_samples;
+	trace_map_block_t* blocks;
+} trace_map_t;
+
+/* Returns -1 if the file is not an imu_log trace or is damaged */
+int traceMap_Open (const char* path, trace_map_t* map);
+void traceMap_Close (trace_map_t* map);
+
+/* Block holding sample, binary search over the index */
+uint32_t traceMap_FindBlock (const trace_map_t* map, uint32_t sample);
+
+/*
+ * Decode a block straight from the mapping into the caller's columns,
+ * each at least block_samples long; step may be NULL
+ * Returns the number of samples, or -1 if the block is malformed
+ */
+int traceMap_DecodeBlock (const trace_map_t* map, uint32_t block,
+		int16_t* x, int16_t* y, int16_t* z, uint8_t* step);
+
+#endif /* TRACE_MAP_H_ */